@@ -0,0 +1,79 @@
+#include "bandedexport.h"
+#include "pdfdocument.h"
+#include "pngstreamwriter.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QtMath>
+
+bool BandedExport::run(const QString &filePath, int pageIndex, int dpi, const QString &outputPath,
+                       const QString &displayProfile, const QByteArray &layers, const ProgressCallback &progress,
+                       QString *error)
+{
+    auto fail = [error](const QString &message)
+    {
+        if (error)
+            *error = message;
+        return false;
+    };
+
+    PDFDocument document;
+    if (!document.loadFromFile(filePath, PDFDocument::FileIdentity::None))
+        return fail(QString("Cannot open %1").arg(filePath));
+    document.setDisplayProfile(displayProfile); // Same color pipeline as the viewer
+    if (!layers.isEmpty() && !document.setLayerVisibility(layers))
+        return fail(QString("Layers of %1 changed since it was opened").arg(filePath));
+
+    auto page = document.getPage(pageIndex);
+    if (!page)
+        return fail(QString("No page %1").arg(pageIndex + 1));
+
+    const QSizeF points = document.pageSizes().value(pageIndex);
+    const qint64 width = qCeil(points.width() * dpi / 72.0);
+    const qint64 height = qCeil(points.height() * dpi / 72.0);
+    if (width <= 0 || height <= 0 || width > MAX_DIMENSION || height > MAX_DIMENSION)
+        return fail(QString("%1 x %2 px is outside the supported size").arg(width).arg(height));
+
+    PngStreamWriter writer;
+    if (!writer.open(outputPath, int(width), int(height), dpi))
+        return fail(writer.errorString());
+
+    const int bandHeight = int(qBound<qint64>(1, BAND_BYTES / (width * 4), height));
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int top = 0; top < height; top += bandHeight)
+    {
+        if (progress && !progress(top, int(height)))
+            return fail("Canceled");
+
+        const int rows = int(qMin<qint64>(bandHeight, height - top));
+        QImage band = page->renderToImage(dpi, dpi, 0, top, int(width), rows);
+        if (band.isNull())
+            return fail(QString("Render failed at row %1").arg(top));
+
+        // Poppler may round the page one pixel narrower: pad with paper
+        if (band.width() != width || band.height() != rows)
+        {
+            QImage padded(int(width), rows, QImage::Format_RGB888);
+            padded.fill(Qt::white);
+            QPainter painter(&padded);
+            painter.drawImage(0, 0, band);
+            painter.end();
+            band = padded;
+        }
+
+        if (!writer.writeBand(band))
+            return fail(writer.errorString());
+    }
+
+    if (!writer.finish())
+        return fail(writer.errorString());
+
+    if (progress)
+        progress(int(height), int(height));
+
+    qInfo() << "BandedExport: page" << pageIndex + 1 << "at" << dpi << "DPI," << width << "x" << height << "px,"
+            << bandHeight << "-row bands, in" << timer.elapsed() << "ms ->" << outputPath;
+    return true;
+}
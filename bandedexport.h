@@ -0,0 +1,41 @@
+#ifndef BANDEDEXPORT_H
+#define BANDEDEXPORT_H
+
+#include <QByteArray>
+#include <QString>
+#include <functional>
+
+/**
+ * BandedExport
+ * ---------------------------------------------------------------
+ * Single-page raster export at any DPI (plotting, print shops) in
+ * constant memory.
+ *
+ * Responsibilities:
+ *  - Open a private copy of the document (safe on a worker thread), with
+ *    the layers shown in the viewer.
+ *  - Render the page in horizontal bands with Poppler's sub-rectangle
+ *    renderToImage() and stream every band into PngStreamWriter.
+ *
+ * Design notes:
+ *  - Peak memory is one band (BAND_BYTES) plus the encoder's buffers,
+ *    whether the page is 10 or 100 megapixels.
+ *  - Poppler interprets the page content once per band; complex pages
+ *    trade that time for memory. Bands are as tall as BAND_BYTES allows.
+ *  - Never throws: false + *error.
+ */
+class BandedExport
+{
+public:
+    using ProgressCallback = std::function<bool(int rowsDone, int rowsTotal)>; // Return false to cancel.
+
+    // layers: the viewer's PDFDocument::layerVisibility(); empty keeps the document's defaults.
+    static bool run(const QString &filePath, int pageIndex, int dpi, const QString &outputPath,
+                    const QString &displayProfile = QString(), const QByteArray &layers = QByteArray(),
+                    const ProgressCallback &progress = ProgressCallback(), QString *error = nullptr);
+
+    static constexpr qint64 BAND_BYTES = 32ll * 1024 * 1024;
+    static constexpr int MAX_DIMENSION = 256 * 1024; // Pixels per side
+};
+
+#endif // BANDEDEXPORT_H
@@ -0,0 +1,443 @@
+/**
+ * schedsim
+ * ---------------------------------------------------------------
+ * Offline render-scheduler simulator: replays a recorded scroll trace
+ * against per-page render costs on a virtual clock, once per RenderPolicy,
+ * and predicts what the user would have seen.
+ *
+ * Usage:
+ *   PDV_SCROLL_TRACE=scroll.csv PrettyDopeFileviewer doc.pdf   (record)
+ *   File > Performance report... > Save CSV                    (costs)
+ *   schedsim --trace scroll.csv --costs report.csv [--policy P]...
+ *
+ * Model (PageManager::renderVisiblePages()):
+ *  - Every trace sample is one synchronous pass on the GUI thread: the
+ *    policy's whole list, minus pages already rendered at that DPI, is
+ *    rendered in order before anything else happens. A sample arriving
+ *    during a pass waits for it, as its scroll event would.
+ *  - A page costs its report render time scaled by (dpi / report DPI)^2
+ *    and occupies width * height * 4 bytes of a LRU cache of --cache-mb.
+ *  - Every 60 Hz frame during a pass is frozen: nothing is painted and
+ *    input waits. Any other frame with a visible page not rendered at the
+ *    current DPI is blank.
+ *
+ * Reports per policy: renders, wasted renders (never on screen before
+ * eviction, a DPI change or the end), GUI time spent rendering, frozen
+ * and blank frame time, and the longest stall (frozen or blank frames in
+ * a row). Costs come from one machine's report, so compare policies with
+ * each other rather than with wall-clock numbers.
+ */
+
+#include "pagelayout.h"
+#include "renderpolicy.h"
+#include "scrolltrace.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QTextStream>
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    constexpr int SPACING = 20;               // Same as PageManager
+    constexpr int MARGINS = 50;               // Same as PageManager
+    constexpr int IDLE_SCROLL_MS = 500;       // Same as PageManager: longer gaps read as speed 0
+    constexpr double FRAME_MS = 1000.0 / 60.0;
+    constexpr qint64 TAIL_MS = 1000;          // Clock keeps running after the last sample
+    constexpr double NEVER = std::numeric_limits<double>::infinity();
+
+    struct PageCost
+    {
+        QSize size; // At the report DPI
+        double renderMs = 0.0;
+    };
+
+    struct Result
+    {
+        QString policy;
+        int renders = 0;
+        int wasted = 0;
+        double busyMs = 0.0;
+        int frames = 0;
+        int frozenFrames = 0;
+        int blankFrames = 0;
+        double longestStallMs = 0.0;
+    };
+
+    // Performance report CSV: page,render_ms,width,height,...,dpi (columns found by name).
+    // *dpi: the report's render DPI; left alone for reports written without one.
+    QVector<PageCost> loadCosts(const QString &filePath, int *dpi, QString *error)
+    {
+        QVector<PageCost> costs;
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            *error = file.errorString();
+            return costs;
+        }
+
+        QTextStream in(&file);
+        const QStringList header = in.readLine().trimmed().split(',');
+        const int pageColumn = header.indexOf("page");
+        const int msColumn = header.indexOf("render_ms");
+        const int widthColumn = header.indexOf("width");
+        const int heightColumn = header.indexOf("height");
+        const int dpiColumn = header.indexOf("dpi");
+        if (pageColumn < 0 || msColumn < 0 || widthColumn < 0 || heightColumn < 0)
+        {
+            *error = filePath + ": expected a performance report CSV (page,render_ms,width,height,...)";
+            return costs;
+        }
+
+        while (!in.atEnd())
+        {
+            const QStringList fields = in.readLine().trimmed().split(',');
+            if (fields.size() < header.size())
+                continue;
+
+            const int page = fields[pageColumn].toInt() - 1; // 1-based in the report
+            if (page < 0)
+                continue;
+            if (page >= costs.size())
+                costs.resize(page + 1);
+            costs[page].renderMs = fields[msColumn].toDouble();
+            costs[page].size = QSize(fields[widthColumn].toInt(), fields[heightColumn].toInt());
+            if (dpiColumn >= 0)
+                *dpi = fields[dpiColumn].toInt();
+        }
+        return costs;
+    }
+
+    class Simulator
+    {
+    public:
+        Simulator(const QVector<PageCost> &costs, int reportDpi, int window, int initialPages, qint64 cacheBytes)
+            : m_costs(costs), m_reportDpi(reportDpi), m_window(window), m_initialPages(initialPages),
+              m_cacheBytes(cacheBytes)
+        {
+        }
+
+        Result run(const RenderPolicy &policy, const QVector<ScrollSample> &trace)
+        {
+            reset();
+            m_result.policy = policy.name();
+            if (trace.isEmpty() || m_costs.isEmpty())
+                return m_result;
+
+            m_view.window = m_window;
+            m_view.pageCount = m_costs.size();
+            m_view.layout = &m_layout;
+
+            // As on open: the first pages, then the first pass, in one go
+            QVector<int> initial;
+            for (int i = 0; i < qMin(m_initialPages, m_costs.size()); ++i)
+                initial.append(i);
+            m_now = trace.first().ms;
+            apply(trace.first(), nullptr);
+            renderPass(initial + policy.pagesToRender(m_view));
+
+            int next = 1;
+            double nextFrame = trace.first().ms;
+            const double end = trace.last().ms + TAIL_MS;
+            for (;;)
+            {
+                // A sample waits for the pass in progress; frames meanwhile are frozen
+                const double sampleAt = next < trace.size() ? std::max(double(trace[next].ms), m_guiFree) : NEVER;
+                const double at = std::min(sampleAt, nextFrame);
+                if (at >= end)
+                    break;
+                m_now = at;
+
+                // A frame due as a pass starts is frozen by it
+                if (at == sampleAt)
+                {
+                    apply(trace[next], &trace[next - 1]);
+                    renderPass(policy.pagesToRender(m_view));
+                    ++next;
+                }
+                else
+                {
+                    frame();
+                    nextFrame += FRAME_MS;
+                }
+            }
+
+            for (const Entry &entry : std::as_const(m_cache))
+            {
+                if (!entry.shown)
+                    ++m_result.wasted;
+            }
+            return m_result;
+        }
+
+    private:
+        struct Entry
+        {
+            int dpi = 0;
+            qint64 bytes = 0;
+            double lastUse = 0.0;
+            bool shown = false;
+        };
+
+        void reset()
+        {
+            m_result = Result();
+            m_layout = PageLayout();
+            m_layoutDpi = -1;
+            m_view = RenderView();
+            m_cache.clear();
+            m_cacheUsed = 0;
+            m_guiFree = 0.0;
+            m_now = 0.0;
+            m_stallStretch = 0.0;
+        }
+
+        QSize sizeAt(int page, int dpi) const
+        {
+            const QSize size = m_costs[page].size;
+            return QSize(size.width() * dpi / m_reportDpi, size.height() * dpi / m_reportDpi);
+        }
+
+        double costAt(int page, int dpi) const
+        {
+            const double scale = double(dpi) / m_reportDpi;
+            return m_costs[page].renderMs * scale * scale;
+        }
+
+        bool isReady(int page) const
+        {
+            const auto it = m_cache.constFind(page);
+            return it != m_cache.cend() && it->dpi == m_dpi;
+        }
+
+        void apply(const ScrollSample &sample, const ScrollSample *previous)
+        {
+            // Zoom: the column is laid out again at the new size
+            m_dpi = sample.dpi;
+            if (m_dpi != m_layoutDpi)
+            {
+                QVector<QSize> sizes;
+                sizes.reserve(m_costs.size());
+                for (int i = 0; i < m_costs.size(); ++i)
+                    sizes.append(sizeAt(i, m_dpi));
+                m_layout.setGeometry(sizes, SPACING, QMargins(MARGINS, MARGINS, MARGINS, MARGINS));
+                m_layoutDpi = m_dpi;
+            }
+
+            m_view.velocity = 0.0;
+            const qint64 elapsedMs = previous ? sample.ms - previous->ms : 0;
+            if (elapsedMs > 0 && elapsedMs < IDLE_SCROLL_MS)
+                m_view.velocity = (sample.scrollValue - previous->scrollValue) * 1000.0 / elapsedMs;
+            m_view.scrollValue = sample.scrollValue;
+            m_view.viewportHeight = sample.viewportHeight;
+        }
+
+        // Every page of the list, one after the other, before the GUI moves on
+        void renderPass(const QVector<int> &pages)
+        {
+            double at = m_now;
+            for (int page : pages)
+            {
+                if (page < 0 || page >= m_costs.size() || isReady(page))
+                    continue;
+
+                at += costAt(page, m_dpi);
+                m_result.busyMs += costAt(page, m_dpi);
+                store(page, at);
+            }
+            m_guiFree = at;
+        }
+
+        void store(int page, double at)
+        {
+            ++m_result.renders;
+            drop(page);
+            const QSize size = sizeAt(page, m_dpi);
+            Entry entry;
+            entry.dpi = m_dpi;
+            entry.bytes = qint64(size.width()) * size.height() * 4;
+            entry.lastUse = at;
+            m_cache.insert(page, entry);
+            m_cacheUsed += entry.bytes;
+
+            // LRU eviction, never the page that just arrived
+            while (m_cacheUsed > m_cacheBytes && m_cache.size() > 1)
+            {
+                int victim = -1;
+                double oldest = NEVER;
+                for (auto it = m_cache.cbegin(); it != m_cache.cend(); ++it)
+                {
+                    if (it.key() != page && it->lastUse < oldest)
+                    {
+                        oldest = it->lastUse;
+                        victim = it.key();
+                    }
+                }
+                drop(victim);
+            }
+        }
+
+        void drop(int page)
+        {
+            const auto it = m_cache.constFind(page);
+            if (it == m_cache.cend())
+                return;
+            if (!it->shown)
+                ++m_result.wasted;
+            m_cacheUsed -= it->bytes;
+            m_cache.erase(it);
+        }
+
+        void frame()
+        {
+            ++m_result.frames;
+            if (m_now < m_guiFree)
+            {
+                ++m_result.frozenFrames;
+                stall();
+                return;
+            }
+
+            bool blank = false;
+            const QPair<int, int> visible =
+                m_layout.pagesBetween(m_view.scrollValue, m_view.scrollValue + m_view.viewportHeight);
+            for (int page = visible.first; page >= 0 && page <= visible.second; ++page)
+            {
+                if (!isReady(page))
+                {
+                    blank = true;
+                    continue;
+                }
+                Entry &entry = m_cache[page];
+                entry.shown = true;
+                entry.lastUse = m_now;
+            }
+
+            if (!blank)
+            {
+                m_stallStretch = 0.0;
+                return;
+            }
+            ++m_result.blankFrames;
+            stall();
+        }
+
+        void stall()
+        {
+            m_stallStretch += FRAME_MS;
+            m_result.longestStallMs = qMax(m_result.longestStallMs, m_stallStretch);
+        }
+
+        const QVector<PageCost> m_costs;
+        const int m_reportDpi;
+        const int m_window;
+        const int m_initialPages;
+        const qint64 m_cacheBytes;
+
+        Result m_result;
+        PageLayout m_layout;
+        int m_layoutDpi = -1;
+        int m_dpi = 0;
+        RenderView m_view;
+        QHash<int, Entry> m_cache; // One DPI per page: the latest render
+        qint64 m_cacheUsed = 0;
+        double m_guiFree = 0.0; // End of the pass in progress
+        double m_now = 0.0;
+        double m_stallStretch = 0.0;
+    };
+
+    void report(QTextStream &out, const Result &r)
+    {
+        const double frozenMs = r.frozenFrames * FRAME_MS;
+        const double blankMs = r.blankFrames * FRAME_MS;
+        const double blankPercent = r.frames > 0 ? 100.0 * r.blankFrames / r.frames : 0.0;
+        out << qSetFieldWidth(16) << Qt::left << r.policy << qSetFieldWidth(10) << Qt::right << r.renders
+            << qSetFieldWidth(10) << r.wasted << qSetFieldWidth(12) << QString::number(r.busyMs, 'f', 0)
+            << qSetFieldWidth(12) << QString::number(frozenMs, 'f', 0) << qSetFieldWidth(12)
+            << QString::number(blankMs, 'f', 0) << qSetFieldWidth(10) << QString::number(blankPercent, 'f', 1)
+            << qSetFieldWidth(14) << QString::number(r.longestStallMs, 'f', 0) << qSetFieldWidth(0) << "\n";
+        out.flush();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays a scroll trace against page render costs, per render policy.");
+    parser.addHelpOption();
+    const QCommandLineOption traceOption("trace", "Scroll trace (PDV_SCROLL_TRACE).", "csv");
+    const QCommandLineOption costsOption("costs", "Performance report CSV of the same document.", "csv");
+    const QCommandLineOption reportDpiOption("report-dpi", "DPI of a report CSV without a dpi column.", "dpi");
+    const QCommandLineOption documentOption("document", "Document of the trace to replay (0-based).", "index", "0");
+    const QCommandLineOption policyOption("policy", "Policy to simulate (repeatable; default: all).", "name");
+    const QCommandLineOption windowOption("window", "prefetch/window_pages.", "pages", "2");
+    const QCommandLineOption initialOption("initial-pages", "prefetch/initial_pages.", "pages", "5");
+    const QCommandLineOption cacheOption("cache-mb", "cache/render_mb.", "mb", "256");
+    parser.addOptions({traceOption, costsOption, reportDpiOption, documentOption, policyOption, windowOption,
+                       initialOption, cacheOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    if (!parser.isSet(traceOption) || !parser.isSet(costsOption))
+    {
+        err << "schedsim: --trace and --costs are required (see --help)\n";
+        return 2;
+    }
+
+    QString error;
+    int reportDpi = parser.value(reportDpiOption).toInt(); // 0 unless given: the CSV must say
+    const QVector<ScrollSample> allSamples = ScrollTrace::load(parser.value(traceOption), &error);
+    const QVector<PageCost> costs = error.isEmpty() ? loadCosts(parser.value(costsOption), &reportDpi, &error)
+                                                    : QVector<PageCost>();
+    if (error.isEmpty() && reportDpi <= 0)
+        error = parser.value(costsOption) + ": no dpi column; pass --report-dpi";
+    if (!error.isEmpty())
+    {
+        err << "schedsim: " << error << "\n";
+        return 2;
+    }
+
+    const int document = parser.value(documentOption).toInt();
+    QVector<ScrollSample> trace;
+    for (const ScrollSample &sample : allSamples)
+    {
+        if (sample.document == document)
+            trace.append(sample);
+    }
+    if (trace.isEmpty() || costs.isEmpty())
+    {
+        err << "schedsim: nothing to replay (document " << document << " has no samples, or no page costs)\n";
+        return 2;
+    }
+
+    QStringList policies = parser.values(policyOption);
+    if (policies.isEmpty())
+        policies = RenderPolicy::names();
+
+    Simulator simulator(costs, reportDpi, parser.value(windowOption).toInt(),
+                        parser.value(initialOption).toInt(), parser.value(cacheOption).toLongLong() << 20);
+
+    QTextStream out(stdout);
+    out << trace.size() << " samples over " << (trace.last().ms - trace.first().ms) << " ms, " << costs.size()
+        << " pages\n\n";
+    out << qSetFieldWidth(16) << Qt::left << "policy" << qSetFieldWidth(10) << Qt::right << "renders"
+        << qSetFieldWidth(10) << "wasted" << qSetFieldWidth(12) << "busy ms" << qSetFieldWidth(12) << "frozen ms"
+        << qSetFieldWidth(12) << "blank ms" << qSetFieldWidth(10) << "blank %" << qSetFieldWidth(14) << "stall ms"
+        << qSetFieldWidth(0) << "\n";
+
+    for (const QString &name : std::as_const(policies))
+    {
+        const std::unique_ptr<RenderPolicy> policy = RenderPolicy::create(name);
+        if (!policy)
+        {
+            err << "schedsim: unknown policy " << name << " (" << RenderPolicy::names().join(", ") << ")\n";
+            return 2;
+        }
+        report(out, simulator.run(*policy, trace));
+    }
+    return 0;
+}
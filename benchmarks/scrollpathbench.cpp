@@ -0,0 +1,200 @@
+/**
+ * scrollpathbench
+ * ---------------------------------------------------------------
+ * Microbenchmarks for the code that runs on every scroll / zoom event:
+ * ZoomController fit calculations, PageLayout geometry rebuilds, the
+ * visible-range heuristic and current-page lookup.
+ *
+ * Usage: scrollpathbench [filter]   (runs cases whose name contains filter)
+ *
+ * Synthetic documents of 10 .. 100k pages mix portrait, landscape and
+ * oversized pages so lookup paths cannot assume uniform heights. Each case
+ * reports the median ns/op of several timed batches; compare runs on the
+ * same machine, absolute numbers mean little.
+ */
+
+#include "pagelayout.h"
+#include "zoomcontroller.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+#include <random>
+
+namespace
+{
+    constexpr int PAGE_COUNTS[] = {10, 100, 1000, 10000, 100000};
+    constexpr int SPACING = 20;
+    constexpr int MARGINS = 50;
+    constexpr int VIEWPORT_WIDTH = 1280;
+    constexpr int VIEWPORT_HEIGHT = 900;
+    constexpr int AVG_PAGE_HEIGHT = 600; // Same heuristic as RenderPolicy "window"
+    constexpr int PRERENDER_PAGES = 2;
+    constexpr int BATCHES = 7;
+    constexpr qint64 MIN_BATCH_NS = 20 * 1000 * 1000;
+
+    volatile qint64 g_sink = 0; // Keeps results observable to the optimizer
+
+    // Deterministic mix: mostly A4 portrait, some landscape and A3 spreads
+    QVector<QSize> syntheticPages(int count, double zoom = 1.0)
+    {
+        std::mt19937 random(count);
+        std::uniform_int_distribution<int> kind(0, 99);
+
+        QVector<QSize> sizes;
+        sizes.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            const int k = kind(random);
+            const QSize base = k < 80 ? QSize(827, 1169) : k < 95 ? QSize(1169, 827) : QSize(1169, 1654);
+            sizes.append(QSize(int(base.width() * zoom), int(base.height() * zoom)));
+        }
+        return sizes;
+    }
+
+    // Median ns per operation; `body` performs `ops` operations per call
+    double measure(const std::function<void()> &body, int ops)
+    {
+        // Grow the batch until one call is long enough to time reliably
+        int repeats = 1;
+        QElapsedTimer timer;
+        for (;;)
+        {
+            timer.start();
+            for (int r = 0; r < repeats; ++r)
+                body();
+            if (timer.nsecsElapsed() >= MIN_BATCH_NS || repeats >= (1 << 24))
+                break;
+            repeats *= 2;
+        }
+
+        QVector<double> samples;
+        for (int b = 0; b < BATCHES; ++b)
+        {
+            timer.start();
+            for (int r = 0; r < repeats; ++r)
+                body();
+            samples.append(double(timer.nsecsElapsed()) / (double(repeats) * ops));
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    void report(QTextStream &out, const QString &name, int pages, double nsPerOp)
+    {
+        out << qSetFieldWidth(28) << Qt::left << name << qSetFieldWidth(10) << Qt::right
+            << (pages > 0 ? QString::number(pages) : QString("-")) << qSetFieldWidth(14)
+            << QString::number(nsPerOp, 'f', 1) << qSetFieldWidth(0) << " ns/op\n";
+        out.flush();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QString filter = app.arguments().value(1);
+
+    QTextStream out(stdout);
+    out << qSetFieldWidth(28) << Qt::left << "case" << qSetFieldWidth(10) << Qt::right << "pages"
+        << qSetFieldWidth(14) << "time" << qSetFieldWidth(0) << "\n";
+
+    auto run = [&](const QString &name, int pages, int ops, const std::function<void()> &body)
+    {
+        if (filter.isEmpty() || name.contains(filter))
+            report(out, name, pages, measure(body, ops));
+    };
+
+    const QMargins margins(MARGINS, MARGINS, MARGINS, MARGINS);
+
+    // Zoom fit (independent of page count) -----------------------
+    ZoomController zoom;
+    ViewportInfo viewport{VIEWPORT_WIDTH, VIEWPORT_HEIGHT, 2 * MARGINS, 2 * MARGINS};
+    const PageInfo firstPage{827, 1169};
+
+    run("zoom.calculateFitWidth", 0, 256, [&]
+        {
+            for (int w = 0; w < 256; ++w)
+            {
+                viewport.width = VIEWPORT_WIDTH + w;
+                g_sink = g_sink + qint64(zoom.calculateFitWidth(viewport, firstPage) * 1000);
+            }
+        });
+
+    run("zoom.calculateFitPage", 0, 256, [&]
+        {
+            for (int h = 0; h < 256; ++h)
+            {
+                viewport.height = VIEWPORT_HEIGHT + h;
+                g_sink = g_sink + qint64(zoom.calculateFitPage(viewport, firstPage) * 1000);
+            }
+        });
+
+    // Resize while fitted: recalculation plus zoomChanged emission
+    zoom.fitToPage(viewport, firstPage);
+    run("zoom.onViewportResize", 0, 256, [&]
+        {
+            for (int h = 0; h < 256; ++h)
+            {
+                viewport.height = VIEWPORT_HEIGHT + h;
+                zoom.onViewportResize(viewport, firstPage);
+            }
+            g_sink = g_sink + qint64(zoom.currentZoom() * 1000);
+        });
+
+    // Layout and lookup per document size ------------------------
+    for (int pages : PAGE_COUNTS)
+    {
+        const QVector<QSize> sizes = syntheticPages(pages);
+        const QVector<QSize> zoomed = syntheticPages(pages, 1.2);
+        PageLayout layout;
+        layout.setGeometry(sizes, SPACING, margins);
+
+        // Scroll offsets spread over the whole document
+        const int contentHeight = layout.contentSize().height();
+        QVector<int> offsets(1024);
+        std::mt19937 random(pages);
+        std::uniform_int_distribution<int> offset(0, qMax(0, contentHeight - VIEWPORT_HEIGHT));
+        for (int &o : offsets)
+            o = offset(random);
+
+        // What updateContentGeometry() does after every render pass
+        bool flip = false;
+        run("layout.setGeometry", pages, 1, [&]
+            {
+                layout.setGeometry(flip ? zoomed : sizes, SPACING, margins);
+                flip = !flip;
+                g_sink = g_sink + layout.contentSize().height();
+            });
+        layout.setGeometry(sizes, SPACING, margins);
+
+        run("layout.contentSize", pages, 1, [&]
+            { g_sink = g_sink + layout.contentSize().height(); });
+
+        run("layout.pageRect", pages, offsets.size(), [&]
+            {
+                for (int o : offsets)
+                    g_sink = g_sink + layout.pageRect(o % pages).top();
+            });
+
+        // NavigationController::updateCurrentPageFromScroll()
+        run("navigation.currentPage", pages, offsets.size(), [&]
+            {
+                for (int o : offsets)
+                    g_sink = g_sink + layout.currentPage(o, VIEWPORT_HEIGHT);
+            });
+
+        // PageManager::renderVisiblePages() range selection
+        run("pages.visibleRange", pages, offsets.size(), [&]
+            {
+                for (int o : offsets)
+                {
+                    const QPair<int, int> range = PageLayout::estimatedVisibleRange(
+                        o, VIEWPORT_HEIGHT, PRERENDER_PAGES, AVG_PAGE_HEIGHT, pages);
+                    g_sink = g_sink + range.first + range.second;
+                }
+            });
+    }
+
+    return 0;
+}
@@ -0,0 +1,418 @@
+/**
+ * DeepZoomExporter implementation
+ * ---------------------------------------------------------------
+ * Two thread groups joined by a bounded queue: renderers pull jobs from a
+ * shared list and push finished tiles, encoders write them to disk.
+ */
+
+#include "deepzoomexporter.h"
+#include "pdfdocument.h"
+#include "imagescaler.h"
+#include "viewerconfig.h"
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QtMath>
+#include <cstring>
+
+// Construction -----------------------------------------------------
+DeepZoomExporter::DeepZoomExporter(const QStringList &arguments)
+{
+    if (!parseArguments(arguments))
+    {
+        m_exitCode = 2;
+    }
+}
+
+bool DeepZoomExporter::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--export-dzi") == 0 || std::strncmp(argv[i], "--export-dzi=", 13) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool DeepZoomExporter::parseArguments(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.addOption(QCommandLineOption("export-dzi", "Output directory.", "directory"));
+    parser.addOption(QCommandLineOption("dpi", "Resolution of the top level (default 300).", "dpi"));
+    parser.addOption(QCommandLineOption("tile-size", "Tile size without overlap (default 254).", "pixels"));
+    parser.addOption(QCommandLineOption("overlap", "Tile overlap (default 1).", "pixels"));
+    parser.addOption(QCommandLineOption("format", "png or jpg (default png).", "format"));
+    parser.addOption(QCommandLineOption("jpeg-quality", "0-100 (default 85).", "quality"));
+    parser.addPositionalArgument("file", "PDF to export.");
+    if (!parser.parse(arguments))
+    {
+        qWarning() << "DeepZoomExporter:" << parser.errorText();
+        return false;
+    }
+
+    auto number = [&](const char *name, int minimum, int maximum, int &target)
+    {
+        if (!parser.isSet(name))
+            return true;
+        bool ok = false;
+        const int value = parser.value(name).toInt(&ok);
+        if (!ok || value < minimum || value > maximum)
+        {
+            qWarning() << "DeepZoomExporter: invalid --" + QString(name) << parser.value(name);
+            return false;
+        }
+        target = value;
+        return true;
+    };
+    if (!number("dpi", 10, 2400, m_dpi) || !number("tile-size", 16, 4096, m_tileSize) ||
+        !number("overlap", 0, 64, m_overlap) || !number("jpeg-quality", 0, 100, m_jpegQuality))
+    {
+        return false;
+    }
+
+    if (parser.isSet("format"))
+    {
+        m_format = parser.value("format").toLower().toLatin1();
+        if (m_format == "jpeg")
+            m_format = "jpg";
+        if (m_format != "png" && m_format != "jpg")
+        {
+            qWarning() << "DeepZoomExporter: unsupported format" << m_format;
+            return false;
+        }
+    }
+
+    m_outputDirectory = parser.value("export-dzi");
+    const QStringList files = parser.positionalArguments();
+    if (m_outputDirectory.isEmpty() || files.size() != 1)
+    {
+        qWarning() << "DeepZoomExporter: usage: --export-dzi <out-dir> [options] <file.pdf>";
+        return false;
+    }
+    m_input = files.first();
+    return true;
+}
+
+// Planning ---------------------------------------------------------
+// Sizes every page, writes the descriptors and creates all directories up
+// front, so workers never race on mkdir.
+bool DeepZoomExporter::plan()
+{
+    PDFDocument document;
+    if (!document.loadFromFile(m_input, PDFDocument::FileIdentity::None))
+    {
+        qWarning() << "DeepZoomExporter: cannot open" << m_input;
+        return false;
+    }
+
+    QDir output(m_outputDirectory);
+    if (!output.mkpath("."))
+    {
+        qWarning() << "DeepZoomExporter: cannot create" << m_outputDirectory;
+        return false;
+    }
+
+    const QVector<QSizeF> &pageSizes = document.pageSizes();
+    for (int i = 0; i < pageSizes.size(); ++i)
+    {
+        PagePlan plan;
+        plan.pageIndex = i;
+        plan.size = QSize(qCeil(pageSizes[i].width() * m_dpi / 72.0), qCeil(pageSizes[i].height() * m_dpi / 72.0));
+        if (plan.size.isEmpty() || qMax(plan.size.width(), plan.size.height()) > MAX_PAGE_DIMENSION)
+        {
+            qWarning() << "DeepZoomExporter: page" << i + 1 << "is" << plan.size << "px at" << m_dpi
+                       << "DPI - lower --dpi";
+            return false;
+        }
+
+        while ((1 << plan.maxLevel) < qMax(plan.size.width(), plan.size.height()))
+            ++plan.maxLevel;
+
+        plan.fullLevel = plan.maxLevel;
+        while (plan.fullLevel > 0 &&
+               qint64(levelSize(plan, plan.fullLevel).width()) * levelSize(plan, plan.fullLevel).height() >
+                   FULL_RENDER_PIXELS)
+        {
+            --plan.fullLevel;
+        }
+
+        const QString name = QString("page-%1").arg(i + 1, 4, 10, QChar('0'));
+        plan.tileDirectory = output.filePath(name + "_files");
+        for (int level = 0; level <= plan.maxLevel; ++level)
+        {
+            if (!QDir().mkpath(plan.tileDirectory + "/" + QString::number(level)))
+            {
+                qWarning() << "DeepZoomExporter: cannot create" << plan.tileDirectory;
+                return false;
+            }
+        }
+
+        QSaveFile descriptor(output.filePath(name + ".dzi"));
+        if (!descriptor.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            qWarning() << "DeepZoomExporter: cannot write" << descriptor.fileName();
+            return false;
+        }
+        descriptor.write(QString("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                 "<Image xmlns=\"http://schemas.microsoft.com/deepzoom/2008\" Format=\"%1\" "
+                                 "Overlap=\"%2\" TileSize=\"%3\">\n"
+                                 "  <Size Width=\"%4\" Height=\"%5\"/>\n"
+                                 "</Image>\n")
+                             .arg(QString::fromLatin1(m_format))
+                             .arg(m_overlap)
+                             .arg(m_tileSize)
+                             .arg(plan.size.width())
+                             .arg(plan.size.height())
+                             .toUtf8());
+        if (!descriptor.commit())
+        {
+            qWarning() << "DeepZoomExporter: cannot write" << descriptor.fileName();
+            return false;
+        }
+
+        // The whole-page job is the longest: queue it before the page's tiles
+        const int planIndex = m_plans.size();
+        m_plans.append(plan);
+        m_jobs.append({planIndex, plan.fullLevel, 0, 0});
+        for (int level = plan.maxLevel; level > plan.fullLevel; --level)
+        {
+            const QSize size = levelSize(plan, level);
+            for (int row = 0; row * m_tileSize < size.height(); ++row)
+            {
+                for (int column = 0; column * m_tileSize < size.width(); ++column)
+                    m_jobs.append({planIndex, level, column, row});
+            }
+        }
+    }
+    return !m_plans.isEmpty();
+}
+
+// Run --------------------------------------------------------------
+int DeepZoomExporter::exec()
+{
+    if (m_exitCode != 0)
+    {
+        return m_exitCode;
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+    if (!plan())
+    {
+        return 1;
+    }
+
+    // Rendering dominates; a smaller encoder group keeps up with it
+    const int configured = ViewerConfig::instance().settings().workerThreads;
+    const int renderers = configured > 0 ? configured : QThread::idealThreadCount();
+    const int encoders = qMax(1, renderers / 2);
+
+    qInfo() << "DeepZoomExporter:" << m_plans.size() << "pages," << m_jobs.size() << "render jobs," << renderers
+            << "renderers," << encoders << "encoders";
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(renderers + encoders);
+
+    QVector<QFuture<void>> encoding;
+    for (int i = 0; i < encoders; ++i)
+        encoding.append(QtConcurrent::run(&pool, [this]() { encodeWorker(); }));
+
+    QVector<QFuture<void>> rendering;
+    for (int i = 0; i < renderers; ++i)
+        rendering.append(QtConcurrent::run(&pool, [this]() { renderWorker(); }));
+
+    for (QFuture<void> &future : rendering)
+        future.waitForFinished();
+    {
+        QMutexLocker lock(&m_mutex);
+        m_renderingDone = true;
+        m_notEmpty.wakeAll();
+    }
+    for (QFuture<void> &future : encoding)
+        future.waitForFinished();
+
+    if (m_failed.loadAcquire())
+    {
+        qWarning().noquote() << "DeepZoomExporter: FAILED -" << m_error;
+        return 1;
+    }
+
+    qInfo() << "DeepZoomExporter:" << m_tilesWritten.loadRelaxed() << "tiles in" << clock.elapsed() / 1000.0 << "s ->"
+            << QDir(m_outputDirectory).absolutePath();
+    return 0;
+}
+
+// Render stage -----------------------------------------------------
+void DeepZoomExporter::renderWorker()
+{
+    // Poppler documents are not thread-safe: one per worker
+    PDFDocument document;
+    if (!document.loadFromFile(m_input, PDFDocument::FileIdentity::None))
+    {
+        fail("worker cannot open " + m_input);
+        return;
+    }
+
+    std::unique_ptr<Poppler::Page> page;
+    int pageIndex = -1;
+
+    while (!m_failed.loadRelaxed())
+    {
+        const int next = m_nextJob.fetchAndAddRelaxed(1);
+        if (next >= m_jobs.size())
+            break;
+
+        const RenderJob &job = m_jobs[next];
+        const PagePlan &plan = m_plans[job.plan];
+        if (plan.pageIndex != pageIndex)
+        {
+            page = document.getPage(plan.pageIndex);
+            pageIndex = plan.pageIndex;
+        }
+        if (!page)
+        {
+            fail(QString("cannot load page %1").arg(plan.pageIndex + 1));
+            break;
+        }
+
+        const double dpi = m_dpi / double(1 << (plan.maxLevel - job.level));
+        if (job.level == plan.fullLevel)
+        {
+            renderLowerLevels(plan, page->renderToImage(dpi, dpi));
+            continue;
+        }
+
+        const QRect rect = tileRect(plan, job.level, job.column, job.row);
+        QImage tile = page->renderToImage(dpi, dpi, rect.x(), rect.y(), rect.width(), rect.height());
+        if (tile.isNull())
+        {
+            fail(QString("render failed: page %1 level %2").arg(plan.pageIndex + 1).arg(job.level));
+            break;
+        }
+        push({tile, tilePath(plan, job.level, job.column, job.row)});
+    }
+}
+
+void DeepZoomExporter::renderLowerLevels(const PagePlan &plan, QImage image)
+{
+    if (image.isNull())
+    {
+        fail(QString("render failed: page %1").arg(plan.pageIndex + 1));
+        return;
+    }
+
+    // Poppler may round the page a pixel differently: snap to the level size,
+    // then halve with the box filter down to the 1x1 level
+    for (int level = plan.fullLevel; level >= 0 && !m_failed.loadRelaxed(); --level)
+    {
+        image = ImageScaler::areaDownscale(image, levelSize(plan, level));
+        if (image.isNull())
+        {
+            fail(QString("out of memory downscaling page %1").arg(plan.pageIndex + 1));
+            return;
+        }
+        emitTiles(plan, level, image);
+    }
+}
+
+void DeepZoomExporter::emitTiles(const PagePlan &plan, int level, const QImage &image)
+{
+    for (int row = 0; row * m_tileSize < image.height(); ++row)
+    {
+        for (int column = 0; column * m_tileSize < image.width(); ++column)
+            push({image.copy(tileRect(plan, level, column, row)), tilePath(plan, level, column, row)});
+    }
+}
+
+// Encode stage -----------------------------------------------------
+void DeepZoomExporter::encodeWorker()
+{
+    Tile tile;
+    while (pop(tile))
+    {
+        QImageWriter writer(tile.path, m_format);
+        if (m_format == "jpg")
+        {
+            writer.setQuality(m_jpegQuality);
+            tile.image = tile.image.convertToFormat(QImage::Format_RGB32); // No alpha in JPEG
+        }
+        if (!writer.write(tile.image))
+        {
+            fail(tile.path + ": " + writer.errorString());
+            return;
+        }
+        m_tilesWritten.fetchAndAddRelaxed(1);
+    }
+}
+
+// Pipeline ---------------------------------------------------------
+void DeepZoomExporter::push(Tile tile)
+{
+    QMutexLocker lock(&m_mutex);
+    while (m_queue.size() >= QUEUE_CAPACITY && !m_failed.loadRelaxed())
+        m_notFull.wait(&m_mutex);
+    if (m_failed.loadRelaxed())
+        return;
+
+    m_queue.enqueue(std::move(tile));
+    m_notEmpty.wakeOne();
+}
+
+bool DeepZoomExporter::pop(Tile &tile)
+{
+    QMutexLocker lock(&m_mutex);
+    while (m_queue.isEmpty() && !m_renderingDone && !m_failed.loadRelaxed())
+        m_notEmpty.wait(&m_mutex);
+    if (m_queue.isEmpty() || m_failed.loadRelaxed())
+        return false;
+
+    tile = m_queue.dequeue();
+    m_notFull.wakeOne();
+    return true;
+}
+
+void DeepZoomExporter::fail(const QString &error)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_failed.testAndSetRelaxed(0, 1))
+        m_error = error;
+    m_queue.clear();
+    m_notEmpty.wakeAll();
+    m_notFull.wakeAll();
+}
+
+// Geometry ---------------------------------------------------------
+QSize DeepZoomExporter::levelSize(const PagePlan &plan, int level) const
+{
+    const int shift = plan.maxLevel - level;
+    const int divisor = 1 << shift;
+    return QSize((plan.size.width() + divisor - 1) >> shift, (plan.size.height() + divisor - 1) >> shift);
+}
+
+QRect DeepZoomExporter::tileRect(const PagePlan &plan, int level, int column, int row) const
+{
+    // Interior edges carry `overlap` extra pixels on each side
+    const QSize size = levelSize(plan, level);
+    const int left = qMax(0, column * m_tileSize - m_overlap);
+    const int top = qMax(0, row * m_tileSize - m_overlap);
+    const int right = qMin(size.width(), (column + 1) * m_tileSize + m_overlap);
+    const int bottom = qMin(size.height(), (row + 1) * m_tileSize + m_overlap);
+    return QRect(left, top, right - left, bottom - top);
+}
+
+QString DeepZoomExporter::tilePath(const PagePlan &plan, int level, int column, int row) const
+{
+    return QString("%1/%2/%3_%4.%5")
+        .arg(plan.tileDirectory)
+        .arg(level)
+        .arg(column)
+        .arg(row)
+        .arg(QString::fromLatin1(m_format));
+}
@@ -0,0 +1,123 @@
+#ifndef DEEPZOOMEXPORTER_H
+#define DEEPZOOMEXPORTER_H
+
+#include <QAtomicInt>
+#include <QImage>
+#include <QMutex>
+#include <QQueue>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+
+/**
+ * DeepZoomExporter
+ * ---------------------------------------------------------------
+ * Headless tile pyramid export for static serving:
+ * `PrettyDopeFileviewer --export-dzi <out-dir> [--dpi 300] [--tile-size 254]
+ * [--overlap 1] [--format png|jpg] [--jpeg-quality 85] <file.pdf>`.
+ *
+ * Responsibilities:
+ *  - Write one Deep Zoom image per page: page-NNNN.dzi (descriptor) and
+ *    page-NNNN_files/<level>/<col>_<row>.<format>, level 0 being 1x1 and
+ *    the top level the page at --dpi.
+ *  - Render on every worker thread (each with its own Poppler document),
+ *    encode on a second pool fed through a bounded queue: rasterizing and
+ *    PNG/JPEG compression overlap instead of alternating.
+ *
+ * Design notes:
+ *  - Large levels are rendered tile by tile (Poppler region renders), so
+ *    memory stays flat however big the drawing. Once a level fits in
+ *    FULL_RENDER_PIXELS, that level is rendered whole and every smaller
+ *    one is derived from it with ImageScaler's exact box filter (halving
+ *    at a time), which is both faster and sharper than re-rasterizing.
+ *  - Quality hints come from ViewerConfig (render/quality); drawings want
+ *    at least "standard".
+ *  - Exit code: 0 done, 1 render/write failure, 2 bad arguments.
+ */
+class DeepZoomExporter
+{
+public:
+    explicit DeepZoomExporter(const QStringList &arguments);
+
+    static bool isRequested(int argc, char *argv[]); // Before QApplication: picks the platform.
+    int exec(); // Blocks until every tile is written; returns the process exit code.
+
+    static constexpr int DEFAULT_DPI = 300;
+    static constexpr int DEFAULT_TILE_SIZE = 254; // + 2 * overlap = 256 px tiles
+    static constexpr int DEFAULT_OVERLAP = 1;
+    static constexpr int DEFAULT_JPEG_QUALITY = 85;
+    static constexpr qint64 FULL_RENDER_PIXELS = 2048ll * 2048; // 16 MiB per renderer
+    static constexpr int MAX_PAGE_DIMENSION = 1 << 16; // Poppler/QImage limits
+    static constexpr int QUEUE_CAPACITY = 128;         // Encoded-pending tiles (~32 MiB at 256 px)
+
+private:
+    struct PagePlan
+    {
+        int pageIndex = 0;
+        QSize size;         // Top level, pixels
+        int maxLevel = 0;   // ceil(log2(max side))
+        int fullLevel = 0;  // Highest level rendered whole; those below are downscaled
+        QString tileDirectory;
+    };
+
+    struct RenderJob
+    {
+        int plan = 0;
+        int level = 0;   // Tile render; fullLevel means "whole page + smaller levels"
+        int column = 0;
+        int row = 0;
+    };
+
+    struct Tile
+    {
+        QImage image;
+        QString path;
+    };
+
+    bool parseArguments(const QStringList &arguments);
+    bool plan();
+
+    void renderWorker();
+    void encodeWorker();
+    void renderLowerLevels(const PagePlan &plan, QImage image);
+    void emitTiles(const PagePlan &plan, int level, const QImage &image);
+
+    QSize levelSize(const PagePlan &plan, int level) const;
+    QRect tileRect(const PagePlan &plan, int level, int column, int row) const;
+    QString tilePath(const PagePlan &plan, int level, int column, int row) const;
+
+    void push(Tile tile);
+    bool pop(Tile &tile);
+    void fail(const QString &error);
+
+    // Arguments
+    QString m_input;
+    QString m_outputDirectory;
+    int m_dpi = DEFAULT_DPI;
+    int m_tileSize = DEFAULT_TILE_SIZE;
+    int m_overlap = DEFAULT_OVERLAP;
+    QByteArray m_format = "png";
+    int m_jpegQuality = DEFAULT_JPEG_QUALITY;
+    int m_exitCode = 0;
+
+    // Work list (read-only once workers start)
+    QVector<PagePlan> m_plans;
+    QVector<RenderJob> m_jobs;
+    QAtomicInt m_nextJob{0};
+
+    // Render -> encode pipeline (guarded by m_mutex)
+    QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    QQueue<Tile> m_queue;
+    bool m_renderingDone = false;
+    QString m_error;
+
+    QAtomicInt m_failed{0};
+    QAtomicInt m_tilesWritten{0};
+};
+
+#endif // DEEPZOOMEXPORTER_H
@@ -0,0 +1,253 @@
+/**
+ * DocumentSearch implementation
+ * ---------------------------------------------------------------
+ * One QtConcurrent task per document reporting hits through its QPromise;
+ * a watcher per task forwards them to the GUI thread in batches.
+ */
+
+#include "documentsearch.h"
+#include "pdfdocument.h"
+#include <QDebug>
+#include <QRectF>
+#include <QtConcurrent>
+
+namespace
+{
+    bool isWordCharacter(const QString &text, qsizetype index)
+    {
+        return index >= 0 && index < text.size() && text.at(index).isLetterOrNumber();
+    }
+
+    QString snippetAround(const QString &text, qsizetype position, qsizetype length)
+    {
+        const qsizetype from = qMax<qsizetype>(0, position - DocumentSearch::SNIPPET_CONTEXT);
+        const qsizetype to = qMin<qsizetype>(text.size(), position + length + DocumentSearch::SNIPPET_CONTEXT);
+
+        QString snippet = text.mid(from, to - from).simplified();
+        if (from > 0)
+            snippet.prepend(QChar(0x2026));
+        if (to < text.size())
+            snippet.append(QChar(0x2026));
+        return snippet;
+    }
+}
+
+// Construction -----------------------------------------------------
+DocumentSearch::DocumentSearch(QObject *parent) : QObject(parent)
+{
+}
+
+DocumentSearch::~DocumentSearch()
+{
+    // Workers write into m_textCache
+    cancel();
+}
+
+// Queries ----------------------------------------------------------
+void DocumentSearch::start(const QString &query, const QVector<SearchSource> &sources, int maxErrors)
+{
+    cancel();
+    m_documentCount = sources.size();
+    m_timer.start();
+
+    if (query.isEmpty() || sources.isEmpty())
+    {
+        emit finished(0, 0);
+        return;
+    }
+
+    for (int i = 0; i < sources.size(); ++i)
+    {
+        auto *watcher = new QFutureWatcher<SearchHit>(this);
+        connect(watcher, &QFutureWatcherBase::resultsReadyAt, this, [this, watcher](int begin, int end)
+                { onResultsReady(watcher, begin, end); });
+        connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]()
+                { onWatcherFinished(watcher); });
+
+        m_watchers.append(watcher);
+        watcher->setFuture(QtConcurrent::run(&DocumentSearch::searchDocument, sources[i], i, query, maxErrors, &m_textCache));
+    }
+}
+
+void DocumentSearch::cancel()
+{
+    for (QFutureWatcher<SearchHit> *watcher : std::as_const(m_watchers))
+    {
+        watcher->disconnect(this); // Nothing from a stale query reaches the results
+        watcher->cancel();
+    }
+    for (QFutureWatcher<SearchHit> *watcher : std::as_const(m_watchers))
+    {
+        // Workers check for cancellation between pages
+        watcher->waitForFinished();
+        delete watcher;
+    }
+    m_watchers.clear();
+}
+
+void DocumentSearch::onResultsReady(QFutureWatcher<SearchHit> *watcher, int begin, int end)
+{
+    QVector<SearchHit> hits;
+    hits.reserve(end - begin);
+    for (int i = begin; i < end; ++i)
+    {
+        hits.append(watcher->resultAt(i));
+    }
+    emit hitsFound(hits);
+}
+
+void DocumentSearch::onWatcherFinished(QFutureWatcher<SearchHit> *watcher)
+{
+    m_watchers.removeOne(watcher);
+    watcher->deleteLater();
+
+    if (m_watchers.isEmpty())
+    {
+        emit finished(m_documentCount, m_timer.elapsed());
+    }
+}
+
+// Matching ---------------------------------------------------------
+SearchHit DocumentSearch::matchPage(const QString &text, const QString &query)
+{
+    SearchHit hit;
+    if (query.isEmpty())
+    {
+        return hit;
+    }
+
+    qsizetype best = -1;
+    double bestWeight = 0.0;
+    for (qsizetype position = text.indexOf(query, 0, Qt::CaseInsensitive); position >= 0;
+         position = text.indexOf(query, position + query.size(), Qt::CaseInsensitive))
+    {
+        if (++hit.matches > MAX_COUNTED_MATCHES)
+            continue;
+
+        // Whole words outrank fragments; matching case breaks ties
+        const bool wholeWord = !isWordCharacter(text, position - 1) && !isWordCharacter(text, position + query.size());
+        const bool exactCase = QStringView(text).mid(position, query.size()) == query;
+        const double weight = 1.0 + (wholeWord ? 1.0 : 0.0) + (exactCase ? 0.5 : 0.0);
+
+        hit.score += weight;
+        if (weight > bestWeight)
+        {
+            bestWeight = weight;
+            best = position;
+        }
+    }
+
+    if (best >= 0)
+    {
+        hit.snippet = snippetAround(text, best, query.size());
+    }
+    return hit;
+}
+
+SearchHit DocumentSearch::matchPage(const QString &text, const FuzzyMatcher &matcher)
+{
+    SearchHit hit;
+    qsizetype best = -1;
+    double bestWeight = 0.0;
+    for (const FuzzyMatcher::Match &match : matcher.find(text))
+    {
+        if (++hit.matches > MAX_COUNTED_MATCHES)
+            continue;
+
+        // Exact occurrences weigh like whole words; every edit gives up part of that bonus
+        const double weight = 2.0 - double(match.errors) / (matcher.maxErrors() + 1);
+
+        hit.score += weight;
+        if (weight > bestWeight)
+        {
+            bestWeight = weight;
+            best = match.end;
+        }
+    }
+
+    if (best >= 0)
+    {
+        const qsizetype length = matcher.patternLength();
+        hit.snippet = snippetAround(text, qMax<qsizetype>(0, best - length + 1), length);
+    }
+    return hit;
+}
+
+// Worker -----------------------------------------------------------
+void DocumentSearch::searchDocument(QPromise<SearchHit> &promise, const SearchSource &source, int sourceIndex,
+                                    const QString &query, int maxErrors, TextCache *cache)
+{
+    // Equality masks built once per document, not per page
+    const FuzzyMatcher matcher(query, maxErrors);
+    const bool fuzzy = matcher.isValid() && matcher.maxErrors() > 0;
+
+    auto search = [&](const QString &text, int pageIndex)
+    {
+        SearchHit hit = fuzzy ? matchPage(text, matcher) : matchPage(text, query);
+        if (hit.matches == 0)
+            return;
+        hit.source = sourceIndex;
+        hit.page = pageIndex;
+        promise.addResult(hit);
+    };
+
+    auto searchCached = [&](const QStringList &pages)
+    {
+        for (int i = 0; i < pages.size() && !promise.isCanceled(); ++i)
+            search(pages[i], i);
+    };
+
+    // Searched before: no Poppler at all
+    const QByteArray knownHash = source.contentHash.isEmpty() ? cache->fileHash(source.filePath) : source.contentHash;
+    QStringList pages = cache->pages(knownHash);
+    if (!pages.isEmpty())
+    {
+        searchCached(pages);
+        return;
+    }
+
+    // Hash only what has no known identity: the text is cached under it
+    PDFDocument document;
+    if (!source.filePath.isEmpty())
+    {
+        const auto identity = knownHash.isEmpty() ? PDFDocument::FileIdentity::Content : PDFDocument::FileIdentity::None;
+        if (!document.loadFromFile(source.filePath, identity))
+        {
+            qWarning() << "DocumentSearch: Cannot open" << source.filePath;
+            return;
+        }
+    }
+    else if (source.data.isEmpty() || !document.loadFromData(source.data, source.title, knownHash))
+    {
+        return; // Remote, or nothing parseable
+    }
+
+    const QByteArray contentHash = knownHash.isEmpty() ? document.contentHash() : knownHash;
+    if (knownHash.isEmpty())
+    {
+        if (!source.filePath.isEmpty())
+            cache->setFileHash(source.filePath, contentHash);
+
+        // Same content already extracted under another path
+        pages = cache->pages(contentHash);
+        if (!pages.isEmpty())
+        {
+            searchCached(pages);
+            return;
+        }
+    }
+
+    // Extract and search in one pass: hits stream from the first page on
+    const int pageCount = document.pageCount();
+    pages.reserve(pageCount);
+    for (int i = 0; i < pageCount; ++i)
+    {
+        if (promise.isCanceled())
+            return;
+
+        auto page = document.getPage(i);
+        pages.append(page ? page->text(QRectF()) : QString());
+        search(pages.last(), i);
+    }
+    cache->insert(contentHash, pages);
+}
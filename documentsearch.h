@@ -0,0 +1,104 @@
+#ifndef DOCUMENTSEARCH_H
+#define DOCUMENTSEARCH_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QPromise>
+#include <QString>
+#include <QVector>
+#include "fuzzymatcher.h"
+#include "textcache.h"
+
+/**
+ * SearchSource
+ * One searchable document: a file on disk or the bytes of an in-memory
+ * PDF, plus its content hash when known.
+ */
+struct SearchSource
+{
+    QString filePath;
+    QByteArray data;        // In-memory PDF (stdin), shared with its PDFDocument; when no filePath.
+    QByteArray contentHash; // Optional: skips opening the document when the text is cached.
+    QString title;
+    int queueIndex = -1;    // Reading queue position; -1 = the document on screen.
+};
+
+/**
+ * SearchHit
+ * One page that matches, scored so hits from any document compare.
+ */
+struct SearchHit
+{
+    int source = -1; // Index into the sources passed to start()
+    int page = -1;
+    int matches = 0;
+    double score = 0.0;
+    QString snippet; // Context around the best match, whitespace collapsed.
+};
+
+/**
+ * DocumentSearch
+ * ---------------------------------------------------------------
+ * One query fanned out over several documents at once.
+ *
+ * Responsibilities:
+ *  - Run one worker per document on the shared thread pool (sized by
+ *    ViewerConfig workers/threads); each opens its own PDFDocument.
+ *  - Read page text from the TextCache when the document was searched
+ *    before; otherwise extract it, searching while extracting, and store
+ *    the complete text for the next query.
+ *  - Match exactly, or within an edit distance (FuzzyMatcher) for OCR'd
+ *    and badly encoded text; both scan cached text at memory speed.
+ *  - Stream hits to the GUI thread as workers produce them.
+ *
+ * Design notes:
+ *  - Poppler is only touched on the workers, never concurrently on the
+ *    same document: the on-screen document is reopened from its file.
+ *  - In-memory documents (stdin) are parsed from their bytes like files.
+ *    Remote ones (URL) are not searched: extracting their text would
+ *    download the whole file.
+ *  - start() cancels the previous query; cancel() waits at most one page
+ *    extraction per worker.
+ */
+class DocumentSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DocumentSearch(QObject *parent = nullptr);
+    ~DocumentSearch() override;
+
+    // maxErrors > 0: approximate search (falls back to exact past FuzzyMatcher limits)
+    void start(const QString &query, const QVector<SearchSource> &sources, int maxErrors = 0);
+    void cancel();
+    bool isRunning() const { return !m_watchers.isEmpty(); }
+
+    TextCache *textCache() { return &m_textCache; }
+
+    // Matching (also usable on its own) ------------------------------
+    static SearchHit matchPage(const QString &text, const QString &query); // matches == 0 if none.
+    static SearchHit matchPage(const QString &text, const FuzzyMatcher &matcher);
+
+    static constexpr int MAX_COUNTED_MATCHES = 20; // Per page; more adds nothing to the score.
+    static constexpr int SNIPPET_CONTEXT = 40;     // Characters each side of the match.
+
+signals:
+    void hitsFound(const QVector<SearchHit> &hits);
+    void finished(int documentCount, qint64 elapsedMs);
+
+private:
+    void onResultsReady(QFutureWatcher<SearchHit> *watcher, int begin, int end);
+    void onWatcherFinished(QFutureWatcher<SearchHit> *watcher);
+
+    static void searchDocument(QPromise<SearchHit> &promise, const SearchSource &source, int sourceIndex,
+                               const QString &query, int maxErrors, TextCache *cache);
+
+    QVector<QFutureWatcher<SearchHit> *> m_watchers; // Running workers of the current query.
+    int m_documentCount = 0;
+    QElapsedTimer m_timer;
+    TextCache m_textCache;
+};
+
+#endif // DOCUMENTSEARCH_H
@@ -0,0 +1,182 @@
+/**
+ * FormFieldModel implementation
+ * ---------------------------------------------------------------
+ * Converts Poppler form fields into flat FormFieldEntry records, page by page.
+ */
+
+#include "formfieldmodel.h"
+#include "pdfdocument.h"
+#include <QDebug>
+
+namespace
+{
+    constexpr int PAGE_NOT_LOADED = -2;
+    constexpr int PAGE_WITHOUT_FIELDS = -1;
+}
+
+FormFieldModel::FormFieldModel(PDFDocument *document) : m_document(document)
+{
+    const int pages = m_document ? m_document->pageCount() : 0;
+    m_pageFirst.fill(PAGE_NOT_LOADED, pages);
+    m_pageCount.fill(0, pages);
+    m_account.setBytes(qint64(pages) * 2 * sizeof(int));
+}
+
+// Page Slices ------------------------------------------------------
+
+void FormFieldModel::ensurePageLoaded(int pageIndex)
+{
+    if (pageIndex < 0 || pageIndex >= m_pageFirst.size() || m_pageFirst[pageIndex] != PAGE_NOT_LOADED)
+        return;
+
+    m_pageFirst[pageIndex] = PAGE_WITHOUT_FIELDS;
+
+    auto page = m_document->getPage(pageIndex);
+    if (!page)
+        return;
+
+    const int first = m_fields.size();
+    for (const std::unique_ptr<Poppler::FormField> &field : page->formFields())
+    {
+        if (!field->isVisible())
+            continue;
+
+        FormFieldEntry entry;
+        entry.pageIndex = pageIndex;
+        entry.fieldId = field->id();
+        entry.rect = field->rect();
+        entry.name = field->name();
+        entry.readOnly = field->isReadOnly();
+
+        switch (field->type())
+        {
+        case Poppler::FormField::FormText:
+            entry.kind = FormFieldEntry::Kind::Text;
+            entry.text = static_cast<Poppler::FormFieldText *>(field.get())->text();
+            break;
+
+        case Poppler::FormField::FormButton:
+        {
+            auto *button = static_cast<Poppler::FormFieldButton *>(field.get());
+            if (button->buttonType() == Poppler::FormFieldButton::Push)
+                continue; // Actions are out of scope for the overlay
+            entry.kind = FormFieldEntry::Kind::CheckBox;
+            entry.checked = button->state();
+            break;
+        }
+
+        case Poppler::FormField::FormChoice:
+        {
+            auto *choice = static_cast<Poppler::FormFieldChoice *>(field.get());
+            entry.kind = FormFieldEntry::Kind::Choice;
+            entry.choices = choice->choices();
+            const QList<int> current = choice->currentChoices();
+            entry.currentChoice = current.isEmpty() ? -1 : current.first();
+            break;
+        }
+
+        default:
+            continue; // Signatures: display only
+        }
+
+        m_fields.append(entry);
+    }
+
+    // Fields of one page are contiguous: a slice is enough
+    if (m_fields.size() > first)
+    {
+        m_pageFirst[pageIndex] = first;
+        m_pageCount[pageIndex] = m_fields.size() - first;
+
+        qint64 added = 0;
+        for (int i = first; i < m_fields.size(); ++i)
+        {
+            const FormFieldEntry &entry = m_fields[i];
+            added += sizeof(FormFieldEntry) + 2 * (entry.name.size() + entry.text.size());
+            for (const QString &choice : entry.choices)
+                added += sizeof(QString) + 2 * choice.size();
+        }
+        m_account.setBytes(m_account.bytes() + added);
+    }
+}
+
+int FormFieldModel::firstFieldOfPage(int pageIndex) const
+{
+    if (pageIndex < 0 || pageIndex >= m_pageFirst.size())
+        return -1;
+
+    return qMax(-1, m_pageFirst[pageIndex]);
+}
+
+int FormFieldModel::fieldCountOfPage(int pageIndex) const
+{
+    if (pageIndex < 0 || pageIndex >= m_pageCount.size())
+        return 0;
+
+    return m_pageCount[pageIndex];
+}
+
+// Editing ----------------------------------------------------------
+
+void FormFieldModel::setText(int index, const QString &text)
+{
+    FormFieldEntry &entry = m_fields[index];
+    if (entry.readOnly || entry.text == text)
+        return;
+
+    entry.text = text;
+    writeBack(entry);
+}
+
+void FormFieldModel::setChecked(int index, bool checked)
+{
+    FormFieldEntry &entry = m_fields[index];
+    if (entry.readOnly || entry.checked == checked)
+        return;
+
+    entry.checked = checked;
+    writeBack(entry);
+}
+
+void FormFieldModel::setCurrentChoice(int index, int choice)
+{
+    FormFieldEntry &entry = m_fields[index];
+    if (entry.readOnly || entry.currentChoice == choice)
+        return;
+
+    entry.currentChoice = choice;
+    writeBack(entry);
+}
+
+// Write-back -------------------------------------------------------
+// Field values live in the Poppler document (shared by all its pages)
+
+void FormFieldModel::writeBack(const FormFieldEntry &entry)
+{
+    auto page = m_document ? m_document->getPage(entry.pageIndex) : nullptr;
+    if (!page)
+        return;
+
+    for (const std::unique_ptr<Poppler::FormField> &field : page->formFields())
+    {
+        if (field->id() != entry.fieldId)
+            continue;
+
+        switch (entry.kind)
+        {
+        case FormFieldEntry::Kind::Text:
+            static_cast<Poppler::FormFieldText *>(field.get())->setText(entry.text);
+            break;
+        case FormFieldEntry::Kind::CheckBox:
+            static_cast<Poppler::FormFieldButton *>(field.get())->setState(entry.checked);
+            break;
+        case FormFieldEntry::Kind::Choice:
+            static_cast<Poppler::FormFieldChoice *>(field.get())->setCurrentChoices(
+                entry.currentChoice >= 0 ? QList<int>{entry.currentChoice} : QList<int>());
+            break;
+        }
+        return;
+    }
+
+    qWarning() << "FormFieldModel: Field" << entry.name << "vanished from page" << entry.pageIndex;
+}
@@ -0,0 +1,84 @@
+#ifndef FORMFIELDMODEL_H
+#define FORMFIELDMODEL_H
+
+#include <QRectF>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "memoryaccounting.h"
+
+class PDFDocument;
+
+/**
+ * FormFieldEntry
+ * Plain value record for ONE interactive form field.
+ */
+struct FormFieldEntry
+{
+    enum class Kind
+    {
+        Text,     // Single or multi line text
+        CheckBox, // Check box or radio button
+        Choice    // Combo box / list box
+    };
+
+    int pageIndex = -1;
+    int fieldId = -1;  // Poppler::FormField::id(), used for write-back
+    Kind kind = Kind::Text;
+    QRectF rect;       // Normalized (0..1) page coordinates
+    QString name;
+    bool readOnly = false;
+
+    // Current value (only the member matching kind is meaningful)
+    QString text;
+    bool checked = false;
+    int currentChoice = -1;
+    QStringList choices;
+};
+
+/**
+ * FormFieldModel
+ * ---------------------------------------------------------------
+ * Flat, lazily filled store of every form field value in a document.
+ *
+ * Responsibilities:
+ *  - Load the fields of a page on first request (Poppler::Page::formFields()).
+ *  - Keep values in one contiguous vector; a page maps to a [first, count)
+ *    slice, so thousands of fields cost no QObject at all.
+ *  - Push edited values back into the Poppler document.
+ *
+ * Design notes:
+ *  - No Poppler::FormField objects are kept alive; write-back looks the
+ *    field up again by id, which only happens on user edits.
+ *  - Reports its footprint to MemoryAccounting as "form-fields".
+ */
+class FormFieldModel
+{
+public:
+    explicit FormFieldModel(PDFDocument *document); // Non-owning.
+
+    // Page slices ---------------------------------------------------
+    void ensurePageLoaded(int pageIndex);
+    int firstFieldOfPage(int pageIndex) const; // -1 if not loaded or no fields.
+    int fieldCountOfPage(int pageIndex) const;
+
+    // Field access --------------------------------------------------
+    int fieldCount() const { return m_fields.size(); }
+    const FormFieldEntry &field(int index) const { return m_fields[index]; }
+
+    // Editing (updates the model, then the Poppler document) --------
+    void setText(int index, const QString &text);
+    void setChecked(int index, bool checked);
+    void setCurrentChoice(int index, int choice);
+
+private:
+    void writeBack(const FormFieldEntry &entry);
+
+    PDFDocument *m_document;
+    QVector<FormFieldEntry> m_fields;
+    QVector<int> m_pageFirst; // -2: not loaded yet, -1: loaded, no fields
+    QVector<int> m_pageCount;
+    MemoryAccount m_account{"form-fields"};
+};
+
+#endif // FORMFIELDMODEL_H
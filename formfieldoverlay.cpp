@@ -0,0 +1,221 @@
+/**
+ * FormFieldOverlay implementation
+ * ---------------------------------------------------------------
+ * Walks only the pages crossing the viewport, places pooled editors on the
+ * fields they contain and returns the rest to the pools.
+ */
+
+#include "formfieldoverlay.h"
+#include "pagemanager.h"
+#include "pdfpage.h"
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QSet>
+
+namespace
+{
+    // Light tint so fields are recognizable without hiding the page
+    const char *EDITOR_STYLE = "background: rgba(204, 215, 255, 170); border: 1px solid rgba(90, 110, 200, 200);";
+}
+
+// Construction -----------------------------------------------------
+
+FormFieldOverlay::FormFieldOverlay(PDFDocument *document, PageManager *pageManager, QObject *parent)
+    : QObject(parent), m_model(document), m_pageManager(pageManager)
+{
+}
+
+// Viewport Synchronization ----------------------------------------
+
+void FormFieldOverlay::updateVisible(const QRect &visibleContentRect)
+{
+    if (!m_pageManager || !m_pageManager->contentWidget())
+        return;
+
+    QSet<int> visibleFields;
+    const int pageCount = m_pageManager->pageCount();
+
+    for (int p = firstPageIntersecting(visibleContentRect.top()); p < pageCount; ++p)
+    {
+        PDFPage *page = m_pageManager->pageAt(p);
+        if (!page)
+            continue;
+
+        const QRect pageGeometry = page->geometry();
+        if (pageGeometry.top() > visibleContentRect.bottom())
+            break; // Pages below the viewport
+
+        if (!page->isRendered())
+            continue;
+
+        m_model.ensurePageLoaded(p);
+        const int first = m_model.firstFieldOfPage(p);
+        if (first < 0)
+            continue;
+
+        const int end = first + m_model.fieldCountOfPage(p);
+        for (int i = first; i < end; ++i)
+        {
+            const QRect rect = fieldRectInContent(m_model.field(i), pageGeometry);
+            if (!rect.intersects(visibleContentRect))
+                continue;
+
+            visibleFields.insert(i);
+
+            QWidget *editor = m_activeEditors.value(i);
+            if (!editor)
+            {
+                editor = acquireEditor(i);
+                m_activeEditors.insert(i, editor);
+            }
+            editor->setGeometry(rect);
+            editor->show();
+            editor->raise();
+        }
+    }
+
+    // Fields that left the viewport give their editors back
+    for (auto it = m_activeEditors.begin(); it != m_activeEditors.end();)
+    {
+        if (visibleFields.contains(it.key()))
+        {
+            ++it;
+            continue;
+        }
+        releaseEditor(it.key(), it.value());
+        it = m_activeEditors.erase(it);
+    }
+}
+
+// Editor Pooling ---------------------------------------------------
+
+QWidget *FormFieldOverlay::acquireEditor(int fieldIndex)
+{
+    const FormFieldEntry &entry = m_model.field(fieldIndex);
+    QWidget *parent = m_pageManager->contentWidget();
+    QWidget *editor = nullptr;
+
+    switch (entry.kind)
+    {
+    case FormFieldEntry::Kind::Text:
+    {
+        QLineEdit *lineEdit = nullptr;
+        while (!lineEdit && !m_freeLineEdits.isEmpty())
+            lineEdit = m_freeLineEdits.takeLast();
+        if (!lineEdit)
+            lineEdit = new QLineEdit(parent);
+        lineEdit->setText(entry.text);
+        lineEdit->setReadOnly(entry.readOnly);
+        editor = lineEdit;
+        break;
+    }
+
+    case FormFieldEntry::Kind::CheckBox:
+    {
+        QCheckBox *checkBox = nullptr;
+        while (!checkBox && !m_freeCheckBoxes.isEmpty())
+            checkBox = m_freeCheckBoxes.takeLast();
+        if (!checkBox)
+            checkBox = new QCheckBox(parent);
+        checkBox->setChecked(entry.checked);
+        checkBox->setEnabled(!entry.readOnly);
+        editor = checkBox;
+        break;
+    }
+
+    case FormFieldEntry::Kind::Choice:
+    {
+        QComboBox *comboBox = nullptr;
+        while (!comboBox && !m_freeComboBoxes.isEmpty())
+            comboBox = m_freeComboBoxes.takeLast();
+        if (!comboBox)
+            comboBox = new QComboBox(parent);
+        comboBox->clear();
+        comboBox->addItems(entry.choices);
+        comboBox->setCurrentIndex(entry.currentChoice);
+        comboBox->setEnabled(!entry.readOnly);
+        editor = comboBox;
+        break;
+    }
+    }
+
+    editor->setStyleSheet(EDITOR_STYLE);
+    editor->setToolTip(entry.name);
+
+    // Connect only after the value is set: no spurious write-back
+    bindEditor(editor, fieldIndex);
+    return editor;
+}
+
+void FormFieldOverlay::releaseEditor(int fieldIndex, QWidget *editor)
+{
+    if (!editor)
+        return; // Already destroyed with the content widget
+
+    // A line edit may still hold an uncommitted value
+    if (QLineEdit *lineEdit = qobject_cast<QLineEdit *>(editor))
+    {
+        m_model.setText(fieldIndex, lineEdit->text());
+    }
+
+    disconnect(editor, nullptr, this, nullptr);
+    editor->hide();
+
+    if (QLineEdit *lineEdit = qobject_cast<QLineEdit *>(editor); lineEdit && m_freeLineEdits.size() < MAX_POOLED_PER_KIND)
+        m_freeLineEdits.append(lineEdit);
+    else if (QCheckBox *checkBox = qobject_cast<QCheckBox *>(editor); checkBox && m_freeCheckBoxes.size() < MAX_POOLED_PER_KIND)
+        m_freeCheckBoxes.append(checkBox);
+    else if (QComboBox *comboBox = qobject_cast<QComboBox *>(editor); comboBox && m_freeComboBoxes.size() < MAX_POOLED_PER_KIND)
+        m_freeComboBoxes.append(comboBox);
+    else
+        editor->deleteLater(); // Pool full
+}
+
+void FormFieldOverlay::bindEditor(QWidget *editor, int fieldIndex)
+{
+    if (QLineEdit *lineEdit = qobject_cast<QLineEdit *>(editor))
+    {
+        connect(lineEdit, &QLineEdit::editingFinished, this, [this, lineEdit, fieldIndex]()
+                { m_model.setText(fieldIndex, lineEdit->text()); });
+    }
+    else if (QCheckBox *checkBox = qobject_cast<QCheckBox *>(editor))
+    {
+        connect(checkBox, &QCheckBox::toggled, this, [this, fieldIndex](bool checked)
+                { m_model.setChecked(fieldIndex, checked); });
+    }
+    else if (QComboBox *comboBox = qobject_cast<QComboBox *>(editor))
+    {
+        connect(comboBox, &QComboBox::currentIndexChanged, this, [this, fieldIndex](int choice)
+                { m_model.setCurrentChoice(fieldIndex, choice); });
+    }
+}
+
+// Geometry Helpers -------------------------------------------------
+
+QRect FormFieldOverlay::fieldRectInContent(const FormFieldEntry &entry, const QRect &pageGeometry) const
+{
+    // Poppler field rects are normalized to the page box
+    return QRectF(pageGeometry.x() + entry.rect.x() * pageGeometry.width(),
+                  pageGeometry.y() + entry.rect.y() * pageGeometry.height(),
+                  entry.rect.width() * pageGeometry.width(),
+                  entry.rect.height() * pageGeometry.height())
+        .toAlignedRect();
+}
+
+int FormFieldOverlay::firstPageIntersecting(int top) const
+{
+    // Pages are stacked vertically, so their bottoms are sorted
+    int low = 0;
+    int high = m_pageManager->pageCount();
+    while (low < high)
+    {
+        const int mid = (low + high) / 2;
+        PDFPage *page = m_pageManager->pageAt(mid);
+        if (page && page->geometry().bottom() < top)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
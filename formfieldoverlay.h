@@ -0,0 +1,63 @@
+#ifndef FORMFIELDOVERLAY_H
+#define FORMFIELDOVERLAY_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QRect>
+#include <QVector>
+#include "formfieldmodel.h"
+
+class PageManager;
+class QWidget;
+class QLineEdit;
+class QCheckBox;
+class QComboBox;
+
+/**
+ * FormFieldOverlay
+ * --------------------------------------------------------
+ * Editable widgets on top of interactive form fields, viewport-virtualized.
+ *
+ * Responsibilities:
+ * - Materialize editors only for fields intersecting the viewport
+ * - Recycle editors through per-kind pools when fields scroll out
+ * - Route edits into the flat FormFieldModel
+ *
+ * Design notes:
+ * - Editors are children of the page content widget and die with it;
+ *   the overlay must be dropped before (or with) that widget.
+ * - Only rendered pages get editors: placeholders have no final geometry.
+ */
+class FormFieldOverlay : public QObject
+{
+    Q_OBJECT
+
+public:
+    FormFieldOverlay(PDFDocument *document, PageManager *pageManager, QObject *parent = nullptr);
+
+    // Viewport Synchronization --------------------------------------
+    void updateVisible(const QRect &visibleContentRect); // Content widget coordinates.
+
+    const FormFieldModel &model() const { return m_model; }
+
+private:
+    QWidget *acquireEditor(int fieldIndex);
+    void releaseEditor(int fieldIndex, QWidget *editor);
+    void bindEditor(QWidget *editor, int fieldIndex);
+
+    QRect fieldRectInContent(const FormFieldEntry &entry, const QRect &pageGeometry) const;
+    int firstPageIntersecting(int top) const; // Binary search over page geometries.
+
+    FormFieldModel m_model;
+    PageManager *m_pageManager; // Non-owning
+
+    QHash<int, QPointer<QWidget>> m_activeEditors; // fieldIndex -> editor
+    QVector<QPointer<QLineEdit>> m_freeLineEdits;
+    QVector<QPointer<QCheckBox>> m_freeCheckBoxes;
+    QVector<QPointer<QComboBox>> m_freeComboBoxes;
+
+    static constexpr int MAX_POOLED_PER_KIND = 64;
+};
+
+#endif // FORMFIELDOVERLAY_H
@@ -0,0 +1,93 @@
+/**
+ * FuzzyMatcher implementation
+ * ---------------------------------------------------------------
+ * Myers, "A fast bit-vector algorithm for approximate string matching
+ * based on dynamic programming" (J. ACM 46(3), 1999), search variant:
+ * row 0 of the matrix is all zeros, so a match may start anywhere.
+ */
+
+#include "fuzzymatcher.h"
+
+FuzzyMatcher::FuzzyMatcher(const QString &pattern, int maxErrors)
+{
+    if (pattern.isEmpty() || pattern.size() > MAX_PATTERN_LENGTH)
+    {
+        return;
+    }
+
+    m_length = int(pattern.size());
+    m_maxErrors = qBound(0, maxErrors, (m_length - 1) / 2);
+
+    for (int i = 0; i < m_length; ++i)
+    {
+        const QChar c = pattern.at(i);
+        const quint64 bit = quint64(1) << i;
+        addCharacter(c.unicode(), bit);
+        addCharacter(c.toLower().unicode(), bit);
+        addCharacter(c.toUpper().unicode(), bit);
+        addCharacter(c.toCaseFolded().unicode(), bit);
+    }
+}
+
+void FuzzyMatcher::addCharacter(char16_t c, quint64 bit)
+{
+    if (c < 256)
+        m_latin1[c] |= bit;
+    else
+        m_other[c] |= bit;
+}
+
+QVector<FuzzyMatcher::Match> FuzzyMatcher::find(const QString &text) const
+{
+    QVector<Match> matches;
+    if (!isValid())
+    {
+        return matches;
+    }
+
+    // Vertical deltas of the current column: +1 (Pv) / -1 (Mv); the
+    // column starts as 0, 1, 2 ... m (pattern against empty text)
+    quint64 pv = ~quint64(0);
+    quint64 mv = 0;
+    int score = m_length; // Bottom cell: best distance of a match ending here
+    const quint64 last = quint64(1) << (m_length - 1);
+
+    // Bits above the pattern only receive carries, never feed back down
+    Match pending;
+    const char16_t *data = reinterpret_cast<const char16_t *>(text.constData());
+    const qsizetype size = text.size();
+    for (qsizetype j = 0; j < size; ++j)
+    {
+        const quint64 eq = equalityMask(data[j]);
+        const quint64 xv = eq | mv;
+        const quint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+        quint64 ph = mv | ~(xh | pv);
+        quint64 mh = pv & xh;
+
+        if (ph & last)
+            ++score;
+        else if (mh & last)
+            --score;
+
+        // Search: the top row stays 0, so no carry-in on ph
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        if (score <= m_maxErrors)
+        {
+            if (pending.end < 0 || score < pending.errors)
+                pending = Match{j, score};
+        }
+        else if (pending.end >= 0)
+        {
+            matches.append(pending);
+            pending = Match();
+        }
+    }
+
+    if (pending.end >= 0)
+        matches.append(pending);
+    return matches;
+}
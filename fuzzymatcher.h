@@ -0,0 +1,59 @@
+#ifndef FUZZYMATCHER_H
+#define FUZZYMATCHER_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <array>
+
+/**
+ * FuzzyMatcher
+ * ---------------------------------------------------------------
+ * Approximate substring search: every place where the pattern occurs
+ * with at most k edits (insertions, deletions, substitutions), e.g.
+ * "contract" found as "c0ntract" or "contr act" in OCR text.
+ *
+ * Responsibilities:
+ *  - Precompute one equality bit mask per pattern character (both cases,
+ *    so the text is never case-folded or copied).
+ *  - Scan text with Myers' bit-parallel algorithm: the whole column of
+ *    the edit-distance matrix advances one text character per handful of
+ *    64-bit operations, i.e. O(n) for patterns up to 64 characters.
+ *
+ * Design notes:
+ *  - Case-insensitive, UTF-16 code units (like QString::indexOf).
+ *  - Consecutive end positions within the threshold are one occurrence,
+ *    reported at its best end (fewest errors).
+ *  - k is capped below half the pattern length: beyond that almost any
+ *    text matches and results are noise.
+ */
+class FuzzyMatcher
+{
+public:
+    struct Match
+    {
+        qsizetype end = -1; // Index of the last matched character.
+        int errors = 0;
+    };
+
+    FuzzyMatcher(const QString &pattern, int maxErrors);
+
+    bool isValid() const { return m_length > 0; } // False for empty or too long patterns.
+    int patternLength() const { return m_length; }
+    int maxErrors() const { return m_maxErrors; }
+
+    QVector<Match> find(const QString &text) const;
+
+    static constexpr int MAX_PATTERN_LENGTH = 64; // One machine word per column.
+
+private:
+    quint64 equalityMask(char16_t c) const { return c < 256 ? m_latin1[c] : m_other.value(c, 0); }
+    void addCharacter(char16_t c, quint64 bit);
+
+    std::array<quint64, 256> m_latin1{}; // Fast path: most PDF text is Latin-1.
+    QHash<char16_t, quint64> m_other;
+    int m_length = 0;
+    int m_maxErrors = 0;
+};
+
+#endif // FUZZYMATCHER_H
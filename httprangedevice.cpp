@@ -0,0 +1,458 @@
+/**
+ * HttpRangeDevice implementation
+ * ---------------------------------------------------------------
+ * Block bookkeeping is all in BLOCK_SIZE units; requests are always
+ * block-aligned, only the last block of the file may be short.
+ */
+
+#include "httprangedevice.h"
+#include <QByteArrayList>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDeadlineTimer>
+#include <QDebug>
+#include <QDir>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// RangeFetcher =====================================================
+
+RangeFetcher::RangeFetcher(const QUrl &url, HttpRangeDevice *device) : m_url(url), m_device(device)
+{
+}
+
+QNetworkAccessManager *RangeFetcher::network()
+{
+    if (!m_network)
+    {
+        m_network = new QNetworkAccessManager(this);
+    }
+    return m_network;
+}
+
+void RangeFetcher::fetch(qint64 offset, qint64 length)
+{
+    QNetworkRequest request(m_url);
+    request.setRawHeader("Range", "bytes=" + QByteArray::number(offset) + '-' + QByteArray::number(offset + length - 1));
+    request.setTransferTimeout(HttpRangeDevice::TIMEOUT_MS);
+
+    QNetworkReply *reply = network()->get(request);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, offset, length]()
+            {
+        reply->deleteLater();
+
+        if (reply->error() != QNetworkReply::NoError)
+        {
+            m_device->failRange(offset, length, reply->errorString());
+            return;
+        }
+
+        // 200 would mean the whole file is coming: exactly what we must avoid
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status != 206)
+        {
+            m_device->failRange(offset, length, tr("Server does not support range requests (HTTP %1)").arg(status));
+            return;
+        }
+
+        // Content-Range: bytes <first>-<last>/<total>
+        const QByteArray contentRange = reply->rawHeader("Content-Range");
+        const int space = contentRange.indexOf(' ');
+        const int dash = contentRange.indexOf('-');
+        const int slash = contentRange.indexOf('/');
+        bool startOk = false;
+        bool totalOk = false;
+        const qint64 start = contentRange.mid(space + 1, dash - space - 1).toLongLong(&startOk);
+        const qint64 total = contentRange.mid(slash + 1).toLongLong(&totalOk);
+        if (space < 0 || dash < 0 || slash < 0 || !startOk || !totalOk || start != offset)
+        {
+            m_device->failRange(offset, length, tr("Unexpected Content-Range \"%1\"").arg(QString::fromLatin1(contentRange)));
+            return;
+        }
+
+        // Size plus whichever of ETag and Last-Modified the server sends (no empty fields)
+        QByteArrayList fields{QByteArray::number(total)};
+        for (const QByteArray &header : {reply->rawHeader("ETag"), reply->rawHeader("Last-Modified")})
+        {
+            if (!header.isEmpty())
+                fields.append(header);
+        }
+        const QByteArray validator = fields.join(' ');
+        m_device->storeRange(offset, length, reply->readAll(), total, validator); });
+}
+
+// HttpRangeDevice ==================================================
+
+// Construction -----------------------------------------------------
+HttpRangeDevice::HttpRangeDevice(const QUrl &url, const QString &cacheDirectory, QObject *parent)
+    : QIODevice(parent), m_url(url), m_cacheDirectory(cacheDirectory), m_fetcher(new RangeFetcher(url, this))
+{
+    if (m_cacheDirectory.isEmpty())
+    {
+        m_cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/ranges";
+    }
+
+    // The fetcher (and its QNetworkAccessManager) lives and dies in the worker
+    m_fetcher->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_fetcher, &QObject::deleteLater);
+}
+
+HttpRangeDevice::~HttpRangeDevice()
+{
+    // Stop the worker first: it writes into members destroyed below
+    if (m_thread.isRunning())
+    {
+        m_thread.quit();
+        m_thread.wait(); // finished() -> deleteLater() disposes of the fetcher
+    }
+    else
+    {
+        delete m_fetcher;
+    }
+    close();
+}
+
+// QIODevice --------------------------------------------------------
+bool HttpRangeDevice::open(OpenMode mode)
+{
+    if (mode & WriteOnly)
+    {
+        setErrorString(tr("Remote documents are read-only"));
+        return false;
+    }
+
+    if (!m_thread.isRunning())
+    {
+        m_thread.start();
+    }
+
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_length == 0)
+        {
+            // The first block tells the size and validator (and holds the header)
+            m_fatalError.clear();
+            QMetaObject::invokeMethod(m_fetcher, [this]()
+                                      { m_fetcher->fetch(0, BLOCK_SIZE); }, Qt::QueuedConnection);
+
+            QDeadlineTimer deadline(TIMEOUT_MS);
+            while (m_length == 0 && m_fatalError.isEmpty())
+            {
+                if (!m_arrived.wait(&m_mutex, deadline))
+                {
+                    m_fatalError = tr("Timed out connecting to %1").arg(m_url.toString());
+                }
+            }
+        }
+        else if (!m_cacheFile.isOpen())
+        {
+            openCache(m_validator); // Reopened after close()
+        }
+
+        if (m_length == 0 || !m_cacheFile.isOpen())
+        {
+            setErrorString(m_fatalError.isEmpty() ? tr("Cannot open the range cache") : m_fatalError);
+            return false;
+        }
+
+        // Trailer and cross-reference data sit at the end: Poppler reads them first
+        const qint64 lastBlock = (m_length - 1) / BLOCK_SIZE;
+        requestMissing(qMax<qint64>(0, lastBlock - 1), lastBlock);
+    }
+
+    // Unbuffered: pos() in readData() is then the real device position
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void HttpRangeDevice::close()
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_cacheFile.isOpen())
+        {
+            saveMap();
+            m_cacheFile.close();
+        }
+    }
+    QIODevice::close();
+}
+
+qint64 HttpRangeDevice::readData(char *data, qint64 maxSize)
+{
+    const qint64 offset = pos();
+    const qint64 length = qMin(maxSize, m_length - offset);
+    if (length <= 0)
+    {
+        return 0;
+    }
+
+    if (!ensureRange(offset, length))
+    {
+        return -1;
+    }
+
+    QMutexLocker lock(&m_mutex);
+    if (!m_cacheFile.seek(offset))
+    {
+        return -1;
+    }
+    return m_cacheFile.read(data, length);
+}
+
+qint64 HttpRangeDevice::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+// Remote File ------------------------------------------------------
+QByteArray HttpRangeDevice::identity() const
+{
+    QMutexLocker lock(&m_mutex);
+    return QCryptographicHash::hash(m_url.toEncoded() + '\n' + m_validator, QCryptographicHash::Sha1);
+}
+
+qint64 HttpRangeDevice::fetchedBytes() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_fetchedBytes;
+}
+
+void HttpRangeDevice::prefetch(qint64 offset, qint64 length)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_length == 0 || length <= 0)
+    {
+        return;
+    }
+
+    const qint64 first = qBound<qint64>(0, offset, m_length - 1) / BLOCK_SIZE;
+    const qint64 last = qBound<qint64>(0, offset + length - 1, m_length - 1) / BLOCK_SIZE;
+    requestMissing(first, last);
+}
+
+// Fetching ---------------------------------------------------------
+bool HttpRangeDevice::ensureRange(qint64 offset, qint64 length)
+{
+    const qint64 firstBlock = offset / BLOCK_SIZE;
+    const qint64 lastBlock = (offset + length - 1) / BLOCK_SIZE;
+    QDeadlineTimer deadline(TIMEOUT_MS);
+
+    QMutexLocker lock(&m_mutex);
+    const qint64 blockCount = m_present.size();
+
+    // An earlier failure on these blocks (often a readahead) is retried, not reported
+    for (qint64 block = firstBlock; block <= lastBlock; ++block)
+    {
+        m_blockErrors.remove(block);
+    }
+
+    for (;;)
+    {
+        qint64 missing = -1;
+        for (qint64 block = firstBlock; block <= lastBlock; ++block)
+        {
+            if (!m_present.testBit(block))
+            {
+                missing = block;
+                break;
+            }
+        }
+        if (missing < 0)
+        {
+            return true;
+        }
+        if (!m_fatalError.isEmpty())
+        {
+            setErrorString(m_fatalError);
+            return false;
+        }
+        for (qint64 block = missing; block <= lastBlock; ++block)
+        {
+            const auto error = m_blockErrors.constFind(block);
+            if (error != m_blockErrors.constEnd())
+            {
+                setErrorString(*error); // Only this read fails; the next one asks again
+                return false;
+            }
+        }
+
+        // What we wait for first, then (as separate requests) what likely follows
+        requestMissing(missing, lastBlock);
+        requestMissing(lastBlock + 1, qMin(blockCount - 1, lastBlock + READAHEAD_BLOCKS));
+
+        if (!m_arrived.wait(&m_mutex, deadline))
+        {
+            setErrorString(tr("Timed out reading %1").arg(m_url.toString()));
+            return false;
+        }
+    }
+}
+
+void HttpRangeDevice::requestMissing(qint64 firstBlock, qint64 lastBlock)
+{
+    qint64 block = firstBlock;
+    while (block <= lastBlock)
+    {
+        if (m_present.testBit(block) || m_requested.testBit(block))
+        {
+            ++block;
+            continue;
+        }
+
+        // One request per contiguous run of missing blocks
+        const qint64 runStart = block;
+        while (block <= lastBlock && block - runStart < MAX_REQUEST_BLOCKS &&
+               !m_present.testBit(block) && !m_requested.testBit(block))
+        {
+            m_requested.setBit(block);
+            ++block;
+        }
+
+        const qint64 offset = runStart * BLOCK_SIZE;
+        const qint64 length = qMin(block * BLOCK_SIZE, m_length) - offset;
+        QMetaObject::invokeMethod(m_fetcher, [this, offset, length]()
+                                  { m_fetcher->fetch(offset, length); }, Qt::QueuedConnection);
+    }
+}
+
+void HttpRangeDevice::storeRange(qint64 offset, qint64 length, const QByteArray &data, qint64 totalLength,
+                                 const QByteArray &validator)
+{
+    QMutexLocker lock(&m_mutex);
+
+    if (m_length == 0)
+    {
+        m_length = totalLength;
+        m_validator = validator;
+        if (!openCache(validator))
+        {
+            m_fatalError = tr("Cannot create the range cache in %1").arg(m_cacheDirectory);
+            m_length = 0;
+            m_arrived.wakeAll();
+            return;
+        }
+    }
+    else if (validator != m_validator)
+    {
+        m_fatalError = tr("%1 changed on the server while being read").arg(m_url.toString());
+        m_arrived.wakeAll();
+        return;
+    }
+
+    if (m_cacheFile.seek(offset) && m_cacheFile.write(data) == data.size())
+    {
+        const qint64 end = offset + data.size();
+        for (qint64 block = offset / BLOCK_SIZE; block * BLOCK_SIZE < end && block < m_present.size(); ++block)
+        {
+            if (qMin((block + 1) * BLOCK_SIZE, m_length) <= end)
+            {
+                m_present.setBit(block);
+                m_blockErrors.remove(block);
+            }
+        }
+        m_fetchedBytes += data.size();
+    }
+    else
+    {
+        m_fatalError = tr("Cannot write the range cache: %1").arg(m_cacheFile.errorString());
+    }
+
+    // Whatever did not arrive (short reply) may be asked for again
+    for (qint64 block = offset / BLOCK_SIZE; block * BLOCK_SIZE < offset + length && block < m_requested.size(); ++block)
+    {
+        m_requested.clearBit(block);
+    }
+    m_arrived.wakeAll();
+}
+
+void HttpRangeDevice::failRange(qint64 offset, qint64 length, const QString &error)
+{
+    QMutexLocker lock(&m_mutex);
+    for (qint64 block = offset / BLOCK_SIZE; block * BLOCK_SIZE < offset + length && block < m_requested.size(); ++block)
+    {
+        m_requested.clearBit(block);
+    }
+
+    qWarning() << "HttpRangeDevice:" << m_url.toString() << "bytes" << offset << "+" << length << "-" << error;
+    if (m_length == 0)
+    {
+        m_fatalError = error; // The opening request: nothing else to go on
+    }
+    else
+    {
+        for (qint64 block = offset / BLOCK_SIZE; block * BLOCK_SIZE < offset + length && block < m_present.size(); ++block)
+        {
+            m_blockErrors.insert(block, error);
+        }
+    }
+    m_arrived.wakeAll();
+}
+
+// Sparse Cache -----------------------------------------------------
+bool HttpRangeDevice::openCache(const QByteArray &validator)
+{
+    if (!QDir().mkpath(m_cacheDirectory))
+    {
+        return false;
+    }
+
+    const qint64 blocks = (m_length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    m_present = QBitArray(blocks);
+    m_requested = QBitArray(blocks);
+    m_blockErrors.clear();
+
+    // Blocks from an earlier session are reusable only for the same revision
+    bool reuse = false;
+    QFile map(cachePath(".map"));
+    QByteArray line;
+    if (map.open(QIODevice::ReadOnly))
+        line = map.readLine();
+    if (line.endsWith('\n'))
+        line.chop(1); // Only the separator written by saveMap(): the validator is compared verbatim
+    if (!line.isEmpty() && line == validator)
+    {
+        QDataStream in(&map);
+        QBitArray present;
+        in >> present;
+        if (in.status() == QDataStream::Ok && present.size() == blocks)
+        {
+            m_present = present;
+            reuse = true;
+        }
+    }
+
+    m_cacheFile.setFileName(cachePath(".data"));
+    const OpenMode cacheMode = reuse ? QIODevice::ReadWrite : QIODevice::ReadWrite | QIODevice::Truncate;
+    if (!m_cacheFile.open(cacheMode))
+    {
+        return false;
+    }
+
+    // Full length up front; unwritten regions stay holes on most filesystems
+    return m_cacheFile.resize(m_length);
+}
+
+void HttpRangeDevice::saveMap()
+{
+    QSaveFile map(cachePath(".map"));
+    if (!map.open(QIODevice::WriteOnly))
+    {
+        return;
+    }
+
+    map.write(m_validator + '\n');
+    QDataStream out(&map);
+    out << m_present;
+    map.commit();
+}
+
+QString HttpRangeDevice::cachePath(const QString &suffix) const
+{
+    const QByteArray key = QCryptographicHash::hash(m_url.toEncoded(), QCryptographicHash::Sha1).toHex();
+    return m_cacheDirectory + '/' + QString::fromLatin1(key) + suffix;
+}
@@ -0,0 +1,129 @@
+#ifndef HTTPRANGEDEVICE_H
+#define HTTPRANGEDEVICE_H
+
+#include <QIODevice>
+#include <QBitArray>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QUrl>
+#include <QWaitCondition>
+
+class QNetworkAccessManager;
+class HttpRangeDevice;
+
+/**
+ * RangeFetcher
+ * Worker-thread half of HttpRangeDevice: owns the QNetworkAccessManager
+ * and issues one "Range: bytes=a-b" GET per request. Internal.
+ */
+class RangeFetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RangeFetcher(const QUrl &url, HttpRangeDevice *device);
+
+public slots:
+    void fetch(qint64 offset, qint64 length);
+
+private:
+    QNetworkAccessManager *network(); // Created in the worker thread on first use.
+
+    QUrl m_url;
+    HttpRangeDevice *m_device;
+    QNetworkAccessManager *m_network = nullptr;
+};
+
+/**
+ * HttpRangeDevice
+ * ---------------------------------------------------------------
+ * Random-access QIODevice over a remote PDF, fetched on demand with HTTP
+ * Range requests and kept in a sparse on-disk cache.
+ *
+ * Responsibilities:
+ *  - Learn the file size (Content-Range) and validator (ETag/Last-Modified)
+ *    from the first block when opened.
+ *  - Serve readData() from the cache file, fetching missing BLOCK_SIZE
+ *    blocks (contiguous runs in one request) and blocking until they land.
+ *  - Read ahead after every miss, so the objects that follow (usually the
+ *    next pages) arrive before Poppler asks for them; prefetch() lets the
+ *    viewer ask for what it is about to show.
+ *  - Persist which blocks are present, so a second session starts warm.
+ *
+ * Design notes:
+ *  - Poppler reads synchronously on the GUI thread; the network lives on
+ *    a private QThread so waiting never spins a nested event loop.
+ *  - Cache: <cache>/ranges/<sha1(url)>.data (sparse, full length) plus a
+ *    .map with the validator and block bitmap; a changed validator resets it.
+ *  - Works against any server honouring Range (nginx, Apache, `npx
+ *    http-server`...); a server answering 200 instead of 206 is refused.
+ *  - A failed request only fails the reads that need its blocks; a later
+ *    read of those blocks asks again. Only a broken cache or a file that
+ *    changed on the server fails everything.
+ *  - Never throws: failures surface as open() == false / read() == -1 with
+ *    errorString().
+ */
+class HttpRangeDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit HttpRangeDevice(const QUrl &url, const QString &cacheDirectory = QString(), QObject *parent = nullptr);
+    ~HttpRangeDevice() override;
+
+    // QIODevice -----------------------------------------------------
+    bool open(OpenMode mode) override; // Blocking: fetches the first block.
+    void close() override;
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return m_length; }
+
+    // Remote file ---------------------------------------------------
+    QUrl url() const { return m_url; }
+    QByteArray identity() const;   // URL + validator: stable cache key for this revision.
+    qint64 fetchedBytes() const;   // Bytes downloaded this session.
+    void prefetch(qint64 offset, qint64 length); // Asynchronous; missing blocks only.
+
+    static constexpr qint64 BLOCK_SIZE = 64 * 1024;
+    static constexpr int READAHEAD_BLOCKS = 4;
+    static constexpr int MAX_REQUEST_BLOCKS = 32;
+    static constexpr int TIMEOUT_MS = 30000;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    friend class RangeFetcher;
+
+    // Called by RangeFetcher on the worker thread
+    void storeRange(qint64 offset, qint64 length, const QByteArray &data, qint64 totalLength, const QByteArray &validator);
+    void failRange(qint64 offset, qint64 length, const QString &error);
+
+    bool ensureRange(qint64 offset, qint64 length);  // Blocks until present; GUI thread.
+    void requestMissing(qint64 firstBlock, qint64 lastBlock); // m_mutex held.
+    bool openCache(const QByteArray &validator);     // m_mutex held.
+    void saveMap();                                  // m_mutex held.
+    QString cachePath(const QString &suffix) const;
+
+    QUrl m_url;
+    QString m_cacheDirectory;
+    qint64 m_length = 0;
+    QByteArray m_validator;
+
+    QThread m_thread;
+    RangeFetcher *m_fetcher;
+
+    // Shared with the worker thread (guarded by m_mutex)
+    mutable QMutex m_mutex;
+    QWaitCondition m_arrived;
+    QFile m_cacheFile;
+    QBitArray m_present;   // Block is in the cache file
+    QBitArray m_requested; // Block is on its way
+    QHash<qint64, QString> m_blockErrors; // Block -> why its last request failed
+    QString m_fatalError;  // Open failed, cache unusable or file changed: every read fails
+    qint64 m_fetchedBytes = 0;
+};
+
+#endif // HTTPRANGEDEVICE_H
@@ -0,0 +1,138 @@
+/**
+ * ImageScaler implementation
+ * ---------------------------------------------------------------
+ * Premultiplied ARGB in, premultiplied ARGB out: averaging premultiplied
+ * values is what makes the box filter correct around transparent edges.
+ */
+
+#include "imagescaler.h"
+#include <QVector>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IMAGESCALER_SSE2 1
+#endif
+
+namespace
+{
+    // Source span and normalized weights of ONE output pixel along one axis
+    struct Contribution
+    {
+        int first = 0;
+        QVector<float> weights;
+    };
+
+    // Output pixel i covers [i * scale, (i + 1) * scale) in source pixels;
+    // each source pixel contributes the length of its overlap.
+    QVector<Contribution> contributions(int sourceLength, int targetLength)
+    {
+        QVector<Contribution> result(targetLength);
+        const double scale = double(sourceLength) / targetLength;
+
+        for (int i = 0; i < targetLength; ++i)
+        {
+            const double start = i * scale;
+            const double end = qMin(double(sourceLength), (i + 1) * scale);
+            Contribution &c = result[i];
+            c.first = int(std::floor(start));
+
+            for (int j = c.first; j < end; ++j)
+            {
+                const double overlap = qMin(end, j + 1.0) - qMax(start, double(j));
+                if (overlap > 0.0)
+                    c.weights.append(float(overlap / scale));
+            }
+        }
+        return result;
+    }
+
+    // row += weight * source, for `pixels` ARGB pixels (4 floats each)
+    void accumulateRow(float *row, const uchar *source, int pixels, float weight)
+    {
+        int x = 0;
+#ifdef IMAGESCALER_SSE2
+        const __m128 w = _mm_set1_ps(weight);
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 4 <= pixels; x += 4)
+        {
+            // 16 bytes = 4 pixels -> 4 vectors of 4 float channels
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + x * 4));
+            const __m128i lo16 = _mm_unpacklo_epi8(bytes, zero);
+            const __m128i hi16 = _mm_unpackhi_epi8(bytes, zero);
+
+            float *out = row + x * 4;
+            _mm_storeu_ps(out + 0, _mm_add_ps(_mm_loadu_ps(out + 0), _mm_mul_ps(w, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo16, zero)))));
+            _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(w, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo16, zero)))));
+            _mm_storeu_ps(out + 8, _mm_add_ps(_mm_loadu_ps(out + 8), _mm_mul_ps(w, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi16, zero)))));
+            _mm_storeu_ps(out + 12, _mm_add_ps(_mm_loadu_ps(out + 12), _mm_mul_ps(w, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi16, zero)))));
+        }
+#endif
+        for (int i = x * 4; i < pixels * 4; ++i)
+            row[i] += weight * source[i];
+    }
+
+    // Horizontal pass over the float row, writing one output scanline
+    void resampleRow(const float *row, const QVector<Contribution> &columns, uchar *target)
+    {
+        for (int ox = 0; ox < columns.size(); ++ox)
+        {
+            const Contribution &c = columns[ox];
+            const float *pixel = row + c.first * 4;
+#ifdef IMAGESCALER_SSE2
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < c.weights.size(); ++k)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(c.weights[k]), _mm_loadu_ps(pixel + k * 4)));
+
+            // Round, saturate to 0..255 and pack the 4 channels back to bytes
+            const __m128i ints = _mm_cvtps_epi32(sum);
+            const __m128i words = _mm_packs_epi32(ints, ints);
+            const __m128i bytes = _mm_packus_epi16(words, words);
+            const int packed = _mm_cvtsi128_si32(bytes);
+            memcpy(target + ox * 4, &packed, 4);
+#else
+            float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (int k = 0; k < c.weights.size(); ++k)
+                for (int ch = 0; ch < 4; ++ch)
+                    sum[ch] += c.weights[k] * pixel[k * 4 + ch];
+            for (int ch = 0; ch < 4; ++ch)
+                target[ox * 4 + ch] = uchar(qBound(0, int(std::lround(sum[ch])), 255));
+#endif
+        }
+    }
+}
+
+QImage ImageScaler::areaDownscale(const QImage &source, const QSize &targetSize)
+{
+    if (source.isNull() || targetSize.isEmpty())
+        return QImage();
+
+    const QImage input = source.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    if (targetSize.width() > input.width() || targetSize.height() > input.height())
+        return input.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    if (targetSize == input.size())
+        return input;
+
+    QImage output(targetSize, QImage::Format_ARGB32_Premultiplied);
+    if (output.isNull())
+        return QImage(); // Allocation failure
+
+    const QVector<Contribution> columns = contributions(input.width(), targetSize.width());
+    const QVector<Contribution> rows = contributions(input.height(), targetSize.height());
+    QVector<float> accumulator(input.width() * 4);
+
+    for (int oy = 0; oy < targetSize.height(); ++oy)
+    {
+        // Vertical pass: weighted sum of the covered source rows
+        accumulator.fill(0.0f);
+        const Contribution &c = rows[oy];
+        for (int k = 0; k < c.weights.size(); ++k)
+            accumulateRow(accumulator.data(), input.constScanLine(c.first + k), input.width(), c.weights[k]);
+
+        // Horizontal pass straight into the output scanline
+        resampleRow(accumulator.constData(), columns, output.scanLine(oy));
+    }
+
+    return output;
+}
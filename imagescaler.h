@@ -0,0 +1,28 @@
+#ifndef IMAGESCALER_H
+#define IMAGESCALER_H
+
+#include <QImage>
+#include <QSize>
+
+/**
+ * ImageScaler
+ * ---------------------------------------------------------------
+ * High-quality area-average (box filter) downscaling of page renders.
+ *
+ *  - Every output pixel is the exact area-weighted mean of the source
+ *    pixels it covers, so large ratios stay crisp instead of aliasing or
+ *    going soft like bilinear sampling does.
+ *  - Separable: one vertical pass into a float row, one horizontal pass.
+ *  - The vertical pass handles four pixels (16 bytes) per SSE2 step; the
+ *    horizontal pass keeps one whole pixel per vector. A scalar path is
+ *    used where SSE2 is not available.
+ *  - Pure function of its inputs: safe on any thread (used from workers).
+ */
+class ImageScaler
+{
+public:
+    // Returns ARGB32_Premultiplied. Upscaling falls back to Qt smooth scaling.
+    static QImage areaDownscale(const QImage &source, const QSize &targetSize);
+};
+
+#endif // IMAGESCALER_H
@@ -0,0 +1,181 @@
+#include "latencymonitor.h"
+#include <QDebug>
+#include <QEvent>
+#include <QStringList>
+#include <QWidget>
+#include <algorithm>
+
+namespace
+{
+    const char *interactionName(LatencyMonitor::Interaction interaction)
+    {
+        switch (interaction)
+        {
+        case LatencyMonitor::Interaction::KeyNavigation:
+            return "key navigation";
+        case LatencyMonitor::Interaction::KeyZoom:
+            return "key zoom";
+        case LatencyMonitor::Interaction::Wheel:
+            return "wheel";
+        case LatencyMonitor::Interaction::ScrollBar:
+            return "scrollbar";
+        case LatencyMonitor::Interaction::Minimap:
+            return "minimap";
+        case LatencyMonitor::Interaction::Count:
+            break;
+        }
+        return "?";
+    }
+
+    // Nearest-rank percentile of a sorted series
+    double percentile(const QVector<double> &sorted, int p)
+    {
+        const int rank = qBound(0, int((p * sorted.size() + 99) / 100) - 1, int(sorted.size()) - 1);
+        return sorted[rank];
+    }
+}
+
+LatencyMonitor::LatencyMonitor(QWidget *view) : QObject(view), m_view(view)
+{
+    m_clock.start();
+}
+
+// Input ------------------------------------------------------------
+
+void LatencyMonitor::inputArrived(Interaction interaction)
+{
+    inputArrived(interaction, timestamp());
+}
+
+void LatencyMonitor::inputArrived(Interaction interaction, qint64 startNs)
+{
+    // The viewer may have been reparented since the last input
+    trackWindow();
+
+    if (m_pending.size() >= MAX_PENDING)
+    {
+        // Its frame is still to come: what elapsed so far is a lower bound
+        const Pending oldest = m_pending.takeFirst();
+        if (hadEffect(oldest))
+            record(oldest, timestamp());
+        else
+            ++m_series[int(oldest.interaction)].noEffect;
+    }
+    m_pending.append({interaction, startNs});
+}
+
+void LatencyMonitor::viewChanged()
+{
+    m_lastChangeNs = timestamp();
+}
+
+void LatencyMonitor::trackWindow()
+{
+    QWidget *window = m_view->window();
+    if (window == m_window)
+        return;
+
+    if (m_window)
+        m_window->removeEventFilter(this);
+    window->installEventFilter(this);
+    m_window = window;
+}
+
+// Frames -----------------------------------------------------------
+
+bool LatencyMonitor::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() != QEvent::UpdateRequest || m_pending.isEmpty() || m_inFrame)
+        return QObject::eventFilter(watched, event);
+
+    // Paint and flush now, so the stamp is taken once the frame is out
+    m_inFrame = true;
+    watched->event(event);
+    m_inFrame = false;
+
+    frameFinished();
+    return true;
+}
+
+void LatencyMonitor::frameFinished()
+{
+    // Inputs that changed the view are on screen now; the others wait for
+    // their (possibly later) change, or expire as having none
+    const qint64 now = timestamp();
+    QVector<Pending> waiting;
+    for (const Pending &pending : std::as_const(m_pending))
+    {
+        if (hadEffect(pending))
+            record(pending, now);
+        else if (now - pending.startNs > NO_EFFECT_MS * 1000000)
+            ++m_series[int(pending.interaction)].noEffect;
+        else
+            waiting.append(pending);
+    }
+    m_pending = waiting;
+}
+
+void LatencyMonitor::record(const Pending &pending, qint64 endNs)
+{
+    Series &series = m_series[int(pending.interaction)];
+    const double latencyMs = (endNs - pending.startNs) / 1e6;
+    if (series.samplesMs.size() < MAX_SAMPLES)
+        series.samplesMs.append(latencyMs);
+    else
+        series.samplesMs[series.next] = latencyMs;
+    series.next = (series.next + 1) % MAX_SAMPLES;
+    ++series.total;
+}
+
+// Reporting --------------------------------------------------------
+
+QString LatencyMonitor::report() const
+{
+    QStringList lines;
+    lines << QString("%1 %2 %3 %4 %5 %6 %7")
+                 .arg("interaction", -16)
+                 .arg("count", 7)
+                 .arg("p50 ms", 8)
+                 .arg("p90 ms", 8)
+                 .arg("p99 ms", 8)
+                 .arg("max ms", 8)
+                 .arg("no effect", 10);
+
+    for (int i = 0; i < int(Interaction::Count); ++i)
+    {
+        const Series &series = m_series[i];
+        if (series.samplesMs.isEmpty() && series.noEffect == 0)
+            continue;
+
+        QVector<double> sorted = series.samplesMs;
+        std::sort(sorted.begin(), sorted.end());
+        auto column = [&](int p)
+        { return sorted.isEmpty() ? QString("-").rightJustified(8) : QString("%1").arg(percentile(sorted, p), 8, 'f', 1); };
+
+        lines << QString("%1 %2 %3 %4 %5 %6 %7")
+                     .arg(interactionName(Interaction(i)), -16)
+                     .arg(series.total, 7)
+                     .arg(column(50))
+                     .arg(column(90))
+                     .arg(column(99))
+                     .arg(column(100))
+                     .arg(series.noEffect, 10);
+    }
+
+    if (lines.size() == 1)
+        return "No input latency samples yet.";
+    return lines.join('\n');
+}
+
+void LatencyMonitor::dump() const
+{
+    qInfo().noquote() << "Input-to-photon latency (last" << MAX_SAMPLES << "samples per interaction):\n" + report();
+}
+
+void LatencyMonitor::reset()
+{
+    m_pending.clear();
+    m_lastChangeNs = -1;
+    for (Series &series : m_series)
+        series = Series();
+}
@@ -0,0 +1,97 @@
+#ifndef LATENCYMONITOR_H
+#define LATENCYMONITOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QVector>
+
+class QWidget;
+
+/**
+ * LatencyMonitor
+ * ---------------------------------------------------------------
+ * Input-to-photon latency per interaction type: the time from an input
+ * event reaching the viewer to the end of the first frame painted after it.
+ *
+ * Responsibilities:
+ *  - Track the inputs the viewer handled (keys, wheel, scrollbar...), from
+ *    a timestamp taken before handling them.
+ *  - Close a pending input when the window's first backing-store sync
+ *    (paint + flush) after the view changed (scroll or zoom) finishes.
+ *  - Report p50/p90/p99/max per interaction (shortcut Ctrl+Shift+L).
+ *
+ * Design notes:
+ *  - The frame is the top-level window's UpdateRequest, dispatched from
+ *    the event filter so the stamp lands after painting, not before.
+ *  - Time spent in the OS queue before Qt dispatches the input and the
+ *    compositor's share are not visible here; numbers are a lower bound.
+ *  - Every input that changed the view is a sample, however slow: slow
+ *    frames are what the percentiles are for.
+ *  - An input the view never reacted to (Down on the last page) is not a
+ *    latency at all: after NO_EFFECT_MS it is counted apart as "no effect".
+ */
+class LatencyMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Interaction
+    {
+        KeyNavigation,
+        KeyZoom,
+        Wheel,
+        ScrollBar,
+        Minimap,
+        Count
+    };
+
+    explicit LatencyMonitor(QWidget *view);
+
+    qint64 timestamp() const { return m_clock.nsecsElapsed(); } // Take before handling an input...
+    void inputArrived(Interaction interaction, qint64 startNs);  // ...report once it was handled.
+    void inputArrived(Interaction interaction);                  // Handled, effect still to come.
+    void viewChanged(); // The view scrolled or zoomed: pending inputs had an effect.
+
+    // Reporting -----------------------------------------------------
+    QString report() const; // One line per interaction with samples.
+    void dump() const;      // report() to the log.
+    void reset();
+
+    static constexpr int MAX_SAMPLES = 1024; // Per interaction, most recent kept
+    static constexpr int MAX_PENDING = 64;
+    static constexpr qint64 NO_EFFECT_MS = 1000; // No view change this long after an input: it had none
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Pending
+    {
+        Interaction interaction;
+        qint64 startNs;
+    };
+
+    struct Series
+    {
+        QVector<double> samplesMs; // Ring buffer of MAX_SAMPLES
+        int next = 0;
+        int total = 0;
+        int noEffect = 0;
+    };
+
+    void record(const Pending &pending, qint64 endNs);
+    bool hadEffect(const Pending &pending) const { return m_lastChangeNs >= pending.startNs; }
+    void frameFinished();
+    void trackWindow();
+
+    QWidget *m_view;
+    QPointer<QWidget> m_window;
+    QElapsedTimer m_clock;
+    QVector<Pending> m_pending;
+    qint64 m_lastChangeNs = -1; // Last viewChanged()
+    Series m_series[int(Interaction::Count)];
+    bool m_inFrame = false;
+};
+
+#endif // LATENCYMONITOR_H
@@ -12,13 +12,45 @@
  */
 
 #include "mainwindow.h"
+#include "memoryaccounting.h"
+#include "soakrunner.h"
+#include "deepzoomexporter.h"
+#include "viewerconfig.h"
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    // `--soak` and `--export-dzi` run headless: the platform has to be chosen before QApplication exists
+    const bool soak = SoakRunner::isRequested(argc, argv);
+    const bool exportDzi = DeepZoomExporter::isRequested(argc, argv);
+    if ((soak || exportDzi) && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     // QApplication drives the Qt event loop.
     QApplication prettyDopeFileviewer(argc, argv);
 
+    // `kill -USR1 <pid>` prints the per-subsystem memory breakdown
+    MemoryAccounting::installDumpSignalHandler();
+
+    // Tunables: viewer.ini + PDV_* overrides, watched for edits (GUI thread owns it)
+    ViewerConfig::instance();
+
+    // Leak hunt: open/scroll/zoom/close for hours, exit code is the verdict
+    if (soak)
+    {
+        SoakRunner runner(prettyDopeFileviewer.arguments());
+        return runner.exec();
+    }
+
+    // Tile pyramid export for static serving, no window
+    if (exportDzi)
+    {
+        DeepZoomExporter exporter(prettyDopeFileviewer.arguments());
+        return exporter.exec();
+    }
+
     // Visual style (can be changed per platform / preference).
     // QApplication::setStyle("windowsvista");
 
@@ -26,6 +58,18 @@ int main(int argc, char *argv[])
     MainWindow mainWindow;
     mainWindow.show();
 
+    // `PrettyDopeFileviewer -` reads the PDF from stdin (e.g. a pipeline),
+    // `PrettyDopeFileviewer https://...` views a remote PDF without downloading it
+    const QString source = prettyDopeFileviewer.arguments().value(1);
+    if (source == "-")
+    {
+        mainWindow.openStandardInput();
+    }
+    else if (source.startsWith("http://") || source.startsWith("https://"))
+    {
+        mainWindow.openUrl(QUrl(source));
+    }
+
     // Enter event loop – app lives until window is closed.
     return prettyDopeFileviewer.exec();
 }
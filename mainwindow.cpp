@@ -1,5 +1,15 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
+#include "printpreviewdialog.h"
+#include "memoryaccounting.h"
+#include "perfreport.h"
+#include "readingqueue.h"
+#include "searchpanel.h"
+#include "streamreader.h"
+#include "httprangedevice.h"
+#include "viewerconfig.h"
+#include "bandedexport.h"
+#include "textdiff.h"
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QKeyEvent>
@@ -8,26 +18,113 @@
 #include <QShortcut>
 #include <QKeySequence>
 #include <QAction>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QIntValidator>
+#include <QInputDialog>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QDockWidget>
+#include <QFileInfo>
+#include <QFontDatabase>
+#include <QFutureWatcher>
+#include <QPlainTextEdit>
+#include <QProgressDialog>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QTreeView>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+#include <QAtomicInt>
+#include <memory>
 
 // Main application window implementation
 // Responsibilities: file loading, zoom handling, navigation wiring
 // Owns: PDFViewer (which owns PDFDocument once loaded)
 
 // Construction -----------------------------------------------------
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWindow), m_viewer(new PDFViewer())
+MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWindow), m_viewer(new PDFViewer()), m_pageEntry(nullptr), m_readingQueue(new ReadingQueue(this)), m_searchPanel(new SearchPanel(this)), m_layerDock(new QDockWidget(tr("Layers"), this)), m_layerView(new QTreeView())
 {
     ui->setupUi(this);
 
     setCentralWidget(m_viewer);
+    setupPageEntry();
 
     // Wire toolbar actions
     connect(ui->actionOpen, &QAction::triggered, this, &MainWindow::openFile);
     connect(ui->actionQuit, &QAction::triggered, this, &MainWindow::quit);
+    connect(ui->actionPrint, &QAction::triggered, this, &MainWindow::openPrintPreview);
+
+    // Remote documents (HTTP range requests)
+    QAction *urlAction = ui->menuFile->addAction(tr("Open URL..."));
+    connect(urlAction, &QAction::triggered, this, &MainWindow::openUrlDialog);
+
+    // Reading queue: next document is preloaded while the current one is read
+    m_readingQueue->setRenderCache(m_viewer->renderCache());
+    QAction *queueAction = ui->menuFile->addAction(tr("Open reading queue..."));
+    connect(queueAction, &QAction::triggered, this, &MainWindow::openReadingQueue);
+
+    QAction *nextAction = ui->menuFile->addAction(tr("Next document"));
+    nextAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_BracketRight));
+    connect(nextAction, &QAction::triggered, this, &MainWindow::nextDocument);
+
+    QAction *previousAction = ui->menuFile->addAction(tr("Previous document"));
+    previousAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_BracketLeft));
+    connect(previousAction, &QAction::triggered, this, &MainWindow::previousDocument);
+
+    // One search over every open document; results prefetch their page when selected
+    addDockWidget(Qt::RightDockWidgetArea, m_searchPanel);
+    m_searchPanel->hide();
+    connect(m_searchPanel, &SearchPanel::resultHighlighted, this, &MainWindow::prefetchSearchResult);
+    connect(m_searchPanel, &SearchPanel::resultActivated, this, &MainWindow::openSearchResult);
+
+    QAction *searchAction = ui->menuFile->addAction(tr("Search all documents..."));
+    searchAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F));
+    connect(searchAction, &QAction::triggered, this, &MainWindow::showSearch);
+
+    // Optional content (CAD layers, language variants): check to show, uncheck to hide
+    m_layerDock->setObjectName("layerPanel");
+    m_layerView->setHeaderHidden(true);
+    m_layerDock->setWidget(m_layerView);
+    addDockWidget(Qt::LeftDockWidgetArea, m_layerDock);
+    m_layerDock->hide();
+    ui->menuFile->addAction(m_layerDock->toggleViewAction());
+    ui->menuFile->addSeparator();
+
+    // High-DPI raster of the current page (plotting), rendered in bands
+    QAction *exportAction = ui->menuFile->addAction(tr("Export page as PNG..."));
+    connect(exportAction, &QAction::triggered, this, &MainWindow::exportPageImage);
+
+    // Word-level changes against another revision, highlighted on this one
+    QAction *compareAction = ui->menuFile->addAction(tr("Compare text with older revision..."));
+    connect(compareAction, &QAction::triggered, this, &MainWindow::compareRevisions);
+
+    // Diagnostics
+    QAction *perfReportAction = ui->menuFile->addAction(tr("Performance report..."));
+    connect(perfReportAction, &QAction::triggered, this, &MainWindow::runPerformanceReport);
+
+    // Debug: dump where memory goes (same as SIGUSR1)
+    QShortcut *memoryDump = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_M), this);
+    connect(memoryDump, &QShortcut::activated, this, []()
+            { MemoryAccounting::instance().dump(); });
+
+    // Debug: input-to-photon latency percentiles since start
+    QShortcut *latencyDump = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_L), this);
+    connect(latencyDump, &QShortcut::activated, this, [this]()
+            { m_viewer->latencyMonitor()->dump(); });
 
     // Wire signals
     connect(m_viewer, &PDFViewer::currentPageChanged, this, &MainWindow::updateWindowTitle);
+    connect(m_viewer, &PDFViewer::currentPageChanged, this, &MainWindow::prefetchRemotePages);
     connect(m_viewer, &PDFViewer::zoomChanged, this, &MainWindow::updateWindowTitle);
 
+    // Optional ICC display profile (color-managed rendering of CMYK/ICC content)
+    const QString displayProfile = qEnvironmentVariable("PDV_DISPLAY_PROFILE");
+    if (!displayProfile.isEmpty() && !m_viewer->setDisplayProfile(displayProfile))
+    {
+        qWarning() << "MainWindow: Cannot read display profile" << displayProfile;
+    }
 }
 
 // Destruction ------------------------------------------------------
@@ -65,15 +162,577 @@ void MainWindow::openFile()
         return;
     }
 
+    // A single file replaces any reading queue
+    m_readingQueue->setFiles(QStringList());
+    if (showDocument(std::move(doc)))
+    {
+        closeStream();
+    }
+}
+
+bool MainWindow::showDocument(std::unique_ptr<PDFDocument> document)
+{
     // Show in viewer
-    if (!m_viewer->setDocument(std::move(doc)))
+    if (!m_viewer->setDocument(std::move(document)))
     {
         qDebug() << "MainWindow: Failed to set document in viewer";
         QMessageBox::warning(this, tr("Error"), tr("Error configuring the PDF viewer."));
-        return;
+        return false;
     }
 
     updateWindowTitle();
+    updateSearchSources();
+    updateLayerPanel();
+    return true;
+}
+
+void MainWindow::updateLayerPanel()
+{
+    // Toggles go straight to Poppler's model; the viewer re-renders from it
+    QAbstractItemModel *layers = m_viewer->document() ? m_viewer->document()->layerModel() : nullptr;
+    m_layerView->setModel(layers);
+    m_layerView->expandAll();
+    m_layerDock->toggleViewAction()->setEnabled(layers != nullptr);
+    m_layerDock->setVisible(layers != nullptr);
+}
+
+// Reading Queue ----------------------------------------------------
+void MainWindow::openReadingQueue()
+{
+    const QStringList files = QFileDialog::getOpenFileNames(this, tr("Open reading queue"), QString(),
+                                                            tr("PDF files (*.pdf)"));
+    if (files.isEmpty())
+    {
+        return;
+    }
+
+    m_readingQueue->setFiles(files);
+    openQueuedDocument(0);
+}
+
+void MainWindow::nextDocument()
+{
+    if (m_readingQueue->hasNext())
+    {
+        openQueuedDocument(m_readingQueue->currentIndex() + 1);
+    }
+}
+
+void MainWindow::previousDocument()
+{
+    if (m_readingQueue->hasPrevious())
+    {
+        openQueuedDocument(m_readingQueue->currentIndex() - 1);
+    }
+}
+
+void MainWindow::openQueuedDocument(int index)
+{
+    // Usually the preloaded instance: no parsing, hashing or first renders left
+    auto document = m_readingQueue->openDocument(index);
+    if (!document)
+    {
+        QMessageBox::warning(this, tr("Error"), tr("Failed to open %1.").arg(m_readingQueue->files().value(index)));
+        return;
+    }
+
+    if (showDocument(std::move(document)))
+    {
+        // Start on the next one while this one is being read
+        closeStream();
+        m_readingQueue->preloadNext(m_viewer->renderDpi(), m_viewer->displayProfile());
+    }
+}
+
+// Search -----------------------------------------------------------
+void MainWindow::showSearch()
+{
+    m_searchPanel->show();
+    m_searchPanel->raise();
+    m_searchPanel->focusQuery();
+}
+
+void MainWindow::updateSearchSources()
+{
+    QVector<SearchSource> sources;
+    const PDFDocument *current = m_viewer->document();
+
+    if (m_readingQueue->count() > 0)
+    {
+        const QStringList files = m_readingQueue->files();
+        for (int i = 0; i < files.size(); ++i)
+        {
+            SearchSource source;
+            source.filePath = files[i];
+            source.title = QFileInfo(files[i]).fileName();
+            source.queueIndex = i;
+            if (i == m_readingQueue->currentIndex() && current)
+                source.contentHash = current->contentHash();
+            sources.append(source);
+        }
+    }
+    else if (current)
+    {
+        SearchSource source;
+        source.filePath = current->filePath();
+        source.data = current->data();
+        source.contentHash = current->contentHash();
+        source.title = current->title();
+        sources.append(source);
+    }
+
+    m_searchPanel->setSources(sources);
+}
+
+void MainWindow::prefetchSearchResult(const SearchSource &source, int pageIndex)
+{
+    if (source.queueIndex < 0 || source.queueIndex == m_readingQueue->currentIndex())
+    {
+        m_viewer->prefetchPage(pageIndex);
+        return;
+    }
+
+    // Opening it will adopt this preload: the target page is a cache hit
+    m_readingQueue->preload(source.queueIndex, m_viewer->renderDpi(), m_viewer->displayProfile(), pageIndex);
+}
+
+void MainWindow::openSearchResult(const SearchSource &source, int pageIndex)
+{
+    if (source.queueIndex >= 0 && source.queueIndex != m_readingQueue->currentIndex())
+    {
+        openQueuedDocument(source.queueIndex);
+        if (m_readingQueue->currentIndex() != source.queueIndex)
+        {
+            return;
+        }
+    }
+
+    m_viewer->goToPage(pageIndex);
+}
+
+// Remote Documents -------------------------------------------------
+void MainWindow::openUrlDialog()
+{
+    const QString text = QInputDialog::getText(this, tr("Open URL"), tr("PDF address (http or https):"));
+    if (!text.trimmed().isEmpty())
+    {
+        openUrl(QUrl::fromUserInput(text.trimmed()));
+    }
+}
+
+void MainWindow::openUrl(const QUrl &url)
+{
+    // Only the header block is fetched here; Poppler pulls the rest on demand
+    auto device = std::make_unique<HttpRangeDevice>(url);
+    if (!device->open(QIODevice::ReadOnly))
+    {
+        QMessageBox::warning(this, tr("Error"), tr("Cannot open %1: %2").arg(url.toString(), device->errorString()));
+        return;
+    }
+
+    HttpRangeDevice *remote = device.get(); // Owned by the document from here on
+    const QByteArray identity = device->identity();
+    auto document = std::make_unique<PDFDocument>();
+    if (!document->loadFromDevice(std::move(device), identity, url.fileName()))
+    {
+        QMessageBox::warning(this, tr("Error"), tr("Failed to open PDF. It may be damaged or password protected?"));
+        return;
+    }
+
+    m_readingQueue->setFiles(QStringList());
+    if (showDocument(std::move(document)))
+    {
+        closeStream();
+        qInfo() << "MainWindow: First pages of" << url.toString() << "shown after fetching"
+                << remote->fetchedBytes() << "of" << remote->size() << "bytes";
+    }
+}
+
+void MainWindow::prefetchRemotePages(int pageIndex)
+{
+    PDFDocument *document = m_viewer->hasDocument() ? m_viewer->document() : nullptr;
+    HttpRangeDevice *remote = document ? qobject_cast<HttpRangeDevice *>(document->device()) : nullptr;
+    const int pageCount = document ? document->pageCount() : 0;
+    if (!remote || !document->isLinearized() || pageIndex + 1 >= pageCount)
+    {
+        return; // Elsewhere page objects may sit anywhere in the file
+    }
+
+    // Linearized: pages follow each other in page order, so the next few
+    // are roughly their share of the file past this one
+    const int window = qMax(1, ViewerConfig::instance().settings().prefetchWindow);
+    const int last = qMin(pageIndex + window, pageCount - 1);
+    const qint64 offset = remote->size() * (pageIndex + 1) / pageCount;
+    const qint64 end = remote->size() * (last + 1) / pageCount;
+    remote->prefetch(offset, end - offset);
+}
+
+// Standard Input ---------------------------------------------------
+void MainWindow::openStandardInput()
+{
+    closeStream();
+    m_readingQueue->setFiles(QStringList());
+
+    // Parse attempts happen per complete revision and at end of input
+    m_streamReader = new StreamReader(this);
+    m_streamReader->setSpillThreshold(ViewerConfig::instance().settings().streamSpillBytes);
+    connect(m_streamReader, &StreamReader::revisionAvailable, this, &MainWindow::loadStreamedDocument);
+    connect(m_streamReader, &StreamReader::finished, this, &MainWindow::loadStreamedDocument);
+    connect(m_streamReader, &StreamReader::failed, this, [this](const QString &error)
+            { QMessageBox::warning(this, tr("Error"), error); });
+
+    if (!m_streamReader->start(0))
+    {
+        QMessageBox::warning(this, tr("Error"), tr("Cannot read from standard input."));
+        closeStream();
+        return;
+    }
+    setWindowTitle(tr("PrettyDopeFileviewer - reading standard input..."));
+}
+
+void MainWindow::loadStreamedDocument()
+{
+    // Nothing arrived since the last successful parse
+    if (!m_streamReader || m_streamReader->bytesRead() == m_streamParsedBytes)
+    {
+        return;
+    }
+
+    auto document = std::make_unique<PDFDocument>();
+    const bool loaded = m_streamReader->isSpilled()
+                            ? document->loadFromFile(m_streamReader->spillPath())
+                            : document->loadFromData(m_streamReader->takeSnapshot(), tr("Standard input"));
+    if (!loaded)
+    {
+        // A "%%EOF" inside a stream, or a revision still incomplete: wait for more
+        if (m_streamReader->isFinished())
+        {
+            QMessageBox::warning(this, tr("Error"), tr("Standard input did not contain a readable PDF."));
+        }
+        return;
+    }
+
+    // A later revision replaces the shown one; stay on the same page
+    const int page = m_streamParsedBytes >= 0 ? m_viewer->currentPage() : 0;
+    m_streamParsedBytes = m_streamReader->bytesRead();
+    if (showDocument(std::move(document)) && page > 0)
+    {
+        m_viewer->goToPage(page);
+    }
+}
+
+void MainWindow::closeStream()
+{
+    // Only once its document is gone: Poppler may still read the spill file
+    delete m_streamReader;
+    m_streamReader = nullptr;
+    m_streamParsedBytes = -1;
+}
+
+// Go-to-page Box ----------------------------------------------------
+void MainWindow::setupPageEntry()
+{
+    m_pageEntry = new QLineEdit(this);
+    m_pageEntry->setValidator(new QIntValidator(1, 999999, m_pageEntry));
+    m_pageEntry->setPlaceholderText(tr("Page"));
+    m_pageEntry->setMaximumWidth(70);
+    m_pageEntry->setAlignment(Qt::AlignRight);
+
+    ui->toolBar->addSeparator();
+    ui->toolBar->addWidget(m_pageEntry);
+
+    // Each typed digit is a candidate: prefetch it while the user keeps typing
+    connect(m_pageEntry, &QLineEdit::textEdited, this, &MainWindow::pageEntryEdited);
+    connect(m_pageEntry, &QLineEdit::returnPressed, this, &MainWindow::pageEntryConfirmed);
+
+    // Mirror scrolling into the box unless the user is typing in it
+    connect(m_viewer, &PDFViewer::currentPageChanged, this, [this](int pageIndex)
+            {
+                if (!m_pageEntry->hasFocus())
+                    m_pageEntry->setText(QString::number(pageIndex + 1)); });
+}
+
+int MainWindow::pageEntryIndex() const
+{
+    bool ok = false;
+    const int pageNumber = m_pageEntry->text().toInt(&ok);
+    return ok ? pageNumber - 1 : -1;
+}
+
+void MainWindow::pageEntryEdited(const QString &text)
+{
+    Q_UNUSED(text);
+    m_viewer->prefetchPage(pageEntryIndex());
+}
+
+void MainWindow::pageEntryConfirmed()
+{
+    const int pageIndex = pageEntryIndex();
+    if (pageIndex < 0 || !m_viewer->hasDocument() || pageIndex >= m_viewer->document()->pageCount())
+    {
+        return;
+    }
+
+    // Usually already rendered by the prefetch: the jump only scrolls
+    m_viewer->goToPage(pageIndex);
+    m_viewer->setFocus();
+}
+
+// Printing ---------------------------------------------------------
+void MainWindow::openPrintPreview()
+{
+    if (!m_viewer->hasDocument())
+    {
+        return;
+    }
+
+    // Preview shares the viewer's render cache: already seen pages are free
+    PrintPreviewDialog dialog(m_viewer->document(), m_viewer->renderCache(), this);
+    dialog.exec();
+}
+
+// Performance Report -----------------------------------------------
+void MainWindow::runPerformanceReport()
+{
+    if (!m_viewer->hasDocument())
+    {
+        return;
+    }
+
+    const QString filePath = m_viewer->document()->filePath();
+    const QString displayProfile = m_viewer->displayProfile();
+    if (filePath.isEmpty())
+    {
+        QMessageBox::information(this, tr("Performance report"), tr("The report needs a document opened from a file."));
+        return;
+    }
+
+    QProgressDialog *progress = new QProgressDialog(tr("Rendering every page..."), tr("Cancel"),
+                                                    0, m_viewer->document()->pageCount(), this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+
+    // Headless pass on a worker thread with its own copy of the document.
+    // Cancel through a flag, not the future: a canceled future drops the
+    // result, and the pages measured so far are still worth showing.
+    auto canceled = std::make_shared<QAtomicInt>(0);
+    QFutureWatcher<PerfReport> *watcher = new QFutureWatcher<PerfReport>(this);
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, [canceled, watcher, progress]()
+            {
+                canceled->storeRelaxed(1);
+                watcher->disconnect(progress); // Late progress would reopen the dialog
+            });
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, progress]()
+            {
+                progress->deleteLater();
+                watcher->deleteLater();
+                if (watcher->future().resultCount() > 0)
+                    showPerformanceReport(watcher->result()); });
+
+    watcher->setFuture(QtConcurrent::run([filePath, displayProfile, canceled](QPromise<PerfReport> &promise)
+                                         {
+        PerfReport report = PerfReport::run(filePath, ViewerConfig::instance().settings().renderDpi, displayProfile,
+                                            [&promise, canceled](int done, int total)
+                                            {
+                                                promise.setProgressRange(0, total);
+                                                promise.setProgressValue(done);
+                                                return !canceled->loadRelaxed();
+                                            });
+        promise.addResult(report); }));
+}
+
+void MainWindow::exportPageImage()
+{
+    if (!m_viewer->hasDocument())
+    {
+        return;
+    }
+
+    const QString filePath = m_viewer->document()->filePath();
+    const QString displayProfile = m_viewer->displayProfile();
+    const QByteArray layers = m_viewer->document()->layerVisibility(); // What is on screen, not the defaults
+    const int pageIndex = m_viewer->currentPage();
+    if (filePath.isEmpty())
+    {
+        QMessageBox::information(this, tr("Export page"), tr("Export needs a document opened from a file."));
+        return;
+    }
+
+    bool ok = false;
+    const int dpi = QInputDialog::getInt(this, tr("Export page"), tr("Resolution (DPI):"), 600, 72, 2400, 50, &ok);
+    if (!ok)
+    {
+        return;
+    }
+
+    const QString outputPath = QFileDialog::getSaveFileName(this, tr("Export page"),
+                                                            QString("page-%1.png").arg(pageIndex + 1), tr("PNG images (*.png)"));
+    if (outputPath.isEmpty())
+    {
+        return;
+    }
+
+    QProgressDialog *progress = new QProgressDialog(tr("Rendering page %1 at %2 DPI...").arg(pageIndex + 1).arg(dpi),
+                                                    tr("Cancel"), 0, 100, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+
+    // Worker thread with its own copy of the document; memory stays at one band
+    QFutureWatcher<QString> *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcherBase::cancel);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, progress]()
+            {
+                progress->deleteLater();
+                watcher->deleteLater();
+                const QString error = watcher->future().resultCount() > 0 ? watcher->result() : QString();
+                if (!error.isEmpty() && !watcher->isCanceled())
+                    QMessageBox::warning(this, tr("Export page"), error); });
+
+    watcher->setFuture(QtConcurrent::run([=](QPromise<QString> &promise)
+                                         {
+        promise.setProgressRange(0, 100);
+        QString error;
+        BandedExport::run(filePath, pageIndex, dpi, outputPath, displayProfile, layers,
+                          [&promise](int rowsDone, int rowsTotal)
+                          {
+                              promise.setProgressValue(int(qint64(rowsDone) * 100 / rowsTotal));
+                              return !promise.isCanceled();
+                          },
+                          &error);
+        promise.addResult(error); }));
+}
+
+void MainWindow::compareRevisions()
+{
+    if (!m_viewer->hasDocument())
+    {
+        return;
+    }
+
+    const QString newPath = m_viewer->document()->filePath();
+    if (newPath.isEmpty())
+    {
+        QMessageBox::information(this, tr("Compare"), tr("Comparing needs a document opened from a file."));
+        return;
+    }
+
+    const QString oldPath = QFileDialog::getOpenFileName(this, tr("Compare with older revision"), QFileInfo(newPath).absolutePath(),
+                                                         tr("PDF files (*.pdf)"));
+    if (oldPath.isEmpty())
+    {
+        return;
+    }
+
+    QProgressDialog *progress = new QProgressDialog(tr("Extracting text from both revisions..."), tr("Cancel"), 0, 100, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+
+    // Both files on worker threads, each split in page chunks with private documents
+    QFutureWatcher<TextDiff> *watcher = new QFutureWatcher<TextDiff>(this);
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcherBase::cancel);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, progress, newPath]()
+            {
+                progress->deleteLater();
+                watcher->deleteLater();
+                if (watcher->isCanceled() || watcher->future().resultCount() == 0)
+                    return;
+
+                const TextDiff diff = watcher->result();
+                if (!diff.isValid())
+                    QMessageBox::warning(this, tr("Compare"), diff.error());
+                else if (m_viewer->hasDocument() && m_viewer->document()->filePath() == newPath)
+                    showTextDiff(diff); });
+
+    watcher->setFuture(QtConcurrent::run([=](QPromise<TextDiff> &promise)
+                                         {
+        promise.setProgressRange(0, 100);
+        promise.addResult(TextDiff::run(oldPath, newPath,
+                                        [&promise](int pagesDone, int pagesTotal)
+                                        {
+                                            promise.setProgressValue(int(qint64(pagesDone) * 100 / qMax(1, pagesTotal)));
+                                            return !promise.isCanceled();
+                                        })); }));
+}
+
+void MainWindow::showTextDiff(const TextDiff &diff)
+{
+    // Changed words tinted, removed ones marked by a caret where they were
+    QHash<int, QVector<PageHighlight>> highlights;
+    for (const DiffRegion &region : diff.regions(TextDiff::Side::New))
+    {
+        const QColor color = region.caret ? QColor(220, 0, 0, 160) : QColor(255, 190, 0, 90);
+        highlights[region.page].append(PageHighlight{region.box, color});
+    }
+    m_viewer->setHighlights(highlights);
+
+    QDialog *dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(tr("Text changes"));
+    dialog->resize(760, 560);
+
+    QLabel *summary = new QLabel(diff.summary(), dialog);
+    QListWidget *changes = new QListWidget(dialog);
+    for (const DiffHunk &hunk : diff.hunks())
+    {
+        const int page = diff.hunkPage(hunk, TextDiff::Side::New);
+        QListWidgetItem *item = new QListWidgetItem(QString("p. %1   - %2   + %3")
+                                                        .arg(page + 1)
+                                                        .arg(diff.hunkText(hunk, TextDiff::Side::Old),
+                                                             diff.hunkText(hunk, TextDiff::Side::New)),
+                                                    changes);
+        item->setData(Qt::UserRole, page);
+    }
+    connect(changes, &QListWidget::itemActivated, this, [this](QListWidgetItem *item)
+            { m_viewer->goToPage(item->data(Qt::UserRole).toInt()); });
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, dialog);
+    connect(buttons, &QDialogButtonBox::rejected, dialog, &QDialog::close);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addWidget(summary);
+    layout->addWidget(changes);
+    layout->addWidget(buttons);
+
+    // Non-modal: navigate the document while reading the list; closing clears the marks
+    connect(dialog, &QDialog::finished, this, [this]()
+            { m_viewer->setHighlights({}); });
+    dialog->show();
+}
+
+void MainWindow::showPerformanceReport(const PerfReport &report)
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle(report.isComplete() ? tr("Performance report") : tr("Performance report (incomplete)"));
+    dialog.resize(760, 560);
+
+    QPlainTextEdit *text = new QPlainTextEdit(report.summary(), &dialog);
+    text->setReadOnly(true);
+    text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, &dialog);
+    QPushButton *saveButton = buttons->addButton(tr("Save CSV..."), QDialogButtonBox::ActionRole);
+
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+    layout->addWidget(text);
+    layout->addWidget(buttons);
+
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    connect(saveButton, &QPushButton::clicked, &dialog, [&dialog, &report]()
+            {
+                const QString path = QFileDialog::getSaveFileName(&dialog, tr("Save report"), QString(), tr("CSV files (*.csv)"));
+                if (path.isEmpty())
+                    return;
+
+                QSaveFile file(path);
+                if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+                    return;
+                file.write(report.toCsv().toUtf8());
+                file.commit(); });
+
+    dialog.exec();
 }
 
 // Application Control ----------------------------------------------
@@ -97,6 +756,11 @@ void MainWindow::updateWindowTitle()
                         .arg(m_viewer->document()->pageCount())
                         .arg(int(m_viewer->zoom() * 100));
 
+    if (m_readingQueue->count() > 1)
+    {
+        title += QString(" - [%1/%2]").arg(m_readingQueue->currentIndex() + 1).arg(m_readingQueue->count());
+    }
+
     setWindowTitle(title);
 }
 
@@ -2,8 +2,19 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QUrl>
 #include "pdfdocument.h"
 #include "pdfviewer.h"
+#include "documentsearch.h" // SearchSource (slot arguments)
+
+class QDockWidget;
+class QLineEdit;
+class QTreeView;
+class PerfReport;
+class ReadingQueue;
+class SearchPanel;
+class StreamReader;
+class TextDiff;
 
 QT_BEGIN_NAMESPACE
 namespace Ui
@@ -20,17 +31,50 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow() override;
 
+    void openStandardInput(); // `PrettyDopeFileviewer -`: PDF piped in on stdin.
+    void openUrl(const QUrl &url); // Remote PDF fetched by HTTP range requests.
 
 private slots:
     void openFile();
+    void openUrlDialog();
+    void openReadingQueue();
+    void nextDocument();
+    void previousDocument();
+    void showSearch();
+    void prefetchSearchResult(const SearchSource &source, int pageIndex);
+    void openSearchResult(const SearchSource &source, int pageIndex);
+    void prefetchRemotePages(int pageIndex); // Remote documents: ask for the pages that follow.
+    void loadStreamedDocument();
     void quit();
+    void openPrintPreview();
+    void exportPageImage();
+    void compareRevisions();
+    void runPerformanceReport();
+    void pageEntryEdited(const QString &text);
+    void pageEntryConfirmed();
 
 private:
     void updateWindowTitle();
+    bool showDocument(std::unique_ptr<PDFDocument> document); // Warns the user on failure.
+    void openQueuedDocument(int index);
+    void updateSearchSources(); // Current document + reading queue.
+    void updateLayerPanel();    // Shown only for documents with optional content.
+    void closeStream();
+    void setupPageEntry();
+    int pageEntryIndex() const; // 0-based, -1 if the text is not a page.
+    void showPerformanceReport(const PerfReport &report);
+    void showTextDiff(const TextDiff &diff);
 
 private:
     Ui::MainWindow *ui;
     PDFViewer *m_viewer;
+    QLineEdit *m_pageEntry; // Go-to-page box (toolbar)
+    ReadingQueue *m_readingQueue; // Files read in sequence (next one preloaded)
+    SearchPanel *m_searchPanel;   // Query across every open document (dock)
+    QDockWidget *m_layerDock;     // Optional content of the shown document...
+    QTreeView *m_layerView;       // ...as Poppler's checkable layer tree
+    StreamReader *m_streamReader = nullptr; // stdin source of the shown document, if any
+    qint64 m_streamParsedBytes = -1;        // Input size at the last successful parse
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,139 @@
+/**
+ * MemoryAccounting implementation
+ * ---------------------------------------------------------------
+ * A mutex-protected hash of per-subsystem totals, plus the SIGUSR1 hook.
+ */
+
+#include "memoryaccounting.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QLocale>
+#include <QVector>
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <csignal>
+#include <unistd.h>
+#endif
+
+// Registry ---------------------------------------------------------
+
+MemoryAccounting &MemoryAccounting::instance()
+{
+    static MemoryAccounting registry;
+    return registry;
+}
+
+void MemoryAccounting::adjust(const QString &subsystem, qint64 bytesDelta, int instancesDelta)
+{
+    QMutexLocker locker(&m_mutex);
+    Usage &usage = m_usage[subsystem];
+    usage.bytes += bytesDelta;
+    usage.instances += instancesDelta;
+}
+
+qint64 MemoryAccounting::bytes(const QString &subsystem) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_usage.value(subsystem).bytes;
+}
+
+qint64 MemoryAccounting::totalBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 total = 0;
+    for (const Usage &usage : m_usage)
+        total += usage.bytes;
+    return total;
+}
+
+QString MemoryAccounting::report() const
+{
+    QVector<QPair<QString, Usage>> rows;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_usage.cbegin(); it != m_usage.cend(); ++it)
+            rows.append({it.key(), it.value()});
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b)
+              { return a.second.bytes > b.second.bytes; });
+
+    QLocale locale;
+    qint64 total = 0;
+    QString text = QString("%1 %2 %3\n").arg(QString("subsystem"), -22).arg(QString("instances"), 10).arg(QString("size"), 12);
+    for (const auto &row : rows)
+    {
+        total += row.second.bytes;
+        text += QString("%1 %2 %3\n")
+                    .arg(row.first, -22)
+                    .arg(row.second.instances, 10)
+                    .arg(locale.formattedDataSize(row.second.bytes), 12);
+    }
+    text += QString("%1 %2 %3\n").arg(QString("total"), -22).arg(QString(), 10).arg(locale.formattedDataSize(total), 12);
+    return text;
+}
+
+void MemoryAccounting::dump() const
+{
+    qInfo().noquote() << "Memory accounting:\n" + report();
+}
+
+// SIGUSR1 Hook -----------------------------------------------------
+// Classic self-pipe: the handler only writes a byte, the event loop dumps.
+
+#ifdef Q_OS_UNIX
+namespace
+{
+    int dumpPipe[2] = {-1, -1};
+
+    void onDumpSignal(int)
+    {
+        const char byte = 1;
+        [[maybe_unused]] ssize_t written = ::write(dumpPipe[1], &byte, 1);
+    }
+}
+#endif
+
+void MemoryAccounting::installDumpSignalHandler()
+{
+#ifdef Q_OS_UNIX
+    if (dumpPipe[0] >= 0 || ::pipe(dumpPipe) != 0)
+        return;
+
+    QSocketNotifier *notifier = new QSocketNotifier(dumpPipe[0], QSocketNotifier::Read, QCoreApplication::instance());
+    QObject::connect(notifier, &QSocketNotifier::activated, notifier, []()
+                     {
+                         char byte;
+                         [[maybe_unused]] ssize_t bytesRead = ::read(dumpPipe[0], &byte, 1);
+                         MemoryAccounting::instance().dump(); });
+
+    struct sigaction action = {};
+    action.sa_handler = onDumpSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+#endif
+}
+
+// MemoryAccount ----------------------------------------------------
+
+MemoryAccount::MemoryAccount(const QString &subsystem) : m_subsystem(subsystem)
+{
+    MemoryAccounting::instance().adjust(m_subsystem, 0, 1);
+}
+
+MemoryAccount::~MemoryAccount()
+{
+    MemoryAccounting::instance().adjust(m_subsystem, -m_bytes, -1);
+}
+
+void MemoryAccount::setBytes(qint64 bytes)
+{
+    if (bytes == m_bytes)
+        return;
+
+    MemoryAccounting::instance().adjust(m_subsystem, bytes - m_bytes, 0);
+    m_bytes = bytes;
+}
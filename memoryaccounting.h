@@ -0,0 +1,77 @@
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+/**
+ * MemoryAccounting
+ * ---------------------------------------------------------------
+ * Process-wide registry of bytes held per subsystem (caches, pools,
+ * documents, text structures...).
+ *
+ * Responsibilities:
+ *  - Aggregate live byte counts and instance counts per subsystem name.
+ *  - Produce a sorted breakdown on demand (shortcut or SIGUSR1).
+ *
+ * Design notes:
+ *  - Subsystems report through a MemoryAccount member (RAII): the entry
+ *    disappears with its owner, so the registry never dangles.
+ *  - Thread-safe: worker threads may update their accounts.
+ *  - Numbers are what each owner knows it holds; implicitly shared buffers
+ *    (e.g. a cached pixmap also shown by a page) appear in both subsystems.
+ */
+class MemoryAccounting
+{
+public:
+    static MemoryAccounting &instance();
+
+    // Reporting (used by MemoryAccount) -----------------------------
+    void adjust(const QString &subsystem, qint64 bytesDelta, int instancesDelta);
+
+    // Inspection ----------------------------------------------------
+    qint64 bytes(const QString &subsystem) const;
+    qint64 totalBytes() const;
+    QString report() const; // Multi-line table, largest subsystem first.
+    void dump() const;      // report() to the log.
+
+    // Unix only: dump on SIGUSR1 (call once, after QApplication exists)
+    static void installDumpSignalHandler();
+
+private:
+    MemoryAccounting() = default;
+
+    struct Usage
+    {
+        qint64 bytes = 0;
+        int instances = 0;
+    };
+
+    mutable QMutex m_mutex;
+    QHash<QString, Usage> m_usage;
+};
+
+/**
+ * MemoryAccount
+ * RAII handle: one per reporting object. setBytes() replaces the previous
+ * figure; destruction withdraws it.
+ */
+class MemoryAccount
+{
+public:
+    explicit MemoryAccount(const QString &subsystem);
+    ~MemoryAccount();
+
+    MemoryAccount(const MemoryAccount &) = delete;
+    MemoryAccount &operator=(const MemoryAccount &) = delete;
+
+    void setBytes(qint64 bytes);
+    qint64 bytes() const { return m_bytes; }
+
+private:
+    QString m_subsystem;
+    qint64 m_bytes = 0;
+};
+
+#endif // MEMORYACCOUNTING_H
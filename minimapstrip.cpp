@@ -0,0 +1,197 @@
+/**
+ * MinimapStrip implementation
+ * ---------------------------------------------------------------
+ * Atlas building (incremental) and single-pass strip painting.
+ */
+
+#include "minimapstrip.h"
+#include "pdfdocument.h"
+#include <QElapsedTimer>
+#include <QMouseEvent>
+#include <QPainter>
+#include <cstring>
+
+// Construction -----------------------------------------------------
+
+MinimapStrip::MinimapStrip(QWidget *parent) : QWidget(parent)
+{
+    setFixedWidth(STRIP_WIDTH);
+    setCursor(Qt::PointingHandCursor);
+
+    m_buildTimer.setInterval(0);
+    connect(&m_buildTimer, &QTimer::timeout, this, &MinimapStrip::buildNextPages);
+}
+
+// Document ---------------------------------------------------------
+
+void MinimapStrip::setDocument(PDFDocument *document)
+{
+    m_buildTimer.stop();
+    m_document = document;
+    m_pageCount = (document && document->isLoaded()) ? document->pageCount() : 0;
+    m_builtPages = 0;
+    m_atlas = QImage();
+    m_atlasPixmap = QPixmap();
+    m_pixmapPages = 0;
+    m_account.setBytes(0);
+
+    if (m_pageCount > 0)
+    {
+        const int rows = (m_pageCount + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+        m_atlas = QImage(ATLAS_COLUMNS * CELL_WIDTH, rows * CELL_HEIGHT, QImage::Format_Grayscale8);
+        m_atlas.fill(PENDING_GRAY);
+
+        // Silhouettes of a remote document would download all of it
+        if (!document->isRemote())
+        {
+            m_buildTimer.start();
+        }
+    }
+    update();
+}
+
+void MinimapStrip::setViewWindow(double topFraction, double heightFraction)
+{
+    m_viewTop = topFraction;
+    m_viewHeight = heightFraction;
+    update();
+}
+
+// Atlas Building ---------------------------------------------------
+
+void MinimapStrip::buildNextPages()
+{
+    if (!m_document || m_builtPages >= m_pageCount)
+    {
+        m_buildTimer.stop();
+        return;
+    }
+
+    QElapsedTimer budget;
+    budget.start();
+
+    while (m_builtPages < m_pageCount && budget.elapsed() < BUILD_BUDGET_MS)
+    {
+        const QRect cell = cellRect(m_builtPages);
+        const QImage image = silhouette(m_builtPages);
+
+        // Plain byte copies: both images are Grayscale8
+        const int offsetX = (cell.width() - image.width()) / 2;
+        const int offsetY = (cell.height() - image.height()) / 2;
+        for (int y = 0; y < cell.height(); ++y)
+        {
+            uchar *row = m_atlas.scanLine(cell.top() + y) + cell.left();
+            memset(row, GUTTER_GRAY, cell.width());
+
+            const int sourceY = y - offsetY;
+            if (sourceY >= 0 && sourceY < image.height())
+                memcpy(row + offsetX, image.constScanLine(sourceY), image.width());
+        }
+        ++m_builtPages;
+    }
+
+    update();
+}
+
+QImage MinimapStrip::silhouette(int pageIndex) const
+{
+    auto page = m_document->getPage(pageIndex);
+    if (!page)
+        return QImage();
+
+    // Embedded thumbnails are free; otherwise render just big enough for the cell
+    QImage image = page->thumbnail();
+    if (image.isNull())
+    {
+        const QSizeF points = page->pageSizeF();
+        if (points.isEmpty())
+            return QImage();
+
+        const double dpi = 72.0 * qMin(CELL_WIDTH / points.width(), CELL_HEIGHT / points.height());
+        image = page->renderToImage(dpi, dpi);
+    }
+
+    return image.scaled(CELL_WIDTH - 2, CELL_HEIGHT - 2, Qt::KeepAspectRatio, Qt::SmoothTransformation)
+        .convertToFormat(QImage::Format_Grayscale8);
+}
+
+QRect MinimapStrip::cellRect(int pageIndex) const
+{
+    return QRect((pageIndex % ATLAS_COLUMNS) * CELL_WIDTH, (pageIndex / ATLAS_COLUMNS) * CELL_HEIGHT,
+                 CELL_WIDTH, CELL_HEIGHT);
+}
+
+// Painting ---------------------------------------------------------
+// One pass, one source image: every slot is a sub-rectangle of the atlas
+
+void MinimapStrip::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(70, 70, 70));
+
+    if (m_atlas.isNull() || height() <= 0)
+        return;
+
+    // Compact Grayscale8 storage, converted once for fast blits; later
+    // paints bring over only the rows built since
+    if (m_atlasPixmap.isNull())
+    {
+        m_atlasPixmap = QPixmap::fromImage(m_atlas);
+        m_pixmapPages = m_builtPages;
+        m_account.setBytes(atlasBytes());
+    }
+    else if (m_pixmapPages < m_builtPages)
+    {
+        const int top = cellRect(m_pixmapPages).top();
+        const int bottom = cellRect(m_builtPages - 1).bottom();
+        const QRect rows(0, top, m_atlas.width(), bottom - top + 1);
+
+        QPainter copier(&m_atlasPixmap);
+        copier.setCompositionMode(QPainter::CompositionMode_Source);
+        copier.drawImage(rows.topLeft(), m_atlas, rows);
+        m_pixmapPages = m_builtPages;
+    }
+
+    // As many slots as fit; with more pages than slots, pages are sampled
+    const int slots = qMin(m_pageCount, qMax(1, height() / MIN_SLOT_HEIGHT));
+    const double slotHeight = double(height()) / slots;
+
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, slotHeight < CELL_HEIGHT);
+    for (int slot = 0; slot < slots; ++slot)
+    {
+        const int pageIndex = int(qint64(slot) * m_pageCount / slots);
+        const QRectF target(0, slot * slotHeight, width(), slotHeight);
+        painter.drawPixmap(target, m_atlasPixmap, QRectF(cellRect(pageIndex)));
+    }
+
+    // Visible window
+    const QRectF window(0.5, m_viewTop * height(), width() - 1.0, qMax(2.0, m_viewHeight * height()));
+    painter.setPen(QPen(QColor(80, 160, 255), 1.5));
+    painter.setBrush(QColor(80, 160, 255, 50));
+    painter.drawRect(window);
+}
+
+// Scrubbing --------------------------------------------------------
+
+void MinimapStrip::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+        scrubTo(event->position().toPoint().y());
+}
+
+void MinimapStrip::mouseMoveEvent(QMouseEvent *event)
+{
+    if (event->buttons() & Qt::LeftButton)
+        scrubTo(event->position().toPoint().y());
+}
+
+void MinimapStrip::scrubTo(int y)
+{
+    if (m_pageCount == 0 || height() <= 0)
+        return;
+
+    // Center the visible window on the pointer
+    const double fraction = double(y) / height() - m_viewHeight / 2.0;
+    emit scrubRequested(qBound(0.0, fraction, 1.0));
+}
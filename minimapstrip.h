@@ -0,0 +1,83 @@
+#ifndef MINIMAPSTRIP_H
+#define MINIMAPSTRIP_H
+
+#include <QWidget>
+#include <QImage>
+#include <QPixmap>
+#include <QTimer>
+#include "memoryaccounting.h"
+
+class PDFDocument;
+
+/**
+ * MinimapStrip
+ * --------------------------------------------------------
+ * Narrow whole-document overview drawn next to the vertical scrollbar.
+ *
+ * Responsibilities:
+ * - Build one tiny grayscale silhouette per page (embedded thumbnail when
+ *   present, otherwise a very-low-DPI render) into a single packed atlas
+ * - Paint the strip in one pass from that atlas, sampling pages when the
+ *   document has more pages than the strip has pixel rows
+ * - Show the visible window and turn clicks/drags into scroll requests
+ *
+ * Design notes:
+ * - Built incrementally from a zero-interval timer with a time budget per
+ *   tick, so opening a 10k-page document never blocks the UI.
+ * - No widget per page: a 10k-page atlas is ~3.5 MB of Grayscale8 (plus
+ *   its display pixmap). The pixmap is converted whole once; after that a
+ *   paint copies only the atlas rows built since the previous one.
+ */
+class MinimapStrip : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MinimapStrip(QWidget *parent = nullptr);
+
+    void setDocument(PDFDocument *document); // Non-owning; nullptr clears.
+    void setViewWindow(double topFraction, double heightFraction);
+
+    QSize sizeHint() const override { return QSize(STRIP_WIDTH, 200); }
+    qint64 atlasBytes() const { return m_atlas.sizeInBytes() + qint64(m_atlasPixmap.width()) * m_atlasPixmap.height() * m_atlasPixmap.depth() / 8; }
+
+    static constexpr int STRIP_WIDTH = 48;
+
+signals:
+    void scrubRequested(double fraction); // 0 = top of document, 1 = bottom
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private slots:
+    void buildNextPages();
+
+private:
+    QRect cellRect(int pageIndex) const; // Source rectangle inside the atlas.
+    QImage silhouette(int pageIndex) const;
+    void scrubTo(int y);
+
+    PDFDocument *m_document = nullptr;
+    QImage m_atlas; // Grayscale8, ATLAS_COLUMNS cells per row
+    QPixmap m_atlasPixmap; // Display copy of m_atlas
+    int m_pixmapPages = 0; // Built pages already copied into m_atlasPixmap
+    MemoryAccount m_account{"minimap-atlas"};
+    int m_pageCount = 0;
+    int m_builtPages = 0;
+    QTimer m_buildTimer;
+
+    double m_viewTop = 0.0;
+    double m_viewHeight = 0.0;
+
+    static constexpr int CELL_WIDTH = 16;
+    static constexpr int CELL_HEIGHT = 22;
+    static constexpr int ATLAS_COLUMNS = 64;
+    static constexpr int MIN_SLOT_HEIGHT = 3;   // Below this, pages are sampled
+    static constexpr int BUILD_BUDGET_MS = 8;   // Per timer tick
+    static constexpr int PENDING_GRAY = 200;    // Cells not built yet
+    static constexpr int GUTTER_GRAY = 90;      // Around each silhouette
+};
+
+#endif // MINIMAPSTRIP_H
@@ -88,33 +88,9 @@ void NavigationController::updateCurrentPageFromScroll()
 
     int scrollValue = m_scrollBar->value();
     int viewportHeight = m_viewport->height();
-    int viewportCenter = scrollValue + viewportHeight / 2;
 
-    int newCurrentPage = 0;
-
-    // Find page containing the vertical center of the viewport
-    for (int i = 0; i < pageCount; ++i)
-    {
-        QRect pageGeometry;
-        if (PDFPage *p = m_pageManager->pageAt(i))
-        {
-            pageGeometry = p->geometry();
-        }
-
-        if (pageGeometry.isNull())
-        {
-            continue;
-        }
-
-        int pageTop = pageGeometry.y();
-        int pageBottom = pageTop + pageGeometry.height();
-
-        if (viewportCenter >= pageTop && viewportCenter <= pageBottom)
-        {
-            newCurrentPage = i;
-            break;
-        }
-    }
+    // Page containing the vertical center of the viewport (binary search)
+    const int newCurrentPage = m_pageManager->layout().currentPage(scrollValue, viewportHeight);
 
     // Commit change only if page actually changed
     if (newCurrentPage != m_currentPage)
@@ -0,0 +1,86 @@
+#include "pagelayout.h"
+#include <algorithm>
+
+// Geometry ---------------------------------------------------------
+
+void PageLayout::setGeometry(const QVector<QSize> &pageSizes, int spacing, const QMargins &margins)
+{
+    m_sizes = pageSizes;
+    m_margins = margins;
+    m_maxWidth = 0;
+    m_tops.resize(m_sizes.size());
+
+    int top = margins.top();
+    for (int i = 0; i < m_sizes.size(); ++i)
+    {
+        m_tops[i] = top;
+        top += m_sizes[i].height() + spacing;
+        m_maxWidth = qMax(m_maxWidth, m_sizes[i].width());
+    }
+}
+
+QSize PageLayout::contentSize() const
+{
+    if (m_sizes.isEmpty())
+        return QSize();
+
+    const int bottom = m_tops.last() + m_sizes.last().height();
+    return QSize(m_maxWidth + m_margins.left() + m_margins.right(), bottom + m_margins.bottom());
+}
+
+QRect PageLayout::pageRect(int index) const
+{
+    if (index < 0 || index >= m_sizes.size())
+        return QRect();
+
+    return QRect(QPoint(m_margins.left(), m_tops[index]), m_sizes[index]);
+}
+
+// Lookup -----------------------------------------------------------
+
+int PageLayout::pageAt(int y) const
+{
+    // Last page starting at or above y
+    const auto it = std::upper_bound(m_tops.cbegin(), m_tops.cend(), y);
+    int index = int(it - m_tops.cbegin()) - 1;
+    if (index < 0)
+        return -1;
+
+    // Bottom edges are inclusive: with zero spacing the upper page wins
+    if (index > 0 && y <= m_tops[index - 1] + m_sizes[index - 1].height())
+        --index;
+
+    return y <= m_tops[index] + m_sizes[index].height() ? index : -1;
+}
+
+int PageLayout::currentPage(int scrollValue, int viewportHeight) const
+{
+    return qMax(0, pageAt(scrollValue + viewportHeight / 2));
+}
+
+QPair<int, int> PageLayout::estimatedVisibleRange(int scrollValue, int viewportHeight, int buffer,
+                                                  int averagePageHeight, int pageCount)
+{
+    const int first = qMax(0, (scrollValue / averagePageHeight) - buffer);
+    const int last = qMin(pageCount - 1, ((scrollValue + viewportHeight) / averagePageHeight) + buffer);
+    return qMakePair(first, last);
+}
+
+QPair<int, int> PageLayout::pagesBetween(int top, int bottom) const
+{
+    if (m_sizes.isEmpty() || bottom < top)
+        return qMakePair(-1, -1);
+
+    // First page whose bottom edge reaches top; last page starting at or above bottom
+    int first = int(std::upper_bound(m_tops.cbegin(), m_tops.cend(), top) - m_tops.cbegin()) - 1;
+    if (first < 0)
+        first = 0;
+    else if (m_tops[first] + m_sizes[first].height() < top)
+        ++first;
+
+    const int last = int(std::upper_bound(m_tops.cbegin(), m_tops.cend(), bottom) - m_tops.cbegin()) - 1;
+    if (first >= m_sizes.size() || last < first)
+        return qMakePair(-1, -1);
+
+    return qMakePair(first, last);
+}
@@ -0,0 +1,50 @@
+#ifndef PAGELAYOUT_H
+#define PAGELAYOUT_H
+
+#include <QMargins>
+#include <QPair>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+
+/**
+ * PageLayout
+ * --------------------------------------------------------
+ * Widget-free model of the continuous page column: the same top-aligned
+ * stack the content QVBoxLayout produces, as plain integers.
+ *
+ * Responsibilities:
+ * - Content size for the scroll area (sum of heights, widest page)
+ * - Page tops as prefix sums, so page lookup by offset is O(log n)
+ * - The visible-range heuristic used for lazy rendering
+ *
+ * Design notes:
+ * - PageManager feeds it the live widget sizes; NavigationController
+ *   queries it. Pure arithmetic so benchmarks/ can drive it without a
+ *   QApplication or a document.
+ */
+class PageLayout
+{
+public:
+    // Rebuilds the prefix sums; O(n)
+    void setGeometry(const QVector<QSize> &pageSizes, int spacing, const QMargins &margins);
+
+    int pageCount() const { return m_sizes.size(); }
+    QSize contentSize() const; // Including margins; empty when there are no pages
+    QRect pageRect(int index) const;
+
+    int pageAt(int y) const;                                 // -1 when y falls in a gap or margin
+    int currentPage(int scrollValue, int viewportHeight) const; // Page under the viewport centre, 0 if none
+    QPair<int, int> pagesBetween(int top, int bottom) const;    // Pages intersecting [top, bottom]; (-1, -1) if none
+
+    static QPair<int, int> estimatedVisibleRange(int scrollValue, int viewportHeight, int buffer,
+                                                 int averagePageHeight, int pageCount);
+
+private:
+    QVector<QSize> m_sizes;
+    QVector<int> m_tops;
+    QMargins m_margins;
+    int m_maxWidth = 0;
+};
+
+#endif // PAGELAYOUT_H
@@ -6,10 +6,13 @@
  */
 
 #include "pagemanager.h"
+#include "scrolltrace.h"
 #include <QDebug>
 
 // Construction & Destruction --------------------------------------
-PageManager::PageManager() : m_contentWidget(nullptr), m_contentLayout(nullptr), m_document(nullptr)
+PageManager::PageManager()
+    : m_contentWidget(nullptr), m_contentLayout(nullptr), m_document(nullptr),
+      m_policy(RenderPolicy::create("window"))
 {
 }
 
@@ -36,7 +39,11 @@ void PageManager::buildPages(PDFDocument *document)
     // Create container widget and layout
     createContentWidget();
 
-    // Create page widgets
+    if (m_scrollTrace)
+        m_scrollTrace->beginDocument(m_document->title(), m_document->pageCount());
+
+    // Create page widgets, keyed by the layers visible right now
+    m_renderKey = m_document->renderKey();
     int pageCount = m_document->pageCount();
     m_pageWidgets.resize(pageCount);
 
@@ -61,6 +68,7 @@ void PageManager::clear()
 {
     // QPointers auto-null when the parent widget is deleted
     m_pageWidgets.clear();
+    m_layout = PageLayout();
 
     if (m_contentWidget)
     {
@@ -110,12 +118,28 @@ void PageManager::renderVisiblePages(int scrollValue, int viewportHeight, int pr
     if (!m_document || m_pageWidgets.isEmpty())
         return;
 
-    // Compute visible range using average page height heuristic
-    int firstVisible = qMax(0, (scrollValue / AVG_PAGE_HEIGHT) - preRenderBuffer);
-    int lastVisible = qMin(m_pageWidgets.size() - 1, ((scrollValue + viewportHeight) / AVG_PAGE_HEIGHT) + preRenderBuffer);
-
-    // Render pages in visible range
-    for (int i = firstVisible; i <= lastVisible; ++i)
+    if (m_scrollTrace)
+        m_scrollTrace->record(scrollValue, viewportHeight, dpi);
+
+    // Scroll speed since the previous pass (0 after a pause: nothing to extrapolate)
+    RenderView view;
+    qint64 elapsedMs = 0;
+    if (m_scrollClock.isValid())
+        elapsedMs = m_scrollClock.restart();
+    else
+        m_scrollClock.start();
+    if (elapsedMs > 0 && elapsedMs < IDLE_SCROLL_MS)
+        view.velocity = (scrollValue - m_lastScrollValue) * 1000.0 / elapsedMs;
+    m_lastScrollValue = scrollValue;
+
+    view.scrollValue = scrollValue;
+    view.viewportHeight = viewportHeight;
+    view.window = preRenderBuffer;
+    view.pageCount = m_pageWidgets.size();
+    view.layout = &m_layout;
+
+    // Render in the policy's order (rendered pages return at once)
+    for (int i : m_policy->pagesToRender(view))
     {
         renderPageAt(i, dpi);
     }
@@ -131,31 +155,23 @@ void PageManager::updateContentGeometry()
     if (!m_contentWidget || m_pageWidgets.isEmpty())
         return;
 
-    int maxWidth = 0;
-    int totalHeight = 0;
-
-    // Find maximum width & accumulate total heights
+    // Live widget sizes feed the layout model (also used for page lookup)
+    QVector<QSize> sizes;
+    sizes.reserve(m_pageWidgets.size());
     for (const QPointer<PDFPage> &pagePointer : m_pageWidgets)
     {
         PDFPage *page = pagePointer.data();
-        if (!page)
-            continue;
-
-        maxWidth = qMax(maxWidth, page->width());
-        totalHeight += page->height();
+        sizes.append(page ? page->size() : QSize(0, 0));
     }
 
-    // Add spacing and margins
     if (m_contentLayout)
-    {
-        int spacing = m_contentLayout->spacing();
-        totalHeight += spacing * qMax(0, m_pageWidgets.size() - 1);
+        m_layout.setGeometry(sizes, m_contentLayout->spacing(), m_contentLayout->contentsMargins());
+    else
+        m_layout.setGeometry(sizes, 0, QMargins());
 
-        // Add margins
-        QMargins margins = m_contentLayout->contentsMargins();
-        maxWidth += margins.left() + margins.right();
-        totalHeight += margins.top() + margins.bottom();
-    }
+    const QSize content = m_layout.contentSize();
+    const int maxWidth = content.width();
+    const int totalHeight = content.height();
 
     // Set minimum size (+1 to avoid zero-dimension edge cases)
     if (maxWidth > 0 && totalHeight > 0)
@@ -191,6 +207,7 @@ void PageManager::addPageWidget(int pageIndex)
     // Retrieve and assign document page
     auto page = m_document->getPage(pageIndex);
     pageWidget->setPage(std::move(page), pageIndex);
+    pageWidget->setRenderCache(m_renderCache, m_renderKey);
 
     // Add to layout and store pointer
     m_contentLayout->addWidget(pageWidget);
@@ -199,6 +216,12 @@ void PageManager::addPageWidget(int pageIndex)
 
 // Convenience Methods --------------------------------------
 
+void PageManager::setRenderPolicy(std::unique_ptr<RenderPolicy> policy)
+{
+    if (policy)
+        m_policy = std::move(policy);
+}
+
 void PageManager::renderPageAt(int index, int dpi)
 {
     PDFPage *page = pageAt(index);
@@ -209,6 +232,35 @@ void PageManager::renderPageAt(int index, int dpi)
     }
 }
 
+void PageManager::invalidateRenders()
+{
+    for (const QPointer<PDFPage> &pagePointer : m_pageWidgets)
+    {
+        if (PDFPage *page = pagePointer.data())
+        {
+            page->invalidate();
+        }
+    }
+}
+
+void PageManager::refreshRenderKeys()
+{
+    if (!m_document)
+        return;
+
+    // Probes and pixmaps of earlier layer states stay cached under their
+    // own keys: toggling a layer back finds them again
+    m_renderKey = m_document->renderKey();
+    for (const QPointer<PDFPage> &pagePointer : m_pageWidgets)
+    {
+        if (PDFPage *page = pagePointer.data())
+        {
+            page->setRenderCache(m_renderCache, m_renderKey);
+            page->invalidate();
+        }
+    }
+}
+
 void PageManager::setLayoutSpacing(int spacing)
 {
     if (m_contentLayout)
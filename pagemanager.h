@@ -5,8 +5,15 @@
 #include <QVBoxLayout>
 #include <QVector>
 #include <QPointer>
+#include <QElapsedTimer>
+#include <memory>
 #include "pdfpage.h"
 #include "pdfdocument.h"
+#include "pagelayout.h"
+#include "renderpolicy.h"
+
+class RenderCache;
+class ScrollTrace;
 
 /**
  * PageManager
@@ -15,9 +22,10 @@
  *
  * Responsibilities:
  * - Create and arrange page widgets
- * - Visibility-aware (lazy) rendering strategy
+ * - Visibility-aware (lazy) rendering, ordered by a RenderPolicy
  * - Maintain overall content geometry
  * - Pre-render an initial window of pages for fast first paint
+ * - Hand the shared RenderCache to every page widget
  */
 class PageManager
 {
@@ -41,15 +49,24 @@ public:
     // Rendering Operations ------------------------------------------
     void preRenderInitialPages(int count, int dpi);
     void renderVisiblePages(int scrollValue, int viewportHeight, int preRenderBuffer, int dpi);
+    void setRenderPolicy(std::unique_ptr<RenderPolicy> policy); // Default: "window".
+    void setScrollTrace(ScrollTrace *trace) { m_scrollTrace = trace; } // Non-owning; records every pass.
+    const RenderPolicy *renderPolicy() const { return m_policy.get(); }
 
     // Geometry Maintenance ------------------------------------------
     void updateContentGeometry();
+    const PageLayout &layout() const { return m_layout; } // As of the last updateContentGeometry().
 
     // Layout Configuration ------------------------------------------
     void setLayoutSpacing(int spacing);
     void setLayoutMargins(int left, int top, int right, int bottom);
 
+    // Render Cache --------------------------------------------------
+    void setRenderCache(RenderCache *cache) { m_renderCache = cache; } // Non-owning; before buildPages().
+
     void renderPageAt(int index, int dpi);
+    void invalidateRenders(); // Mark every page stale (e.g. color profile changed).
+    void refreshRenderKeys(); // Re-key every page to the document's renderKey(), then invalidate.
 
 private:
     void createContentWidget();
@@ -58,12 +75,19 @@ private:
     // Layout defaults
     static constexpr int DEFAULT_SPACING = 20;
     static constexpr int DEFAULT_MARGINS = 50;
-    static constexpr int AVG_PAGE_HEIGHT = 600; // Heuristic for visibility calculations
+    static constexpr int IDLE_SCROLL_MS = 500; // Longer gaps between passes: speed reads as 0
 
     QWidget *m_contentWidget;
     QVBoxLayout *m_contentLayout;
     QVector<QPointer<PDFPage>> m_pageWidgets;
     PDFDocument *m_document;
+    RenderCache *m_renderCache = nullptr;
+    QByteArray m_renderKey; // Document renderKey() the pages are keyed by
+    PageLayout m_layout;
+    std::unique_ptr<RenderPolicy> m_policy;
+    ScrollTrace *m_scrollTrace = nullptr;
+    int m_lastScrollValue = 0;    // Scroll speed estimate for the policy...
+    QElapsedTimer m_scrollClock;  // ...between two renderVisiblePages() calls
 };
 
 #endif // PAGEMANAGER_H
@@ -0,0 +1,77 @@
+/**
+ * PageProbe implementation
+ * ---------------------------------------------------------------
+ * One pass over a render the caller already has, stopping at the first
+ * pixel that breaks uniformity.
+ */
+
+#include "pageprobe.h"
+
+bool PageProbe::checkRender(const QImage &render, int dpi)
+{
+    if (render.isNull() || isContent())
+    {
+        return false;
+    }
+
+    valid = true;
+    QColor color;
+    if (!isUniform(render, BLANK_TOLERANCE, &color))
+    {
+        // A mark at this DPI is a mark at every DPI
+        blankDpi = 0;
+        return false;
+    }
+
+    blankDpi = qMax(blankDpi, dpi);
+    fillColor = color;
+    return true;
+}
+
+// Blank Detection --------------------------------------------------
+// Per-channel range of the pixels seen so far; paper pixels equal to the
+// first one are skipped at once. No outliers are allowed: a small mark on
+// a scan must not be hidden.
+
+bool PageProbe::isUniform(const QImage &image, int tolerance, QColor *color)
+{
+    // Poppler renders QRgb formats already; anything else pays one conversion
+    const bool packed = image.format() == QImage::Format_ARGB32 || image.format() == QImage::Format_RGB32 ||
+                        image.format() == QImage::Format_ARGB32_Premultiplied;
+    const QImage pixels = packed ? image : image.convertToFormat(QImage::Format_ARGB32);
+    if (pixels.isNull() || pixels.width() == 0 || pixels.height() == 0)
+        return false;
+
+    const QRgb first = reinterpret_cast<const QRgb *>(pixels.constScanLine(0))[0];
+    int low[4] = {qRed(first), qGreen(first), qBlue(first), qAlpha(first)};
+    int high[4] = {low[0], low[1], low[2], low[3]};
+
+    for (int y = 0; y < pixels.height(); ++y)
+    {
+        const QRgb *line = reinterpret_cast<const QRgb *>(pixels.constScanLine(y));
+        for (int x = 0; x < pixels.width(); ++x)
+        {
+            const QRgb pixel = line[x];
+            if (pixel == first)
+                continue;
+
+            const int channels[4] = {qRed(pixel), qGreen(pixel), qBlue(pixel), qAlpha(pixel)};
+            for (int c = 0; c < 4; ++c)
+            {
+                low[c] = qMin(low[c], channels[c]);
+                high[c] = qMax(high[c], channels[c]);
+                if (high[c] - low[c] > tolerance)
+                    return false; // Real content: no need to look further
+            }
+        }
+    }
+
+    QRgb middle = qRgba((low[0] + high[0]) / 2, (low[1] + high[1]) / 2, (low[2] + high[2]) / 2,
+                        (low[3] + high[3]) / 2);
+    if (pixels.format() == QImage::Format_ARGB32_Premultiplied)
+        middle = qUnpremultiply(middle);
+    if (pixels.format() == QImage::Format_RGB32)
+        middle |= 0xff000000u; // Unused alpha byte: opaque
+    *color = QColor::fromRgba(middle);
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef PAGEPROBE_H
+#define PAGEPROBE_H
+
+#include <QColor>
+#include <QImage>
+
+/**
+ * PageProbe
+ * ---------------------------------------------------------------
+ * What the renders of ONE PDF page said about it being blank.
+ *
+ *  - checkRender() looks at a render that happened anyway (viewer, print
+ *    preview, preload): a uniform one makes the page blank at that DPI
+ *    (and below), the first off-color pixel makes it content for good.
+ *  - Later renders (revisits, zoom-outs) of a blank page are a solid fill
+ *    with no raster kept.
+ *
+ * Design notes:
+ *  - Not an identity: distinct pages may probe alike (scans, drawings).
+ *    Renders are keyed by document and page index (see RenderCache).
+ *  - No extra render and no text extraction: a content page costs a scan
+ *    up to its first mark, usually a few rows.
+ *  - Nothing is hidden on a guess: only a real render at the shown DPI,
+ *    or above it, proves a page blank.
+ */
+class PageProbe
+{
+public:
+    bool isValid() const { return valid; }
+
+    bool isBlankAt(int dpi) const { return blankDpi >= dpi; }
+    bool isContent() const { return valid && blankDpi == 0; } // Renders need no further check.
+    bool checkRender(const QImage &render, int dpi);           // True if the render is blank.
+
+    bool valid = false;   // Some render was checked.
+    int blankDpi = 0;     // Highest DPI a render was found uniform at (0: content or unknown).
+    QColor fillColor;     // Color of that render (meaningful when blankDpi > 0).
+
+    static constexpr int BLANK_TOLERANCE = 2; // Max per-channel spread (0-255): antialiasing noise only.
+
+private:
+    static bool isUniform(const QImage &image, int tolerance, QColor *color);
+};
+
+#endif // PAGEPROBE_H
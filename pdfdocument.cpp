@@ -1,8 +1,13 @@
 #include "pdfdocument.h"
+#include <QDateTime>
 #include <QFileInfo>
+#include <QFile>
+#include <QCryptographicHash>
+#include <QAbstractItemModel>
+#include <poppler-optcontent.h>
 
 PDFDocument::PDFDocument()
-    : m_document(nullptr)
+    : m_document(nullptr), m_renderQuality(ViewerConfig::instance().settings().quality)
 {
     // Simple construction; defer actual loading to loadFromFile().
 }
@@ -13,13 +18,72 @@ PDFDocument::~PDFDocument()
     close();
 }
 
-bool PDFDocument::loadFromFile(const QString &filePath)
+bool PDFDocument::loadFromFile(const QString &filePath, FileIdentity identity)
 {
     // Always start clean (idempotent if already empty).
     close();
 
     // Poppler does the parsing. If it fails we just return false silently.
     m_document = Poppler::Document::load(filePath);
+    if (!adoptLoaded())
+    {
+        return false;
+    }
+
+    m_filePath = filePath;
+    if (identity == FileIdentity::Content)
+    {
+        setContentHash(hashFile(filePath));
+    }
+    if (identity != FileIdentity::None && !m_contentHashed)
+    {
+        m_contentHash = fileIdentity(filePath);
+    }
+    return true;
+}
+
+bool PDFDocument::loadFromData(const QByteArray &data, const QString &sourceName, const QByteArray &knownHash)
+{
+    close();
+
+    // Poppler keeps (a shallow copy of) the bytes for as long as the document lives
+    m_document = Poppler::Document::loadFromData(data);
+    if (!adoptLoaded())
+    {
+        return false;
+    }
+
+    m_data = data;
+    m_sourceName = sourceName;
+    setContentHash(knownHash.isEmpty() ? QCryptographicHash::hash(data, QCryptographicHash::Sha1) : knownHash);
+    m_account.setBytes(data.capacity()); // Shared with Poppler: one allocation, counted once
+    return true;
+}
+
+bool PDFDocument::loadFromDevice(std::unique_ptr<QIODevice> device, const QByteArray &identity,
+                                 const QString &sourceName)
+{
+    close();
+
+    // Poppler reads through the device on demand; it must stay open meanwhile
+    if (!device || !device->isOpen())
+    {
+        return false;
+    }
+    m_document = Poppler::Document::load(device.get());
+    if (!adoptLoaded())
+    {
+        return false;
+    }
+
+    m_device = std::move(device);
+    m_sourceName = sourceName;
+    setContentHash(identity); // Final as is: hashing the bytes would mean reading them all
+    return true;
+}
+
+bool PDFDocument::adoptLoaded()
+{
     if (!m_document)
     {
         return false; // Corrupt / missing file / invalid format.
@@ -32,15 +96,27 @@ bool PDFDocument::loadFromFile(const QString &filePath)
         return false;
     }
 
-    m_filePath = filePath;
+    // A fresh Poppler document has no profile or hints yet: apply the requested ones.
+    applyDisplayProfile();
+    applyRenderQuality();
     return true;
 }
 
 void PDFDocument::close()
 {
-    // unique_ptr releases Poppler::Document automatically.
+    // unique_ptr releases Poppler::Document automatically (before its device).
     m_document.reset();
+    m_device.reset();
     m_filePath.clear();
+    m_sourceName.clear();
+    m_data.clear();
+    m_account.setBytes(0);
+    m_contentHash.clear();
+    m_contentHashed = false;
+    m_pageSizes.clear();
+    m_layersCreated = false;
+    m_defaultLayers.clear();
+    m_appliedProfile.clear(); // Profile preference survives, Poppler state does not.
 }
 
 bool PDFDocument::isLoaded() const
@@ -53,6 +129,11 @@ int PDFDocument::pageCount() const
     return m_document ? m_document->numPages() : 0;
 }
 
+bool PDFDocument::isLinearized() const
+{
+    return m_document && m_document->isLinearized();
+}
+
 QString PDFDocument::title() const
 {
     if (!m_document)
@@ -64,7 +145,7 @@ QString PDFDocument::title() const
     QString title = m_document->info("Title");
     if (title.isEmpty())
     {
-        title = QFileInfo(m_filePath).fileName();
+        title = m_filePath.isEmpty() ? m_sourceName : QFileInfo(m_filePath).fileName();
     }
     return title;
 }
@@ -79,6 +160,192 @@ bool PDFDocument::isLocked() const
     return m_document ? m_document->isLocked() : false;
 }
 
+bool PDFDocument::setDisplayProfile(const QString &iccPath)
+{
+    if (!iccPath.isEmpty() && !QFileInfo(iccPath).isReadable())
+    {
+        return false; // Keep the previous profile rather than silently losing color management.
+    }
+
+    m_displayProfile = iccPath;
+    applyDisplayProfile();
+    return true;
+}
+
+void PDFDocument::applyDisplayProfile()
+{
+    // Re-sending the same profile would make Poppler open and parse the ICC
+    // file again, so only forward actual changes.
+    if (!m_document || m_displayProfile == m_appliedProfile)
+    {
+        return;
+    }
+
+    // Poppler (built with LCMS) converts ICC-based and CMYK color spaces to
+    // this profile while rasterizing; no post-render pass is needed.
+    m_document->setColorDisplayProfileName(m_displayProfile);
+    m_appliedProfile = m_displayProfile;
+}
+
+void PDFDocument::setRenderQuality(RenderQuality quality)
+{
+    m_renderQuality = quality;
+    applyRenderQuality();
+}
+
+void PDFDocument::applyRenderQuality()
+{
+    if (!m_document)
+    {
+        return;
+    }
+
+    const bool smooth = m_renderQuality != RenderQuality::Draft;
+    const bool hinted = m_renderQuality == RenderQuality::High;
+    m_document->setRenderHint(Poppler::Document::Antialiasing, smooth);
+    m_document->setRenderHint(Poppler::Document::TextAntialiasing, smooth);
+    m_document->setRenderHint(Poppler::Document::TextHinting, hinted);
+    m_document->setRenderHint(Poppler::Document::TextSlightHinting, hinted);
+}
+
+// Optional Content -------------------------------------------------
+QAbstractItemModel *PDFDocument::layerModel() const
+{
+    if (!m_document || !m_document->hasOptionalContent())
+    {
+        return nullptr;
+    }
+
+    // Poppler builds the model (a QObject of the calling thread) on first
+    // request; the visibility it starts with is the default to compare to
+    QAbstractItemModel *model = m_document->optionalContentModel(); // Owned by Poppler::Document
+    if (!m_layersCreated)
+    {
+        m_layersCreated = true;
+        m_defaultLayers = layerVisibility();
+    }
+    return model;
+}
+
+QVector<QModelIndex> PDFDocument::layerIndexes() const
+{
+    QVector<QModelIndex> layers;
+    const QAbstractItemModel *model = m_layersCreated ? layerModel() : nullptr;
+    if (!model)
+    {
+        return layers;
+    }
+
+    // Depth-first over the layer tree: the same set of checks, the same bytes
+    QVector<QModelIndex> pending{QModelIndex()};
+    while (!pending.isEmpty())
+    {
+        const QModelIndex parent = pending.takeLast();
+        for (int row = model->rowCount(parent) - 1; row >= 0; --row)
+        {
+            pending.append(model->index(row, 0, parent));
+        }
+        if (parent.isValid())
+        {
+            layers.append(parent);
+        }
+    }
+    return layers;
+}
+
+QByteArray PDFDocument::layerVisibility() const
+{
+    QByteArray bits;
+    for (const QModelIndex &layer : layerIndexes())
+    {
+        bits.append(char(layer.data(Qt::CheckStateRole).toInt()));
+    }
+    return bits;
+}
+
+bool PDFDocument::setLayerVisibility(const QByteArray &bits)
+{
+    if (bits.isEmpty())
+    {
+        return true; // Defaults: no model needed
+    }
+
+    // A worker's private copy builds its model on its own thread, here
+    layerModel();
+    const QVector<QModelIndex> layers = layerIndexes();
+    if (layers.size() != bits.size())
+    {
+        return false; // Another document, or another revision of it
+    }
+
+    // Only what differs: toggling a radio-group member may switch its siblings
+    QAbstractItemModel *model = layerModel();
+    for (int i = 0; i < layers.size(); ++i)
+    {
+        if (layers[i].data(Qt::CheckStateRole).toInt() != int(bits[i]))
+        {
+            model->setData(layers[i], int(bits[i]), Qt::CheckStateRole);
+        }
+    }
+    return true;
+}
+
+QByteArray PDFDocument::layerState() const
+{
+    // Default visibility keeps plain content keys, shared with every other
+    // opener of the same file (reading queue preloads, other windows).
+    // No model yet means nobody could have toggled a layer.
+    const QByteArray bits = layerVisibility();
+    if (!m_layersCreated || bits == m_defaultLayers)
+    {
+        return QByteArray();
+    }
+    return QCryptographicHash::hash(bits, QCryptographicHash::Sha1);
+}
+
+QByteArray PDFDocument::renderKey() const
+{
+    const QByteArray state = layerState();
+    if (state.isEmpty())
+    {
+        return m_contentHash;
+    }
+    return QCryptographicHash::hash(m_contentHash + state, QCryptographicHash::Sha1);
+}
+
+void PDFDocument::setContentHash(const QByteArray &hash)
+{
+    if (hash.isEmpty() || !m_document)
+    {
+        return;
+    }
+    m_contentHash = hash;
+    m_contentHashed = true;
+}
+
+QByteArray PDFDocument::fileIdentity(const QString &filePath)
+{
+    // Another path to the same bytes gets another identity until hashed
+    const QFileInfo info(filePath);
+    const QByteArray identity = "file:" + info.absoluteFilePath().toUtf8() + '\n' + QByteArray::number(info.size()) +
+                                '\n' + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+    return QCryptographicHash::hash(identity, QCryptographicHash::Sha1);
+}
+
+QByteArray PDFDocument::hashFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QByteArray(); // No identity: caching falls back to nothing shared.
+    }
+
+    // Streams the file in blocks: no second in-memory copy of the PDF
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    return hash.result();
+}
+
 std::unique_ptr<Poppler::Page> PDFDocument::getPage(int pageIndex) const
 {
     if (!m_document || pageIndex < 0 || pageIndex >= pageCount())
@@ -87,3 +354,28 @@ std::unique_ptr<Poppler::Page> PDFDocument::getPage(int pageIndex) const
     }
     return m_document->page(pageIndex);
 }
+
+std::unique_ptr<Poppler::FontIterator> PDFDocument::fontIterator(int startPage) const
+{
+    if (!m_document)
+    {
+        return nullptr;
+    }
+    return m_document->newFontIterator(startPage);
+}
+
+const QVector<QSizeF> &PDFDocument::pageSizes() const
+{
+    // One pass over the page tree; afterwards layout questions cost nothing.
+    if (m_pageSizes.isEmpty() && m_document)
+    {
+        const int count = pageCount();
+        m_pageSizes.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            auto page = m_document->page(i);
+            m_pageSizes.append(page ? page->pageSizeF() : QSizeF());
+        }
+    }
+    return m_pageSizes;
+}
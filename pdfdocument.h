@@ -2,8 +2,16 @@
 #define PDFDOCUMENT_H
 
 #include <QString>
+#include <QIODevice>
+#include <QModelIndex>
+#include <QSizeF>
+#include <QVector>
 #include <memory>
 #include <poppler-qt6.h>
+#include "memoryaccounting.h"
+#include "viewerconfig.h"
+
+class QAbstractItemModel;
 
 /**
  * PDFDocument
@@ -11,39 +19,112 @@
  * Thin domain layer over Poppler::Document.
  *
  * Responsibilities:
- *  - Open and close PDF files (ownership via unique_ptr).
+ *  - Open and close PDF files (ownership via unique_ptr), or PDFs held in
+ *    memory (e.g. streamed from stdin) or behind a QIODevice (remote).
  *  - Expose basic metadata (title, page count, file path).
+ *  - Identify the document by content hash, so caches are shared between
+ *    copies of the same file opened under different paths. Files opened
+ *    on the GUI thread start with a provisional identity; hashing them is
+ *    the caller's job, off that thread (PDFViewer).
  *  - Provide individual pages as unique_ptr<Poppler::Page> so the caller
  *    owns each page object and controls render lifetime.
+ *  - Apply an ICC display profile so Poppler color-manages (e.g. CMYK) output.
+ *  - Map the configured RenderQuality to Poppler render hints.
+ *  - Expose optional content (layers) and identify the visible set, so
+ *    renders of each layer combination are cached apart.
  *
  * Design notes:
  *  - Does not cache pages: delegates to Poppler keeping the API minimal.
+ *  - The display profile is handed to Poppler once per (document, profile)
+ *    pair, and Poppler keeps it open. Its color transforms are built again
+ *    for every page render (the Qt frontend uses a fresh output device per
+ *    renderToImage()), out of reach of this API; PerfReport measures them.
  *  - Never throws exceptions: error signaling via booleans / nullptr.
  *  - Thread-safety: not guaranteed (mirrors Poppler Qt backend limitations).
+ *    An instance must stay on one thread: workers (search, export, diff,
+ *    reports, preloads) each open their own private PDFDocument. A document
+ *    may change threads once (preloads): the layer model is built lazily,
+ *    by the first layerModel() call, so it belongs to the thread using it.
  */
 class PDFDocument
 {
 public:
+    // How loadFromFile() identifies the content (contentHash())
+    enum class FileIdentity
+    {
+        Deferred, // Path, size and mtime now; setContentHash() once hashFile() ran elsewhere.
+        Content,  // SHA-1 of the bytes, read now (worker threads).
+        None,     // No identity at all: private copies that never meet a cache (exports, reports).
+    };
+
     PDFDocument();
     ~PDFDocument();
 
     // Lifecycle -----------------------------------------------------
-    bool loadFromFile(const QString &filePath); // Returns false on failure or locked file.
+    bool loadFromFile(const QString &filePath, FileIdentity identity = FileIdentity::Deferred); // False on failure or locked file.
+    bool loadFromData(const QByteArray &data, const QString &sourceName,
+                      const QByteArray &knownHash = QByteArray()); // Same, for an in-memory PDF; hashed unless known.
+    bool loadFromDevice(std::unique_ptr<QIODevice> device, const QByteArray &identity,
+                        const QString &sourceName); // Open random-access device (e.g. remote); takes ownership.
     void close();                               // Release resources (idempotent).
     bool isLoaded() const;                      // Fast state check.
 
     // Metadata ------------------------------------------------------
     int pageCount() const;    // 0 if not loaded.
     QString title() const;    // Uses PDF metadata; fallback: file name.
-    QString filePath() const; // Absolute current file path.
+    QString filePath() const; // Absolute current file path (empty for in-memory PDFs).
     bool isLocked() const;    // True if PDF is password protected.
+    bool isRemote() const { return m_device != nullptr; } // Bytes fetched on demand: avoid whole-document passes.
+    QIODevice *device() const { return m_device.get(); }  // Source of loadFromDevice(); nullptr otherwise.
+    QByteArray data() const { return m_data; }            // Source of loadFromData() (shared); empty otherwise.
+    bool isLinearized() const;                            // "Fast web view": pages stored in order.
+    QByteArray contentHash() const { return m_contentHash; } // SHA-1 of the bytes (provisional until hashed).
+    bool isContentHashed() const { return m_contentHashed; } // False while provisional (Deferred files).
+    void setContentHash(const QByteArray &hash); // Result of hashFile(filePath()); ignored if empty.
+    static QByteArray hashFile(const QString &filePath); // Reads the whole file: keep off the GUI thread.
+
+    // Color management ----------------------------------------------
+    bool setDisplayProfile(const QString &iccPath); // Empty path: Poppler default (sRGB).
+    QString displayProfile() const { return m_displayProfile; }
+
+    // Rasterization -------------------------------------------------
+    void setRenderQuality(RenderQuality quality); // Default: ViewerConfig's render/quality.
+    RenderQuality renderQuality() const { return m_renderQuality; }
+
+    // Optional content --------------------------------------------
+    QAbstractItemModel *layerModel() const; // Poppler's layer tree (checkable), built on first call; nullptr if none.
+    QByteArray layerState() const;          // Hash of visible layers; empty while at the defaults.
+    QByteArray layerVisibility() const;     // One byte per layer, depth-first; empty if none or no model yet.
+    bool setLayerVisibility(const QByteArray &bits); // Another instance's layerVisibility(); false if it does not fit.
+    QByteArray renderKey() const;           // contentHash, qualified by layerState when not default.
 
     // Page access ---------------------------------------------------
     std::unique_ptr<Poppler::Page> getPage(int pageIndex) const; // nullptr if out of range.
+    std::unique_ptr<Poppler::FontIterator> fontIterator(int startPage) const; // nullptr if not loaded.
+    const QVector<QSizeF> &pageSizes() const; // Points, every page; built on first call.
 
 private:
     std::unique_ptr<Poppler::Document> m_document; // Underlying Poppler document.
     QString m_filePath;                            // Source path (for title fallback).
+    QString m_sourceName;                          // Title fallback for in-memory PDFs.
+    QByteArray m_data;                             // In-memory source (shared with Poppler).
+    std::unique_ptr<QIODevice> m_device;           // Device source; outlives m_document.
+    QByteArray m_contentHash;                      // Content identity (cache key).
+    bool m_contentHashed = false;                  // m_contentHash is the SHA-1 of the bytes.
+    QString m_displayProfile;                      // Requested ICC display profile path.
+    QString m_appliedProfile;                      // Profile currently set on m_document.
+    RenderQuality m_renderQuality;                 // Applied to every Poppler document loaded.
+    mutable QVector<QSizeF> m_pageSizes;           // Page-size table (lazy, see pageSizes()).
+    MemoryAccount m_account{"documents"};          // In-memory sources only (files are paged by Poppler).
+    mutable bool m_layersCreated = false;          // layerModel() was called (Poppler built the model).
+    mutable QByteArray m_defaultLayers;            // Visibility when the model was built.
+
+    bool adoptLoaded(); // Common tail of the load functions.
+
+    void applyDisplayProfile(); // Push m_displayProfile to Poppler if it changed.
+    void applyRenderQuality();  // Push m_renderQuality as render hints.
+    QVector<QModelIndex> layerIndexes() const; // Layer tree, depth-first (the layerVisibility() order).
+    static QByteArray fileIdentity(const QString &filePath); // Path, size and mtime: no read.
 };
 
 #endif // PDFDOCUMENT_H
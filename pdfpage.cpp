@@ -7,8 +7,57 @@
  */
 
 #include "pdfpage.h"
+#include "pageprobe.h"
+#include "rendercache.h"
+#include "imagescaler.h"
 #include <QVBoxLayout>
+#include <QPainter>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QtMath>
+#include <QtConcurrent>
+
+namespace
+{
+    // Transparent sheet over the page label; scales point rectangles to its size
+    class HighlightLayer : public QWidget
+    {
+    public:
+        explicit HighlightLayer(QWidget *parent) : QWidget(parent)
+        {
+            setAttribute(Qt::WA_TransparentForMouseEvents);
+            setAttribute(Qt::WA_NoSystemBackground);
+        }
+
+        void setHighlights(const QVector<PageHighlight> &highlights, const QSizeF &pagePoints)
+        {
+            m_highlights = highlights;
+            m_pagePoints = pagePoints;
+            update();
+        }
+
+    protected:
+        void paintEvent(QPaintEvent *) override
+        {
+            if (m_pagePoints.isEmpty())
+                return;
+
+            QPainter painter(this);
+            const qreal scaleX = width() / m_pagePoints.width();
+            const qreal scaleY = height() / m_pagePoints.height();
+            for (const PageHighlight &highlight : std::as_const(m_highlights))
+            {
+                const QRectF &r = highlight.rect;
+                painter.fillRect(QRectF(r.x() * scaleX, r.y() * scaleY, r.width() * scaleX, r.height() * scaleY),
+                                 highlight.color);
+            }
+        }
+
+    private:
+        QVector<PageHighlight> m_highlights;
+        QSizeF m_pagePoints;
+    };
+}
 
 // Construction -----------------------------------------------------
 PDFPage::PDFPage(QWidget *parent)
@@ -17,6 +66,8 @@ PDFPage::PDFPage(QWidget *parent)
     // Initialize the visual container and prepare internal state.
     // We start with no page, no image, and a clean slate.
     setupUI();
+
+    connect(&m_downscaleWatcher, &QFutureWatcher<QImage>::finished, this, &PDFPage::onDownscaleFinished);
 }
 
 // UI Setup --------------------------------------------------------
@@ -51,11 +102,43 @@ void PDFPage::setPage(std::unique_ptr<Poppler::Page> page, int pageIndex)
     m_pageIndex = pageIndex;
     m_isRendered = false;
     m_lastDpi = -1;
+    m_probe = PageProbe();
+    m_downscaleDpi = -1;
 
     // Temporary loading placeholder (lazy render happens later)
     m_imageLabel->setText(QString("Loading page %1...").arg(pageIndex + 1));
 }
 
+// Highlights -------------------------------------------------------
+void PDFPage::setHighlights(const QVector<PageHighlight> &highlights)
+{
+    if (highlights.isEmpty() && !m_highlightLayer)
+    {
+        return;
+    }
+
+    if (!m_highlightLayer)
+    {
+        m_highlightLayer = new HighlightLayer(this);
+        m_highlightLayer->setGeometry(rect());
+    }
+
+    static_cast<HighlightLayer *>(m_highlightLayer)->setHighlights(highlights, m_page ? m_page->pageSizeF() : QSizeF());
+    m_highlightLayer->setVisible(!highlights.isEmpty());
+    m_highlightLayer->raise();
+}
+
+void PDFPage::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+
+    // Follows every zoom: highlights are stored in points
+    if (m_highlightLayer)
+    {
+        m_highlightLayer->setGeometry(rect());
+    }
+}
+
 // Rendering --------------------------------------------------------
 void PDFPage::render(int dpi)
 {
@@ -72,28 +155,111 @@ void PDFPage::render(int dpi)
         return;
     }
 
-    qDebug() << "PDFPage::render - Rendering page" << m_pageIndex << "at DPI" << dpi;
+    // Blank separators, once a render showed them blank, never reach renderToImage again
+    const PageProbe &probe = knownProbe();
+    if (probe.isBlankAt(dpi))
+    {
+        qDebug() << "PDFPage::render - Page" << m_pageIndex << "is blank, drawing solid fill";
+        showSolidFill(probe.fillColor, dpi);
+        return;
+    }
+
+    // Rendered before (by this page, a preload or another opener of the same content)
+    if (m_renderCache)
+    {
+        QPixmap cached = m_renderCache->find(m_documentKey, m_pageIndex, dpi);
+        if (!cached.isNull())
+        {
+            qDebug() << "PDFPage::render - Page" << m_pageIndex << "served from render cache at DPI" << dpi;
+            showPixmap(cached, dpi);
+            return;
+        }
+    }
+
+    // Render at the ladder step, so neighbouring zoom levels share it
+    const int sourceDpi = m_renderCache ? RenderCache::ladderDpi(dpi) : dpi;
+    QPixmap source = sourceDpi != dpi ? m_renderCache->find(m_documentKey, m_pageIndex, sourceDpi) : QPixmap();
+    QImage image;
+
+    if (source.isNull())
+    {
+        qDebug() << "PDFPage::render - Rendering page" << m_pageIndex << "at DPI" << sourceDpi;
+
+        // Render page to an QImage (timed, so color-management cost is measurable)
+        QElapsedTimer renderTimer;
+        renderTimer.start();
+        image = m_page->renderToImage(sourceDpi, sourceDpi);
+        const qint64 renderMs = renderTimer.elapsed();
+
+        if (image.isNull())
+        {
+            qDebug() << "PDFPage::render - Failed to render page" << m_pageIndex;
+            m_imageLabel->setText(QString("Failed to render page %1").arg(m_pageIndex + 1));
+            return;
+        }
+
+        qDebug() << "PDFPage::render - Successfully rendered page" << m_pageIndex
+                 << "size:" << image.size() << "in" << renderMs << "ms";
 
-    // Render page to an QImage
-    QImage image = m_page->renderToImage(dpi, dpi);
+        // This render decides, for later renders: the first mark ends the check
+        if (!m_probe.isContent())
+        {
+            const bool blank = m_probe.checkRender(image, sourceDpi);
+            if (m_renderCache)
+            {
+                m_renderCache->setPageProbe(m_documentKey, m_pageIndex, m_probe);
+            }
+            if (blank)
+            {
+                qDebug() << "PDFPage::render - Page" << m_pageIndex << "confirmed blank, drawing solid fill";
+                showSolidFill(m_probe.fillColor, dpi);
+                return;
+            }
+        }
 
-    if (image.isNull())
+        // Create an image display (QPixmap) from an image
+        source = QPixmap::fromImage(image);
+        if (m_renderCache)
+        {
+            m_renderCache->insert(m_documentKey, m_pageIndex, sourceDpi, source, image); // Also offered to other processes
+        }
+    }
+
+    if (sourceDpi == dpi)
     {
-        qDebug() << "PDFPage::render - Failed to render page" << m_pageIndex;
-        m_imageLabel->setText(QString("Failed to render page %1").arg(m_pageIndex + 1));
+        showPixmap(source, dpi);
         return;
     }
 
-    qDebug() << "PDFPage::render - Successfully rendered page" << m_pageIndex
-             << "size:" << image.size();
+    // Show the step render scaled by the label now; the sharp copy follows
+    const double ratio = double(dpi) / sourceDpi;
+    const QSize target(qMax(1, qRound(source.width() * ratio)), qMax(1, qRound(source.height() * ratio)));
+    showPixmap(source, dpi, target);
+    startDownscale(image.isNull() ? source.toImage() : image, target, dpi);
+}
 
-    // Create an image display (QPixmap) from an image
-    QPixmap pixmap = QPixmap::fromImage(image);
+// Presentation -----------------------------------------------------
+void PDFPage::showPixmap(const QPixmap &pixmap, int dpi, const QSize &displaySize)
+{
     m_imageLabel->setPixmap(pixmap);
+    m_pixmapAccount.setBytes(qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8);
+
+    // Undo any fixed size left from a solid fill (or an interim scaled render)
+    // so adjustSize() can work
+    m_imageLabel->setScaledContents(false);
+    m_imageLabel->setMinimumSize(0, 0);
+    m_imageLabel->setMaximumSize(QWIDGETSIZE_MAX, QWIDGETSIZE_MAX);
 
     // Adjust the QLabel's size to the QPixmap's one via sizeHint()
     m_imageLabel->adjustSize();
 
+    // Interim ladder render: the label scales it down to the target size
+    if (displaySize.isValid() && displaySize != pixmap.size())
+    {
+        m_imageLabel->setScaledContents(true);
+        m_imageLabel->setFixedSize(m_imageLabel->size() - pixmap.size() + displaySize);
+    }
+
     // Ensure container (PDFPage) adopts image size to avoid thin stripes
     // The PDFPage own size has changed...
     setFixedSize(m_imageLabel->size());
@@ -118,6 +284,94 @@ void PDFPage::render(int dpi)
     m_lastDpi = dpi;
 }
 
+void PDFPage::showSolidFill(const QColor &color, int dpi)
+{
+    // Same pixel size renderToImage() would produce, but only a stylesheet fill
+    const QSizeF points = m_page->pageSizeF();
+    const QSize size(qCeil(points.width() * dpi / 72.0), qCeil(points.height() * dpi / 72.0));
+
+    m_imageLabel->clear();
+    m_pixmapAccount.setBytes(0);
+    m_imageLabel->setStyleSheet(QString("background: %1; border: 1px solid lightgray;").arg(color.name()));
+    m_imageLabel->setFixedSize(size);
+    setFixedSize(size);
+    updateGeometry();
+
+    if (QLayout *layout = this->layout())
+    {
+        layout->activate();
+    }
+
+    m_isRendered = true;
+    m_lastDpi = dpi;
+}
+
+// Downscaling ------------------------------------------------------
+void PDFPage::startDownscale(const QImage &source, const QSize &target, int dpi)
+{
+    // A newer request replaces the pending one; its result is never delivered
+    m_downscaleKey = m_documentKey;
+    m_downscaleContext = m_renderCache ? m_renderCache->context() : QByteArray();
+    m_downscaleDpi = dpi;
+    m_downscaleWatcher.setFuture(QtConcurrent::run(&ImageScaler::areaDownscale, source, target));
+}
+
+void PDFPage::onDownscaleFinished()
+{
+    // Discarded by invalidate()/setPage(): the colors or the page may differ now
+    if (m_downscaleDpi < 0 || m_downscaleWatcher.isCanceled())
+    {
+        return;
+    }
+
+    const QImage scaled = m_downscaleWatcher.result();
+    const int dpi = m_downscaleDpi;
+    m_downscaleDpi = -1;
+    if (scaled.isNull())
+    {
+        return;
+    }
+
+    QPixmap pixmap = QPixmap::fromImage(scaled);
+    if (m_renderCache && m_renderCache->context() == m_downscaleContext)
+    {
+        m_renderCache->insert(m_downscaleKey, m_pageIndex, dpi, pixmap);
+    }
+
+    // Swap in only if the page still shows that zoom level
+    if (m_isRendered && m_lastDpi == dpi)
+    {
+        showPixmap(pixmap, dpi);
+    }
+}
+
+// Render Cache -----------------------------------------------------
+void PDFPage::setRenderCache(RenderCache *cache, const QByteArray &documentKey)
+{
+    m_renderCache = cache;
+    m_documentKey = documentKey;
+    m_probe = PageProbe();
+}
+
+const PageProbe &PDFPage::knownProbe()
+{
+    // Checked by an earlier render (a preload, the preview, another opener)?
+    if (!m_probe.isValid() && m_renderCache)
+    {
+        m_probe = m_renderCache->pageProbe(m_documentKey, m_pageIndex);
+    }
+    return m_probe;
+}
+
+// Invalidation -----------------------------------------------------
+void PDFPage::invalidate()
+{
+    // Keep the current pixmap on screen until the next render replaces it
+    m_isRendered = false;
+    m_lastDpi = -1;
+    m_downscaleDpi = -1;
+}
+
 // Page Logical Size Query -----------------------------------------
 QSize PDFPage::pageSize() const
 {
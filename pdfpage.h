@@ -5,8 +5,27 @@
 #include <QLabel>
 #include <QPixmap>
 #include <QString>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QColor>
+#include <QRectF>
+#include <QVector>
 #include <memory>
 #include <poppler-qt6.h>
+#include "pageprobe.h"
+#include "memoryaccounting.h"
+
+class RenderCache;
+
+/**
+ * PageHighlight
+ * Rectangle in page points (Poppler text box coordinates) tinted over the render.
+ */
+struct PageHighlight
+{
+    QRectF rect;
+    QColor color; // Use a translucent color: the text must stay readable.
+};
 
 /**
  * PDFPage
@@ -17,6 +36,15 @@
  *  - Lazy rendering: only happens when render() is called.
  *  - After rendering we set isRendered() to avoid duplicate work.
  *  - Can be invalidated by calling setPage() again (e.g. after zoom).
+ *  - With a RenderCache attached, renders outlive the widget (and serve
+ *    any other opener of the same content).
+ *  - Blank pages are shown as a solid fill once one render at the shown
+ *    DPI (or above) found them uniform: no raster buffer kept.
+ *  - Optional highlights (e.g. text differences) are painted by a child
+ *    layer above the label, so renders and the cache stay untouched.
+ *  - With a cache, renders happen at DPI ladder steps: a step above the
+ *    target is shown scaled at once, then replaced by an area-averaged
+ *    copy produced on a worker thread (and cached at the target DPI).
  *
  * Design notes:
  *  - Owns Poppler::Page via unique_ptr.
@@ -33,20 +61,40 @@ public:
     // Assign underlying page data (resets render state).
     void setPage(std::unique_ptr<Poppler::Page> page, int pageIndex);
     void render(int dpi = 150); // No-op if already rendered.
+    void invalidate();          // Force the next render() to rasterize again.
+    void setRenderCache(RenderCache *cache, const QByteArray &documentKey); // Non-owning; key: renderKey().
+    void setHighlights(const QVector<PageHighlight> &highlights); // Empty clears.
 
     // Quick metadata.
     int pageIndex() const { return m_pageIndex; }
     bool isRendered() const { return m_isRendered; }
     QSize pageSize() const; // Logical (pt) size from Poppler.
 
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+
 private:
     QLabel *m_imageLabel;                  // Presentation surface.
     std::unique_ptr<Poppler::Page> m_page; // Underlying page data.
     int m_pageIndex;                       // Index inside document.
     bool m_isRendered;                     // Render cache flag.
     int m_lastDpi = -1;                    // Last DPI used to render (for zoom re-render)
+    RenderCache *m_renderCache = nullptr;  // Shared render cache (non-owning, optional).
+    QByteArray m_documentKey;              // renderKey() of the owning document.
+    PageProbe m_probe;                     // What earlier renders said (blank at some DPI, or content).
+    MemoryAccount m_pixmapAccount{"page-pixmaps"}; // Displayed pixmap (may be shared with the cache).
+    QFutureWatcher<QImage> m_downscaleWatcher; // Worker downscale of a ladder render.
+    QByteArray m_downscaleKey;                 // Document key of the pending downscale...
+    QByteArray m_downscaleContext;             // ...the cache context it was started in...
+    int m_downscaleDpi = -1;                   // ...and its target DPI (-1: none / discarded).
+    QWidget *m_highlightLayer = nullptr;       // Created on first setHighlights().
 
     void setupUI(); // Initialize layout & styling.
+    void showPixmap(const QPixmap &pixmap, int dpi, const QSize &displaySize = QSize()); // Display + adopt size.
+    void startDownscale(const QImage &source, const QSize &target, int dpi);
+    void onDownscaleFinished();
+    void showSolidFill(const QColor &color, int dpi); // Blank page, no pixmap.
+    const PageProbe &knownProbe();                   // Own or cached; never renders.
 };
 
 #endif // PDFPAGE_H
@@ -9,12 +9,17 @@
 
 #include "pdfviewer.h"
 #include <QKeyEvent>
+#include <QWheelEvent>
 #include <QScrollBar>
 #include <QResizeEvent>
 #include <QShortcut>
 #include <QKeySequence>
+#include <QFileInfo>
+#include <QDebug>
+#include <QAbstractItemModel>
+#include <QtConcurrent>
 
-PDFViewer::PDFViewer(QWidget *parent) : QScrollArea(parent), m_pageManager(nullptr), m_zoomController(nullptr), m_navigationController(nullptr)
+PDFViewer::PDFViewer(QWidget *parent) : QScrollArea(parent), m_pageManager(nullptr), m_zoomController(nullptr), m_navigationController(nullptr), m_minimap(nullptr), m_latencyMonitor(nullptr)
 {
     setupUI();
 }
@@ -26,9 +31,33 @@ void PDFViewer::setupUI()
     setFocusPolicy(Qt::StrongFocus);
 
     // Create collaborating components
+    m_settings = ViewerConfig::instance().settings();
+    m_renderCache = std::make_unique<RenderCache>(m_settings.renderCacheBytes);
+    updateRenderContext();
     m_pageManager = new PageManager();
+    m_pageManager->setRenderCache(m_renderCache.get());
+    m_pageManager->setRenderPolicy(RenderPolicy::create(m_settings.renderPolicy));
+
+    // Replayable by benchmarks/schedsim to compare render policies offline
+    const QString tracePath = qEnvironmentVariable("PDV_SCROLL_TRACE");
+    if (!tracePath.isEmpty())
+    {
+        m_scrollTrace = std::make_unique<ScrollTrace>();
+        if (m_scrollTrace->open(tracePath))
+            m_pageManager->setScrollTrace(m_scrollTrace.get());
+        else
+            qWarning() << "PDFViewer: Cannot write scroll trace" << tracePath;
+    }
     m_zoomController = new ZoomController();
     m_navigationController = new NavigationController(this);
+    m_latencyMonitor = new LatencyMonitor(this);
+
+    // Minimap strip between the viewport and the vertical scrollbar
+    m_minimap = new MinimapStrip(this);
+    setViewportMargins(0, 0, MinimapStrip::STRIP_WIDTH, 0);
+    connect(m_minimap, &MinimapStrip::scrubRequested, this, &PDFViewer::scrubTo);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &PDFViewer::updateMinimapWindow);
+    connect(verticalScrollBar(), &QScrollBar::rangeChanged, this, &PDFViewer::updateMinimapWindow);
 
     // Wire zoom + navigation related signals
     setupZoomController();
@@ -42,9 +71,40 @@ void PDFViewer::setupUI()
 
     // React to vertical scroll changes
     connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &PDFViewer::renderVisiblePages);
+    connect(horizontalScrollBar(), &QScrollBar::valueChanged, this, &PDFViewer::updateFormOverlay);
+
+    // Direct scrollbar use (drag, arrows, track clicks) is an input of its own
+    connect(verticalScrollBar(), &QScrollBar::actionTriggered, this, [this]()
+            {
+                if (!m_handlingInput)
+                    m_latencyMonitor->inputArrived(LatencyMonitor::Interaction::ScrollBar); });
+
+    // An input's frame is the first one after the view actually moved
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, m_latencyMonitor, &LatencyMonitor::viewChanged);
+    connect(horizontalScrollBar(), &QScrollBar::valueChanged, m_latencyMonitor, &LatencyMonitor::viewChanged);
+    connect(this, &PDFViewer::zoomChanged, m_latencyMonitor, &LatencyMonitor::viewChanged);
 
     // Propagate navigation events outward
     connect(m_navigationController, &NavigationController::currentPageChanged, this, &PDFViewer::currentPageChanged);
+
+    // Speculative prefetch fires only once input has been idle for a moment
+    m_prefetchTimer.setSingleShot(true);
+    m_prefetchTimer.setInterval(m_settings.prefetchDelayMs);
+    connect(&m_prefetchTimer, &QTimer::timeout, this, [this]()
+            {
+                if (hasDocument() && m_pageManager)
+                {
+                    renderPageAt(m_prefetchTarget, renderDpi());
+                } });
+
+    // Layer checkboxes toggled in one go (e.g. a parent group) re-key once
+    m_layerTimer.setSingleShot(true);
+    m_layerTimer.setInterval(0);
+    connect(&m_layerTimer, &QTimer::timeout, this, &PDFViewer::onLayersChanged);
+    connect(&m_hashWatcher, &QFutureWatcherBase::finished, this, &PDFViewer::onContentHashed);
+
+    // Tuning edits apply to the open document, no reopen needed
+    connect(&ViewerConfig::instance(), &ViewerConfig::changed, this, &PDFViewer::applySettings);
 }
 
 bool PDFViewer::setDocument(std::unique_ptr<PDFDocument> document)
@@ -56,6 +116,8 @@ bool PDFViewer::setDocument(std::unique_ptr<PDFDocument> document)
 
     clearDocument();
     m_document = std::move(document);
+    m_document->setDisplayProfile(m_displayProfile);
+    m_document->setRenderQuality(m_settings.quality);
 
     // Build page widgets via PageManager
     m_pageManager->buildPages(m_document.get());
@@ -63,10 +125,25 @@ bool PDFViewer::setDocument(std::unique_ptr<PDFDocument> document)
     {
         setWidget(m_pageManager->contentWidget());
     }
+    m_formOverlay = std::make_unique<FormFieldOverlay>(m_document.get(), m_pageManager);
+    m_minimap->setDocument(m_document.get());
+
+    // The model lives (and dies) with the Poppler document
+    if (QAbstractItemModel *layers = m_document->layerModel())
+    {
+        connect(layers, &QAbstractItemModel::dataChanged, &m_layerTimer, qOverload<>(&QTimer::start));
+    }
+
+    // Pages show under the provisional identity; the file is read for its
+    // real one meanwhile, so caches meet other openers of the same bytes
+    if (!m_document->isContentHashed() && !m_document->filePath().isEmpty())
+    {
+        m_hashWatcher.setFuture(QtConcurrent::run(&PDFDocument::hashFile, m_document->filePath()));
+    }
 
     // Pre-render first N pages at initial DPI
-    int initialDPI = int(DEFAULT_DPI * m_zoomController->currentZoom());
-    m_pageManager->preRenderInitialPages(5, initialDPI);
+    int initialDPI = renderDpi();
+    m_pageManager->preRenderInitialPages(m_settings.initialPages, initialDPI);
 
     // Pass current DPI to navigation (for targeted prerendering)
     m_navigationController->setRenderDPI(initialDPI);
@@ -79,6 +156,14 @@ bool PDFViewer::setDocument(std::unique_ptr<PDFDocument> document)
 
 void PDFViewer::clearDocument()
 {
+    m_prefetchTimer.stop();
+    m_layerTimer.stop();
+    m_hashWatcher.setFuture(QFuture<QByteArray>()); // A late result belongs to the old document
+
+    // Editors are children of the content widget released below
+    m_formOverlay.reset();
+    m_minimap->setDocument(nullptr);
+
     if (QWidget *w = takeWidget())
     {
         w->deleteLater();
@@ -102,6 +187,19 @@ void PDFViewer::goToPage(int pageIndex)
     }
 }
 
+void PDFViewer::prefetchPage(int pageIndex)
+{
+    if (!hasDocument() || pageIndex < 0 || pageIndex >= m_document->pageCount())
+    {
+        m_prefetchTimer.stop();
+        return;
+    }
+
+    // Restart the delay: only the candidate the user settles on gets rendered
+    m_prefetchTarget = pageIndex;
+    m_prefetchTimer.start();
+}
+
 int PDFViewer::currentPage() const
 {
     return m_navigationController ? m_navigationController->currentPage() : 0;
@@ -140,6 +238,46 @@ void PDFViewer::zoomFitPage()
     }
 }
 
+bool PDFViewer::setDisplayProfile(const QString &iccPath)
+{
+    if (!iccPath.isEmpty() && !QFileInfo(iccPath).isReadable())
+    {
+        return false;
+    }
+    m_displayProfile = iccPath;
+
+    if (m_document)
+    {
+        m_document->setDisplayProfile(m_displayProfile);
+    }
+
+    // Colors of already rendered pages are now stale (cached ones are keyed apart)
+    updateRenderContext();
+    if (m_pageManager && m_document)
+    {
+        m_pageManager->invalidateRenders();
+        renderVisiblePages();
+    }
+    return true;
+}
+
+void PDFViewer::setHighlights(const QHash<int, QVector<PageHighlight>> &highlights)
+{
+    if (!m_pageManager)
+    {
+        return;
+    }
+
+    // Every page: clearing must reach pages highlighted before
+    for (int i = 0; i < m_pageManager->pageCount(); ++i)
+    {
+        if (PDFPage *page = m_pageManager->pageAt(i))
+        {
+            page->setHighlights(highlights.value(i));
+        }
+    }
+}
+
 bool PDFViewer::isFitWidth() const
 {
     return m_zoomController && m_zoomController->currentMode() == ZoomMode::FitWidth;
@@ -166,41 +304,77 @@ void PDFViewer::keyPressEvent(QKeyEvent *event)
         const int k = event->key();
         if (k == Qt::Key_Plus || k == Qt::Key_Equal)
         {
+            const qint64 start = m_latencyMonitor->timestamp();
             if (m_zoomController)
                 m_zoomController->zoomIn();
+            m_latencyMonitor->inputArrived(LatencyMonitor::Interaction::KeyZoom, start);
             event->accept();
             return;
         }
         if (k == Qt::Key_Minus || k == Qt::Key_Underscore)
         {
+            const qint64 start = m_latencyMonitor->timestamp();
             if (m_zoomController)
                 m_zoomController->zoomOut();
+            m_latencyMonitor->inputArrived(LatencyMonitor::Interaction::KeyZoom, start);
             event->accept();
             return;
         }
         if (k == Qt::Key_0)
         {
+            const qint64 start = m_latencyMonitor->timestamp();
             if (m_zoomController)
                 m_zoomController->resetZoom();
+            m_latencyMonitor->inputArrived(LatencyMonitor::Interaction::KeyZoom, start);
             event->accept();
             return;
         }
     }
 
+    // Timed from here, but only reported if someone handled the key
+    const qint64 start = m_latencyMonitor->timestamp();
+    m_handlingInput = true;
+
     // Delegate navigation keys to NavigationController
     if (m_navigationController && m_navigationController->handleKeyPress(event))
     {
+        m_handlingInput = false;
+        m_latencyMonitor->inputArrived(LatencyMonitor::Interaction::KeyNavigation, start);
         return; // Evento manejado
     }
 
-    // Fallback: let base class handle
+    // Fallback: let base class handle (it ignores keys it has no use for)
     QScrollArea::keyPressEvent(event);
+    m_handlingInput = false;
+    if (event->isAccepted())
+    {
+        m_latencyMonitor->inputArrived(LatencyMonitor::Interaction::KeyNavigation, start);
+    }
+}
+
+void PDFViewer::wheelEvent(QWheelEvent *event)
+{
+    const qint64 start = m_latencyMonitor->timestamp();
+    m_handlingInput = true;
+    QScrollArea::wheelEvent(event);
+    m_handlingInput = false;
+
+    // Ignored when the scrollbar had nowhere to go
+    if (hasDocument() && event->isAccepted())
+    {
+        m_latencyMonitor->inputArrived(LatencyMonitor::Interaction::Wheel, start);
+    }
 }
 
 void PDFViewer::resizeEvent(QResizeEvent *event)
 {
     QScrollArea::resizeEvent(event);
 
+    // Keep the minimap glued to the right edge of the viewport
+    const QRect viewportRect = viewport()->geometry();
+    m_minimap->setGeometry(viewportRect.right() + 1, viewportRect.top(),
+                           MinimapStrip::STRIP_WIDTH, viewportRect.height());
+
     // Notify ZoomController so auto-fit modes can recalculate
     if (m_zoomController)
     {
@@ -217,10 +391,10 @@ void PDFViewer::renderVisiblePages()
     {
         int scrollValue = verticalScrollBar()->value();
         int viewportHeight = viewport()->height();
-        int dpi = int(DEFAULT_DPI * zoom());
+        int dpi = renderDpi();
 
         m_pageManager->renderVisiblePages(scrollValue, viewportHeight,
-                                          PRERENDER_PAGES, dpi);
+                                          m_settings.prefetchWindow, dpi);
     }
 
     // Update current page based on scroll position
@@ -228,16 +402,118 @@ void PDFViewer::renderVisiblePages()
     {
         m_navigationController->updateCurrentPageFromScroll();
     }
+
+    updateFormOverlay();
+}
+
+void PDFViewer::onLayersChanged()
+{
+    if (!hasDocument() || !m_pageManager)
+    {
+        return;
+    }
+
+    // Pages keyed by the new layer state: a state seen before renders from cache
+    m_pageManager->refreshRenderKeys();
+    renderVisiblePages();
+}
+
+void PDFViewer::onContentHashed()
+{
+    if (!hasDocument() || m_document->isContentHashed() || m_hashWatcher.future().resultCount() == 0)
+    {
+        return;
+    }
+
+    // Renders made meanwhile move to the real key instead of being redone
+    const QByteArray provisionalKey = m_document->renderKey();
+    m_document->setContentHash(m_hashWatcher.result());
+    m_renderCache->renameDocument(provisionalKey, m_document->renderKey());
+    m_pageManager->refreshRenderKeys();
+    renderVisiblePages();
+}
+
+void PDFViewer::updateFormOverlay()
+{
+    if (!m_formOverlay || !widget())
+        return;
+
+    // Pages just rendered may have pending geometry: settle it first
+    if (m_pageManager->contentLayout())
+    {
+        m_pageManager->contentLayout()->activate();
+    }
+
+    // The scroll area moves the content widget: its negated position is the view origin
+    const QRect visibleContent(-widget()->pos(), viewport()->size());
+    m_formOverlay->updateVisible(visibleContent);
+}
+
+void PDFViewer::updateMinimapWindow()
+{
+    const QScrollBar *bar = verticalScrollBar();
+    const double total = bar->maximum() + bar->pageStep();
+    if (total <= 0)
+        return;
+
+    m_minimap->setViewWindow(bar->value() / total, bar->pageStep() / total);
+}
+
+void PDFViewer::scrubTo(double fraction)
+{
+    m_latencyMonitor->inputArrived(LatencyMonitor::Interaction::Minimap);
+
+    QScrollBar *bar = verticalScrollBar();
+    bar->setValue(int(fraction * (bar->maximum() + bar->pageStep())));
+}
+
+void PDFViewer::applySettings(const ViewerSettings &settings)
+{
+    const ViewerSettings previous = m_settings;
+    m_settings = settings;
+
+    m_prefetchTimer.setInterval(m_settings.prefetchDelayMs);
+    m_renderCache->setBudget(m_settings.renderCacheBytes);
+    if (m_settings.renderPolicy != previous.renderPolicy)
+    {
+        m_pageManager->setRenderPolicy(RenderPolicy::create(m_settings.renderPolicy));
+    }
+    updateRenderContext();
+    m_zoomController->setLimits(m_settings.minZoom, m_settings.maxZoom); // Re-renders if the zoom was clamped
+
+    if (!hasDocument())
+    {
+        return;
+    }
+
+    // Pixels rendered with other hints are stale, like after a profile change
+    if (m_settings.quality != previous.quality)
+    {
+        m_document->setRenderQuality(m_settings.quality);
+        m_pageManager->invalidateRenders();
+    }
+
+    // New base DPI / ladder / window: visible pages follow at once
+    m_navigationController->setRenderDPI(renderDpi());
+    renderVisiblePages();
 }
 
 // Private Helpers -------------------------------------------------
 
+void PDFViewer::updateRenderContext()
+{
+    // Renders with other hints or another profile keep apart, here and in other processes
+    const QByteArray context = QByteArray::number(int(m_settings.quality)) + '|' + m_displayProfile.toUtf8();
+    m_renderCache->setContext(context);
+    m_renderCache->setSharedTier(m_settings.sharedCacheName, m_settings.sharedCacheBytes);
+}
+
 void PDFViewer::setupZoomController()
 {
     // Setup ZoomController connections
     if (m_zoomController)
     {
-        m_zoomController->setLimits(MIN_ZOOM, MAX_ZOOM);
+        m_zoomController->setLimits(m_settings.minZoom, m_settings.maxZoom);
 
         // On zoom change: update DPI & rerender visible pages
         connect(m_zoomController, &ZoomController::zoomChanged, this, [this](double factor, ZoomMode mode)
@@ -245,7 +521,7 @@ void PDFViewer::setupZoomController()
                 // Actualizar DPI de navegación
                 if (m_navigationController)
                 {
-                    m_navigationController->setRenderDPI(int(DEFAULT_DPI * factor));
+                    m_navigationController->setRenderDPI(int(m_settings.renderDpi * factor));
                 }
 
                 // Re-renderizar páginas visibles con nuevo DPI
@@ -253,8 +529,9 @@ void PDFViewer::setupZoomController()
                 {
                     int scrollValue = verticalScrollBar()->value();
                     int viewportHeight = viewport()->height();
-                    int dpi = int(DEFAULT_DPI * factor);
-                    m_pageManager->renderVisiblePages(scrollValue, viewportHeight, PRERENDER_PAGES, dpi);
+                    int dpi = int(m_settings.renderDpi * factor);
+                    m_pageManager->renderVisiblePages(scrollValue, viewportHeight, m_settings.prefetchWindow, dpi);
+                    updateFormOverlay();
             }
             
             emit zoomChanged(factor); });
@@ -1,12 +1,21 @@
 #ifndef PDFVIEWER_H
 #define PDFVIEWER_H
 
+#include <QFutureWatcher>
+#include <QHash>
 #include <QScrollArea>
+#include <QTimer>
 #include <memory>
 #include "pdfdocument.h"
 #include "pagemanager.h"
 #include "zoomcontroller.h"
 #include "navigationcontroller.h"
+#include "rendercache.h"
+#include "scrolltrace.h"
+#include "formfieldoverlay.h"
+#include "minimapstrip.h"
+#include "latencymonitor.h"
+#include "viewerconfig.h"
 
 /**
  * PDFViewer
@@ -18,6 +27,10 @@
  *  - PageManager: Creates, owns and schedules page widgets (lazy rendering)
  *  - ZoomController: Maintains zoom state and auto-fit calculations
  *  - NavigationController: Keyboard/page navigation and current page tracking
+ *  - RenderCache: Content-keyed renders that outlive the open document
+ *  - FormFieldOverlay: Form editors materialized only inside the viewport
+ *  - MinimapStrip: Whole-document overview beside the vertical scrollbar
+ *  - LatencyMonitor: Input-to-photon timing per interaction type
  *  - PDFViewer: Wires everything together and handles UI events (scroll, resize, keys)
  */
 class PDFViewer : public QScrollArea
@@ -32,14 +45,17 @@ public:
     void clearDocument();
     PDFDocument *document() const { return m_document.get(); }
     bool hasDocument() const { return m_document && m_document->isLoaded(); }
+    RenderCache *renderCache() const { return m_renderCache.get(); }
 
     // Navigation ----------------------------------------------------
     void goToPage(int pageIndex);
     int currentPage() const;
+    void prefetchPage(int pageIndex); // Low priority: rendered once input settles.
 
     // Zoom ----------------------------------------------------------
     void setZoom(double factor);
     double zoom() const;
+    int renderDpi() const { return int(m_settings.renderDpi * zoom()); } // DPI pages are rendered at now.
     void zoomIn() { setZoom(zoom() * 1.1); }
     void zoomOut() { setZoom(zoom() / 1.1); }
     void zoomReset() { setZoom(1.0); }
@@ -49,8 +65,16 @@ public:
     bool isFitWidth() const;
     bool isFitPage() const;
 
+    // Color management ----------------------------------------------
+    bool setDisplayProfile(const QString &iccPath); // Applied to current and future documents.
+    QString displayProfile() const { return m_displayProfile; }
+
+    // Annotation ----------------------------------------------------
+    void setHighlights(const QHash<int, QVector<PageHighlight>> &highlights); // Page index -> highlights; empty clears.
+
     // Utilities -----------------------------------------------------
     QString extractAllText() const;
+    LatencyMonitor *latencyMonitor() const { return m_latencyMonitor; }
 
 signals:
     void currentPageChanged(int pageIndex);
@@ -58,10 +82,17 @@ signals:
 
 protected:
     void keyPressEvent(QKeyEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
 
 private slots:
     void renderVisiblePages();
+    void updateFormOverlay();
+    void updateMinimapWindow();
+    void scrubTo(double fraction);
+    void applySettings(const ViewerSettings &settings); // ViewerConfig reloaded
+    void onLayersChanged(); // Optional content visibility toggled
+    void onContentHashed(); // Background hash of the open file finished
 
 private:
     void setupUI();
@@ -72,6 +103,7 @@ private:
 
     void renderPageAt(int i, int dpi);
     void moveScrollBarTo(int i);
+    void updateRenderContext(); // Cache context = hints + display profile; (re)attach the shared tier
 
     // Helpers passed to ZoomController for auto-fit calculations
     ViewportInfo getViewportInfo() const;
@@ -82,12 +114,26 @@ private:
     PageManager *m_pageManager;
     ZoomController *m_zoomController;
     NavigationController *m_navigationController;
-
-    // Config constants
-    static constexpr int DEFAULT_DPI = 200;
-    static constexpr int PRERENDER_PAGES = 2;
-    static constexpr double MIN_ZOOM = 0.5;
-    static constexpr double MAX_ZOOM = 10.0;
+    std::unique_ptr<RenderCache> m_renderCache; // Survives document switches (keyed by content)
+    std::unique_ptr<FormFieldOverlay> m_formOverlay; // Per document, dropped before its widgets
+    MinimapStrip *m_minimap; // Child widget, lives in the right viewport margin
+    QString m_displayProfile; // ICC display profile path (empty: sRGB)
+    LatencyMonitor *m_latencyMonitor; // Child QObject
+    std::unique_ptr<ScrollTrace> m_scrollTrace; // PDV_SCROLL_TRACE recording (optional)
+    bool m_handlingInput = false; // Key/wheel in progress: its scrollbar actions are not separate inputs
+
+    // Speculative prefetch (debounced so fast typing does not queue renders)
+    QTimer m_prefetchTimer;
+    int m_prefetchTarget = -1;
+
+    // Layer toggles, coalesced into one re-key per event loop pass
+    QTimer m_layerTimer;
+
+    // Content hash of a file opened with a provisional identity
+    QFutureWatcher<QByteArray> m_hashWatcher;
+
+    // Tunables (DPI, prefetch window, zoom limits...): snapshot of ViewerConfig
+    ViewerSettings m_settings;
 };
 
 #endif // PDFVIEWER_H
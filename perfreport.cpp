@@ -0,0 +1,223 @@
+/**
+ * PerfReport implementation
+ * ---------------------------------------------------------------
+ * Sequential page walk over a private PDFDocument; all timings use
+ * QElapsedTimer (monotonic, nanosecond resolution where available).
+ */
+
+#include "perfreport.h"
+#include "pdfdocument.h"
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLocale>
+#include <algorithm>
+
+namespace
+{
+    double elapsedMs(const QElapsedTimer &timer)
+    {
+        return timer.nsecsElapsed() / 1.0e6;
+    }
+
+    double percentile(QVector<double> values, double p)
+    {
+        if (values.isEmpty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        const int index = qBound(0, int(p * (values.size() - 1) + 0.5), int(values.size()) - 1);
+        return values[index];
+    }
+}
+
+// Measurement ------------------------------------------------------
+
+PerfReport PerfReport::run(const QString &filePath, int dpi, const QString &displayProfile, const ProgressCallback &progress)
+{
+    PerfReport report;
+    report.m_filePath = filePath;
+    report.m_displayProfile = displayProfile;
+    report.m_dpi = dpi;
+
+    QElapsedTimer wall;
+    wall.start();
+
+    PDFDocument document;
+    QElapsedTimer timer;
+    timer.start();
+    if (!document.loadFromFile(filePath, PDFDocument::FileIdentity::None))
+    {
+        report.m_error = QString("Cannot open %1").arg(filePath);
+        return report;
+    }
+    report.m_openMs = elapsedMs(timer);
+    document.setDisplayProfile(displayProfile); // Same color pipeline as the viewer
+
+    // Baseline for the color-management cost: same pages, Poppler's default colors
+    PDFDocument unmanaged;
+    if (!displayProfile.isEmpty() && !unmanaged.loadFromFile(filePath, PDFDocument::FileIdentity::None))
+    {
+        report.m_error = QString("Cannot open %1").arg(filePath);
+        return report;
+    }
+
+    const int pageCount = document.pageCount();
+    report.m_pageCount = pageCount;
+    report.m_pages.reserve(pageCount);
+
+    for (int i = 0; i < pageCount; ++i)
+    {
+        if (progress && !progress(i, pageCount))
+        {
+            report.m_canceled = true;
+            break;
+        }
+
+        auto page = document.getPage(i);
+        if (!page)
+            continue;
+
+        PagePerfRecord record;
+        record.pageIndex = i;
+
+        timer.restart();
+        const QImage image = page->renderToImage(dpi, dpi);
+        record.renderMs = elapsedMs(timer);
+        record.rasterSize = image.size();
+        record.rasterBytes = image.sizeInBytes();
+
+        if (auto plain = unmanaged.getPage(i))
+        {
+            timer.restart();
+            plain->renderToImage(dpi, dpi);
+            record.unmanagedMs = elapsedMs(timer);
+        }
+
+        timer.restart();
+        record.textLength = page->text(QRectF()).size();
+        record.textMs = elapsedMs(timer);
+
+        // A fresh iterator per page: a shared one only reports first uses
+        auto fonts = document.fontIterator(i);
+        if (fonts && fonts->hasNext())
+            record.fontCount = fonts->next().size();
+
+        report.m_pages.append(record);
+    }
+
+    if (progress && !report.m_canceled)
+        progress(pageCount, pageCount);
+
+    report.m_wallMs = elapsedMs(wall);
+    return report;
+}
+
+// Output -----------------------------------------------------------
+
+QString PerfReport::summary(int worstPages) const
+{
+    if (!m_error.isEmpty())
+        return m_error;
+
+    QLocale locale;
+    QVector<double> renderTimes;
+    QVector<double> textTimes;
+    double renderTotal = 0.0;
+    double textTotal = 0.0;
+    for (const PagePerfRecord &record : m_pages)
+    {
+        renderTimes.append(record.renderMs);
+        textTimes.append(record.textMs);
+        renderTotal += record.renderMs;
+        textTotal += record.textMs;
+    }
+
+    // Pages measured both ways (all of them, unless a page failed to load twice)
+    double managedTotal = 0.0;
+    double unmanagedTotal = 0.0;
+    for (const PagePerfRecord &record : m_pages)
+    {
+        if (record.unmanagedMs >= 0.0)
+        {
+            managedTotal += record.renderMs;
+            unmanagedTotal += record.unmanagedMs;
+        }
+    }
+
+    QString text;
+    text += QString("Performance report: %1\n").arg(QFileInfo(m_filePath).fileName());
+    text += QString("Pages measured: %1 of %2 at %3 DPI%4\n")
+                .arg(m_pages.size())
+                .arg(m_pageCount)
+                .arg(m_dpi)
+                .arg(m_canceled ? QString(" (canceled: INCOMPLETE, figures cover these pages only)") : QString());
+    text += QString("Open: %1 ms   Wall: %2 ms\n").arg(m_openMs, 0, 'f', 1).arg(m_wallMs, 0, 'f', 1);
+    text += QString("Render: total %1 ms, p50 %2, p90 %3, p99 %4, max %5\n")
+                .arg(renderTotal, 0, 'f', 1)
+                .arg(percentile(renderTimes, 0.50), 0, 'f', 1)
+                .arg(percentile(renderTimes, 0.90), 0, 'f', 1)
+                .arg(percentile(renderTimes, 0.99), 0, 'f', 1)
+                .arg(percentile(renderTimes, 1.00), 0, 'f', 1);
+    text += QString("Text:   total %1 ms, p50 %2, p90 %3, max %4\n")
+                .arg(textTotal, 0, 'f', 1)
+                .arg(percentile(textTimes, 0.50), 0, 'f', 1)
+                .arg(percentile(textTimes, 0.90), 0, 'f', 1)
+                .arg(percentile(textTimes, 1.00), 0, 'f', 1);
+    if (!m_displayProfile.isEmpty())
+    {
+        text += QString("Color:  %1 ms with %2, %3 ms without (%4%5 %)\n")
+                    .arg(managedTotal, 0, 'f', 1)
+                    .arg(QFileInfo(m_displayProfile).fileName())
+                    .arg(unmanagedTotal, 0, 'f', 1)
+                    .arg(managedTotal >= unmanagedTotal ? "+" : "")
+                    .arg(unmanagedTotal > 0 ? 100.0 * (managedTotal - unmanagedTotal) / unmanagedTotal : 0.0, 0, 'f', 1);
+    }
+    text += "\n";
+
+    // Pathological pages: slowest render (+ text) first
+    QVector<PagePerfRecord> sorted = m_pages;
+    std::sort(sorted.begin(), sorted.end(), [](const PagePerfRecord &a, const PagePerfRecord &b)
+              { return a.renderMs + a.textMs > b.renderMs + b.textMs; });
+
+    const double median = percentile(renderTimes, 0.50);
+    text += QString("%1 %2 %3 %4 %5 %6 %7\n")
+                .arg(QString("page"), 6)
+                .arg(QString("render ms"), 10)
+                .arg(QString("x median"), 9)
+                .arg(QString("text ms"), 8)
+                .arg(QString("fonts"), 6)
+                .arg(QString("chars"), 7)
+                .arg(QString("raster"), 12);
+    for (int i = 0; i < qMin(worstPages, int(sorted.size())); ++i)
+    {
+        const PagePerfRecord &record = sorted[i];
+        text += QString("%1 %2 %3 %4 %5 %6 %7\n")
+                    .arg(record.pageIndex + 1, 6)
+                    .arg(record.renderMs, 10, 'f', 1)
+                    .arg(median > 0 ? record.renderMs / median : 0.0, 9, 'f', 1)
+                    .arg(record.textMs, 8, 'f', 1)
+                    .arg(record.fontCount, 6)
+                    .arg(record.textLength, 7)
+                    .arg(locale.formattedDataSize(record.rasterBytes), 12);
+    }
+    return text;
+}
+
+QString PerfReport::toCsv() const
+{
+    QString csv = "page,render_ms,width,height,raster_bytes,fonts,text_ms,text_chars,unmanaged_ms,dpi\n";
+    for (const PagePerfRecord &record : m_pages)
+    {
+        csv += QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10\n")
+                   .arg(record.pageIndex + 1)
+                   .arg(record.renderMs, 0, 'f', 3)
+                   .arg(record.rasterSize.width())
+                   .arg(record.rasterSize.height())
+                   .arg(record.rasterBytes)
+                   .arg(record.fontCount)
+                   .arg(record.textMs, 0, 'f', 3)
+                   .arg(record.textLength)
+                   .arg(record.unmanagedMs >= 0.0 ? QString::number(record.unmanagedMs, 'f', 3) : QString())
+                   .arg(m_dpi);
+    }
+    return csv;
+}
@@ -0,0 +1,77 @@
+#ifndef PERFREPORT_H
+#define PERFREPORT_H
+
+#include <QSize>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+/**
+ * PagePerfRecord
+ * Measurements for ONE page of a performance report.
+ */
+struct PagePerfRecord
+{
+    int pageIndex = -1;
+    double renderMs = 0.0;
+    double unmanagedMs = -1.0; // Same render without the display profile (-1: no profile)
+    QSize rasterSize;
+    qint64 rasterBytes = 0;
+    int fontCount = 0;   // Fonts used by the page
+    double textMs = 0.0; // Full-page text extraction
+    int textLength = 0;  // Extracted characters
+};
+
+/**
+ * PerfReport
+ * ---------------------------------------------------------------
+ * Headless "why is this PDF slow?" report.
+ *
+ * Responsibilities:
+ *  - Open its own copy of the document (safe on a worker thread).
+ *  - Render every page, extract its text and count its fonts, timing each.
+ *  - With a display profile, render every page once more without it, so
+ *    the cost of color management shows next to the render time.
+ *  - Summarize: totals, percentiles and the slowest pages first.
+ *  - On cancel, keep the pages measured so far and say the report is
+ *    incomplete.
+ *
+ * Design notes:
+ *  - Poppler Qt exposes no per-page image list, so images are not counted;
+ *    their cost shows up in render time and raster size.
+ *  - Unmanaged renders come from a second private document, so neither
+ *    pass warms Poppler's per-document caches for the other.
+ *  - Never throws: failures land in error().
+ */
+class PerfReport
+{
+public:
+    using ProgressCallback = std::function<bool(int done, int total)>; // Return false to cancel.
+
+    static PerfReport run(const QString &filePath, int dpi, const QString &displayProfile = QString(),
+                          const ProgressCallback &progress = ProgressCallback());
+
+    bool isValid() const { return m_error.isEmpty() && !m_pages.isEmpty(); }
+    bool isComplete() const { return !m_canceled; } // False: canceled, pages() holds the measured prefix.
+    QString error() const { return m_error; }
+    const QVector<PagePerfRecord> &pages() const { return m_pages; }
+
+    QString summary(int worstPages = WORST_PAGES) const; // Human-readable, slowest first.
+    QString toCsv() const;                               // One row per page, document order; DPI on each.
+
+    static constexpr int DEFAULT_DPI = 200; // Built-in render/dpi (ViewerConfig)
+    static constexpr int WORST_PAGES = 20;
+
+private:
+    QString m_filePath;
+    QString m_displayProfile;
+    int m_dpi = DEFAULT_DPI;
+    double m_openMs = 0.0;
+    double m_wallMs = 0.0;
+    int m_pageCount = 0; // In the document; pages() may hold fewer
+    bool m_canceled = false;
+    QString m_error;
+    QVector<PagePerfRecord> m_pages;
+};
+
+#endif // PERFREPORT_H
@@ -0,0 +1,163 @@
+#include "pngstreamwriter.h"
+#include <QtEndian>
+#include <zlib.h>
+
+namespace
+{
+    QByteArray bigEndian32(quint32 value)
+    {
+        QByteArray bytes(4, Qt::Uninitialized);
+        qToBigEndian(value, bytes.data());
+        return bytes;
+    }
+}
+
+PngStreamWriter::PngStreamWriter() = default;
+
+PngStreamWriter::~PngStreamWriter()
+{
+    if (m_stream)
+        deflateEnd(m_stream.get());
+    // An uncommitted QSaveFile removes its temporary file
+}
+
+// Header -----------------------------------------------------------
+
+bool PngStreamWriter::open(const QString &path, int width, int height, int dpi, int compressionLevel)
+{
+    if (width <= 0 || height <= 0)
+        return fail("empty image");
+
+    m_width = width;
+    m_height = height;
+    m_rowsWritten = 0;
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly))
+        return fail(m_file.errorString());
+
+    m_stream = std::make_unique<z_stream_s>();
+    m_stream->zalloc = Z_NULL;
+    m_stream->zfree = Z_NULL;
+    m_stream->opaque = Z_NULL;
+    if (deflateInit(m_stream.get(), compressionLevel) != Z_OK)
+    {
+        m_stream.reset();
+        return fail("zlib initialization failed");
+    }
+
+    m_row.resize(1 + 3 * qint64(width));
+    m_output.resize(IDAT_BUFFER);
+    m_stream->next_out = reinterpret_cast<Bytef *>(m_output.data());
+    m_stream->avail_out = IDAT_BUFFER;
+
+    static const char signature[] = "\x89PNG\r\n\x1a\n";
+    if (m_file.write(signature, 8) != 8)
+        return fail(m_file.errorString());
+
+    // 8-bit RGB, deflate, adaptive filtering, no interlace
+    QByteArray header = bigEndian32(width) + bigEndian32(height);
+    header.append(char(8)).append(char(2)).append(char(0)).append(char(0)).append(char(0));
+    if (!writeChunk("IHDR", header))
+        return false;
+
+    // Physical size: pixels per metre, unit = metre
+    const quint32 pixelsPerMetre = quint32(dpi / 0.0254 + 0.5);
+    QByteArray physical = bigEndian32(pixelsPerMetre) + bigEndian32(pixelsPerMetre);
+    physical.append(char(1));
+    return writeChunk("pHYs", physical);
+}
+
+// Rows -------------------------------------------------------------
+
+bool PngStreamWriter::writeBand(const QImage &band)
+{
+    if (!m_stream)
+        return fail("not open");
+    if (band.width() != m_width || m_rowsWritten + band.height() > m_height)
+        return fail("band does not fit the image");
+
+    const QImage rgb = band.convertToFormat(QImage::Format_RGB888);
+    if (rgb.isNull())
+        return fail("out of memory converting band");
+
+    uchar *row = reinterpret_cast<uchar *>(m_row.data());
+    for (int y = 0; y < rgb.height(); ++y)
+    {
+        // Sub filter: each byte minus the same channel of the previous pixel
+        const uchar *source = rgb.constScanLine(y);
+        const int bytes = 3 * m_width;
+        row[0] = 1;
+        for (int i = 0; i < 3 && i < bytes; ++i)
+            row[1 + i] = source[i];
+        for (int i = 3; i < bytes; ++i)
+            row[1 + i] = uchar(source[i] - source[i - 3]);
+
+        ++m_rowsWritten;
+        if (!deflateRow(row, 1 + bytes, m_rowsWritten == m_height))
+            return false;
+    }
+    return true;
+}
+
+bool PngStreamWriter::deflateRow(const uchar *row, int length, bool last)
+{
+    m_stream->next_in = const_cast<Bytef *>(row);
+    m_stream->avail_in = uInt(length);
+
+    for (;;)
+    {
+        const int result = deflate(m_stream.get(), last ? Z_FINISH : Z_NO_FLUSH);
+        if (result == Z_STREAM_ERROR)
+            return fail("zlib stream error");
+
+        // Output buffer full (or stream done): ship it as one IDAT
+        const bool done = last && result == Z_STREAM_END;
+        if (m_stream->avail_out == 0 || (done && m_stream->avail_out < uInt(IDAT_BUFFER)))
+        {
+            if (!writeChunk("IDAT", m_output.left(IDAT_BUFFER - int(m_stream->avail_out))))
+                return false;
+            m_stream->next_out = reinterpret_cast<Bytef *>(m_output.data());
+            m_stream->avail_out = IDAT_BUFFER;
+        }
+
+        if (done || (!last && m_stream->avail_in == 0 && m_stream->avail_out > 0))
+            return true;
+    }
+}
+
+// Trailer ----------------------------------------------------------
+
+bool PngStreamWriter::finish()
+{
+    if (!m_stream)
+        return fail("not open");
+    if (m_rowsWritten != m_height)
+        return fail(QString("%1 of %2 rows written").arg(m_rowsWritten).arg(m_height));
+
+    deflateEnd(m_stream.get());
+    m_stream.reset();
+
+    if (!writeChunk("IEND", QByteArray()))
+        return false;
+    if (!m_file.commit())
+        return fail(m_file.errorString());
+    return true;
+}
+
+bool PngStreamWriter::writeChunk(const char type[4], const QByteArray &data)
+{
+    uLong crc = crc32(0L, reinterpret_cast<const Bytef *>(type), 4);
+    crc = crc32(crc, reinterpret_cast<const Bytef *>(data.constData()), uInt(data.size()));
+
+    const QByteArray chunk = bigEndian32(quint32(data.size())) + QByteArray(type, 4) + data + bigEndian32(quint32(crc));
+    if (m_file.write(chunk) != chunk.size())
+        return fail(m_file.errorString());
+    return true;
+}
+
+bool PngStreamWriter::fail(const QString &error)
+{
+    if (m_error.isEmpty())
+        m_error = error;
+    return false;
+}
@@ -0,0 +1,60 @@
+#ifndef PNGSTREAMWRITER_H
+#define PNGSTREAMWRITER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QSaveFile>
+#include <QString>
+#include <memory>
+
+struct z_stream_s;
+
+/**
+ * PngStreamWriter
+ * ---------------------------------------------------------------
+ * Scanline PNG encoder: the image arrives as horizontal bands and leaves
+ * as deflate output, so no full-size buffer ever exists.
+ *
+ * Responsibilities:
+ *  - Write signature, IHDR (8-bit RGB) and pHYs (the export DPI, so
+ *    plotters and layout tools pick the right physical size).
+ *  - Filter each row (Sub) and feed it to zlib; emit an IDAT chunk every
+ *    time the output buffer fills.
+ *  - Finish with IEND and commit atomically (QSaveFile).
+ *
+ * Design notes:
+ *  - Memory: one row plus zlib state plus IDAT_BUFFER, whatever the size.
+ *  - Alpha is dropped: pages are opaque paper.
+ *  - Never throws: false + errorString(); an unfinished file is discarded.
+ */
+class PngStreamWriter
+{
+public:
+    PngStreamWriter();
+    ~PngStreamWriter();
+
+    bool open(const QString &path, int width, int height, int dpi, int compressionLevel = DEFAULT_COMPRESSION);
+    bool writeBand(const QImage &band); // Next band.height() rows, band.width() == width.
+    bool finish();                      // After exactly `height` rows.
+
+    QString errorString() const { return m_error; }
+
+    static constexpr int DEFAULT_COMPRESSION = 6;
+    static constexpr int IDAT_BUFFER = 256 * 1024;
+
+private:
+    bool writeChunk(const char type[4], const QByteArray &data);
+    bool deflateRow(const uchar *row, int length, bool last);
+    bool fail(const QString &error);
+
+    QSaveFile m_file;
+    std::unique_ptr<z_stream_s> m_stream;
+    QByteArray m_row;    // Filter byte + RGB
+    QByteArray m_output; // Pending IDAT payload
+    int m_width = 0;
+    int m_height = 0;
+    int m_rowsWritten = 0;
+    QString m_error;
+};
+
+#endif // PNGSTREAMWRITER_H
@@ -0,0 +1,294 @@
+/**
+ * PrintPreviewDialog implementation
+ * ---------------------------------------------------------------
+ * The preview paints sheets straight from the shared RenderCache at a low,
+ * fixed DPI. Only sheets crossing the viewport are ever rasterized, and
+ * changing range or scaling only recomputes offsets and repaints.
+ */
+
+#include "printpreviewdialog.h"
+#include "pdfdocument.h"
+#include "rendercache.h"
+#include <QComboBox>
+#include <QDebug>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPainter>
+#include <QPrintDialog>
+#include <QPrinter>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QSpinBox>
+#include <QVBoxLayout>
+#include <QtMath>
+#include <algorithm>
+
+// PrintPreviewView ==================================================
+
+PrintPreviewView::PrintPreviewView(PDFDocument *document, RenderCache *cache, QWidget *parent)
+    : QAbstractScrollArea(parent), m_document(document), m_cache(cache)
+{
+    viewport()->setBackgroundRole(QPalette::Dark);
+    viewport()->setAutoFillBackground(true);
+
+    // Page sizes are cheap metadata: the document keeps the table
+    if (m_document)
+    {
+        m_pageSizes = m_document->pageSizes();
+    }
+
+    setPageRange(0, m_pageSizes.size() - 1);
+}
+
+void PrintPreviewView::setPageRange(int firstPage, int lastPage)
+{
+    m_firstPage = qMax(0, firstPage);
+    m_lastPage = qMin(lastPage, m_pageSizes.size() - 1);
+    relayout();
+}
+
+void PrintPreviewView::setContentScale(double scale)
+{
+    // Same cached renders, different target rectangle: repaint only
+    m_contentScale = scale;
+    viewport()->update();
+}
+
+QSize PrintPreviewView::sheetSize(int pageIndex) const
+{
+    const QSizeF points = m_pageSizes.value(pageIndex);
+    return QSize(qCeil(points.width() * PREVIEW_DPI / 72.0), qCeil(points.height() * PREVIEW_DPI / 72.0));
+}
+
+void PrintPreviewView::relayout()
+{
+    m_sheetTops.clear();
+
+    int y = SHEET_SPACING;
+    int maxWidth = 0;
+    for (int i = m_firstPage; i <= m_lastPage; ++i)
+    {
+        const QSize size = sheetSize(i);
+        m_sheetTops.append(y);
+        y += size.height() + SHEET_SPACING;
+        maxWidth = qMax(maxWidth, size.width());
+    }
+    m_contentHeight = y;
+
+    verticalScrollBar()->setRange(0, qMax(0, m_contentHeight - viewport()->height()));
+    verticalScrollBar()->setPageStep(viewport()->height());
+    verticalScrollBar()->setSingleStep(SHEET_SPACING * 2);
+
+    horizontalScrollBar()->setRange(0, qMax(0, maxWidth + 2 * SHEET_SPACING - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+
+    viewport()->update();
+}
+
+void PrintPreviewView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    relayout();
+}
+
+void PrintPreviewView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    if (m_sheetTops.isEmpty())
+        return;
+
+    QPainter painter(viewport());
+    const int scrollY = verticalScrollBar()->value();
+    const int scrollX = horizontalScrollBar()->value();
+    const int viewHeight = viewport()->height();
+
+    // First sheet whose top is above the viewport top (or the very first one)
+    auto it = std::upper_bound(m_sheetTops.cbegin(), m_sheetTops.cend(), scrollY);
+    int slot = qMax(0, int(it - m_sheetTops.cbegin()) - 1);
+
+    for (; slot < m_sheetTops.size(); ++slot)
+    {
+        const int pageIndex = m_firstPage + slot;
+        const QSize size = sheetSize(pageIndex);
+        const QRect sheet(qMax(SHEET_SPACING, (viewport()->width() - size.width()) / 2) - scrollX,
+                          m_sheetTops[slot] - scrollY, size.width(), size.height());
+
+        if (sheet.top() > viewHeight)
+            break;
+        if (sheet.bottom() < 0)
+            continue;
+
+        // Paper
+        painter.fillRect(sheet.translated(3, 3), QColor(0, 0, 0, 60));
+        painter.fillRect(sheet, Qt::white);
+
+        // Content, scaled from the sheet's top-left corner and clipped to it
+        const QRectF target(sheet.topLeft(), QSizeF(sheet.size()) * m_contentScale);
+        painter.save();
+        painter.setClipRect(sheet);
+
+        const QPixmap pixmap = previewPixmap(pageIndex);
+        if (!pixmap.isNull())
+        {
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, m_contentScale != 1.0);
+            painter.drawPixmap(target, pixmap, QRectF(pixmap.rect()));
+        }
+        painter.restore();
+
+        painter.setPen(Qt::gray);
+        painter.drawRect(sheet.adjusted(0, 0, -1, -1));
+    }
+}
+
+QPixmap PrintPreviewView::previewPixmap(int pageIndex)
+{
+    // Keyed like the viewer's pages: content plus the layers shown
+    const QByteArray documentKey = m_document->renderKey();
+
+    // Fast path: render or blank sheet known, no Poppler page needed
+    PageProbe probe = m_cache->pageProbe(documentKey, pageIndex);
+    QPixmap pixmap = m_cache->find(documentKey, pageIndex, PREVIEW_DPI);
+    if (!pixmap.isNull())
+        return pixmap;
+
+    // Blank sheets (confirmed by an earlier render): a tiny solid fill instead of a render
+    if (probe.isBlankAt(PREVIEW_DPI))
+    {
+        pixmap = QPixmap(sheetSize(pageIndex));
+        pixmap.fill(probe.fillColor);
+        m_cache->insert(documentKey, pageIndex, PREVIEW_DPI, pixmap);
+        return pixmap;
+    }
+
+    const std::unique_ptr<Poppler::Page> page = m_document->getPage(pageIndex);
+    if (!page)
+        return QPixmap();
+
+    const QImage image = page->renderToImage(PREVIEW_DPI, PREVIEW_DPI);
+    if (!probe.isContent())
+    {
+        probe.checkRender(image, PREVIEW_DPI); // Blank or content: either way worth keeping
+        m_cache->setPageProbe(documentKey, pageIndex, probe);
+    }
+
+    pixmap = QPixmap::fromImage(image);
+    m_cache->insert(documentKey, pageIndex, PREVIEW_DPI, pixmap);
+    return pixmap;
+}
+
+// PrintPreviewDialog ================================================
+
+PrintPreviewDialog::PrintPreviewDialog(PDFDocument *document, RenderCache *cache, QWidget *parent)
+    : QDialog(parent), m_document(document)
+{
+    setWindowTitle(tr("Print Preview - %1").arg(document->title()));
+    resize(720, 860);
+
+    const int pageCount = document->pageCount();
+
+    m_fromPage = new QSpinBox(this);
+    m_fromPage->setRange(1, pageCount);
+    m_fromPage->setValue(1);
+
+    m_toPage = new QSpinBox(this);
+    m_toPage->setRange(1, pageCount);
+    m_toPage->setValue(pageCount);
+
+    m_scaling = new QComboBox(this);
+    m_scaling->addItem(tr("Actual size"), 1.0);
+    m_scaling->addItem(tr("90%"), 0.9);
+    m_scaling->addItem(tr("75%"), 0.75);
+    m_scaling->addItem(tr("50%"), 0.5);
+
+    QHBoxLayout *controls = new QHBoxLayout();
+    controls->addWidget(new QLabel(tr("Pages"), this));
+    controls->addWidget(m_fromPage);
+    controls->addWidget(new QLabel(tr("to"), this));
+    controls->addWidget(m_toPage);
+    controls->addSpacing(16);
+    controls->addWidget(new QLabel(tr("Scaling"), this));
+    controls->addWidget(m_scaling);
+    controls->addStretch(1);
+
+    m_view = new PrintPreviewView(document, cache, this);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *printButton = buttons->addButton(tr("Print..."), QDialogButtonBox::AcceptRole);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(controls);
+    layout->addWidget(m_view, 1);
+    layout->addWidget(buttons);
+
+    connect(m_fromPage, &QSpinBox::valueChanged, this, &PrintPreviewDialog::updatePreview);
+    connect(m_toPage, &QSpinBox::valueChanged, this, &PrintPreviewDialog::updatePreview);
+    connect(m_scaling, &QComboBox::currentIndexChanged, this, &PrintPreviewDialog::updatePreview);
+    connect(printButton, &QPushButton::clicked, this, &PrintPreviewDialog::print);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+void PrintPreviewDialog::updatePreview()
+{
+    // Keep the range well-formed whichever end was edited
+    if (m_toPage->value() < m_fromPage->value())
+    {
+        m_toPage->setValue(m_fromPage->value()); // Re-enters with a valid range
+        return;
+    }
+
+    m_view->setPageRange(m_fromPage->value() - 1, m_toPage->value() - 1);
+    m_view->setContentScale(contentScale());
+}
+
+double PrintPreviewDialog::contentScale() const
+{
+    return m_scaling->currentData().toDouble();
+}
+
+// Printing ---------------------------------------------------------
+
+void PrintPreviewDialog::print()
+{
+    QPrinter printer(QPrinter::HighResolution);
+    printer.setDocName(m_document->title());
+
+    QPrintDialog dialog(&printer, this);
+    dialog.setOption(QAbstractPrintDialog::PrintPageRange, false); // Range comes from the preview
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    printPages(&printer);
+    accept();
+}
+
+void PrintPreviewDialog::printPages(QPrinter *printer)
+{
+    QPainter painter;
+    if (!painter.begin(printer))
+    {
+        qWarning() << "PrintPreviewDialog: Cannot start printing";
+        return;
+    }
+
+    // Printer resolutions can be huge; 300 DPI is plenty for raster output
+    const int deviceDpi = printer->resolution();
+    const int renderDpi = qMin(deviceDpi, MAX_PRINT_DPI);
+    const double scale = contentScale();
+
+    for (int i = m_fromPage->value() - 1; i <= m_toPage->value() - 1; ++i)
+    {
+        if (i > m_fromPage->value() - 1)
+            printer->newPage();
+
+        auto page = m_document->getPage(i);
+        if (!page)
+            continue;
+
+        const QImage image = page->renderToImage(renderDpi, renderDpi);
+        const QSizeF target = page->pageSizeF() * (deviceDpi / 72.0) * scale;
+        painter.drawImage(QRectF(QPointF(0, 0), target), image);
+    }
+
+    painter.end();
+}
@@ -0,0 +1,91 @@
+#ifndef PRINTPREVIEWDIALOG_H
+#define PRINTPREVIEWDIALOG_H
+
+#include <QAbstractScrollArea>
+#include <QDialog>
+#include <QSizeF>
+#include <QVector>
+
+class PDFDocument;
+class RenderCache;
+class QSpinBox;
+class QComboBox;
+class QPrinter;
+
+/**
+ * PrintPreviewView
+ * --------------------------------------------------------
+ * Virtualized preview surface: sheets are painted, never widgets.
+ *
+ * Responsibilities:
+ * - Lay out the selected page range as sheets (prefix-sum offsets)
+ * - Paint only sheets crossing the viewport
+ * - Fetch preview renders from the shared RenderCache, rasterizing misses
+ *
+ * Design notes:
+ * - Renders are requested at one fixed PREVIEW_DPI; the content scale only
+ *   changes the target rectangle, so scaling never re-renders.
+ */
+class PrintPreviewView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    PrintPreviewView(PDFDocument *document, RenderCache *cache, QWidget *parent = nullptr);
+
+    void setPageRange(int firstPage, int lastPage); // 0-based, inclusive.
+    void setContentScale(double scale);             // 1.0 = actual size.
+
+    static constexpr int PREVIEW_DPI = 48;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void relayout();
+    QPixmap previewPixmap(int pageIndex);
+    QSize sheetSize(int pageIndex) const; // Pixels at PREVIEW_DPI.
+
+    PDFDocument *m_document; // Non-owning
+    RenderCache *m_cache;    // Non-owning
+    QVector<QSizeF> m_pageSizes; // Points, whole document
+    QVector<int> m_sheetTops;    // Content y of each sheet in the range
+    int m_firstPage = 0;
+    int m_lastPage = -1;
+    double m_contentScale = 1.0;
+    int m_contentHeight = 0;
+
+    static constexpr int SHEET_SPACING = 16;
+};
+
+/**
+ * PrintPreviewDialog
+ * --------------------------------------------------------
+ * Page range + scaling controls around a PrintPreviewView, and printing.
+ */
+class PrintPreviewDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    PrintPreviewDialog(PDFDocument *document, RenderCache *cache, QWidget *parent = nullptr);
+
+private slots:
+    void updatePreview();
+    void print();
+
+private:
+    double contentScale() const;
+    void printPages(QPrinter *printer);
+
+    PDFDocument *m_document; // Non-owning
+    PrintPreviewView *m_view;
+    QSpinBox *m_fromPage;
+    QSpinBox *m_toPage;
+    QComboBox *m_scaling;
+
+    static constexpr int MAX_PRINT_DPI = 300; // Raster resolution cap for printing
+};
+
+#endif // PRINTPREVIEWDIALOG_H
@@ -0,0 +1,310 @@
+/**
+ * ReadingQueue implementation
+ * ---------------------------------------------------------------
+ * The worker does everything a first paint needs that does not touch a
+ * widget; the GUI thread only converts images to pixmaps.
+ */
+
+#include "readingqueue.h"
+#include "pdfdocument.h"
+#include "rendercache.h"
+#include "imagescaler.h"
+#include "viewerconfig.h"
+#include <QAtomicInt>
+#include <QDebug>
+#include <QPixmap>
+#include <QtConcurrent>
+
+// Shared by the GUI thread and the worker. The worker owns every field
+// but canceled until the future finishes.
+struct ReadingQueue::PreloadJob
+{
+    QAtomicInt canceled;
+    QString filePath;
+    QString displayProfile;
+    int dpi = 0;
+    QVector<int> pageIndices;
+    QByteArray cacheContext; // RenderCache context when started: the pixels belong to it
+    std::unique_ptr<PDFDocument> document; // Set on start when retargeted, else by the worker
+    QVector<PreloadedPage> pages;
+};
+
+// Construction -----------------------------------------------------
+ReadingQueue::ReadingQueue(QObject *parent) : QObject(parent)
+{
+    connect(&m_preloadWatcher, &QFutureWatcherBase::finished, this, &ReadingQueue::onPreloadFinished);
+}
+
+ReadingQueue::~ReadingQueue()
+{
+    discardPreload(); // A running worker keeps its job alive and stops at its next step
+}
+
+// Queue ------------------------------------------------------------
+void ReadingQueue::setFiles(const QStringList &files)
+{
+    discardPreload();
+    m_files = files;
+    m_currentIndex = -1;
+}
+
+// Documents --------------------------------------------------------
+std::unique_ptr<PDFDocument> ReadingQueue::openDocument(int index)
+{
+    if (index < 0 || index >= m_files.size())
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<PDFDocument> document;
+    if (index == m_preloadIndex)
+    {
+        // Rarely still running; waiting is never slower than opening from scratch
+        m_preloadWatcher.waitForFinished();
+        adoptPreload();
+        if (m_job && m_job->document && m_job->document->isLoaded())
+        {
+            document = std::move(m_job->document);
+        }
+    }
+    discardPreload();
+
+    if (!document)
+    {
+        document = std::make_unique<PDFDocument>();
+        if (!document->loadFromFile(m_files[index]))
+        {
+            qWarning() << "ReadingQueue: Cannot open" << m_files[index];
+            return nullptr;
+        }
+    }
+
+    m_currentIndex = index;
+    return document;
+}
+
+// Preloading -------------------------------------------------------
+void ReadingQueue::preloadNext(int dpi, const QString &displayProfile)
+{
+    if (!hasNext())
+    {
+        discardPreload();
+        return;
+    }
+    preload(m_currentIndex + 1, dpi, displayProfile);
+}
+
+void ReadingQueue::preload(int index, int dpi, const QString &displayProfile, int targetPage)
+{
+    if (index < 0 || index >= m_files.size() || index == m_currentIndex)
+    {
+        return;
+    }
+    if (index == m_preloadIndex && m_job)
+    {
+        // Same file, other page: keep the load, only render the new target
+        if (targetPage != m_preloadTarget)
+        {
+            m_preloadTarget = targetPage;
+            m_retargetPending = true;
+            if (m_preloadWatcher.isFinished())
+                retargetPreload();
+        }
+        return;
+    }
+
+    discardPreload();
+    m_preloadIndex = index;
+    m_preloadTarget = targetPage;
+    m_preloadAdopted = false;
+
+    // As many pages as the viewer pre-renders on open, plus the jump target and what follows it
+    QVector<int> pageIndices = targetPages(targetPage);
+    for (int i = 0; i < ViewerConfig::instance().settings().initialPages; ++i)
+    {
+        if (!pageIndices.contains(i))
+            pageIndices.append(i);
+    }
+
+    m_job = std::make_shared<PreloadJob>();
+    m_job->filePath = m_files[m_preloadIndex];
+    m_job->displayProfile = displayProfile;
+    m_job->dpi = dpi;
+    m_job->pageIndices = pageIndices;
+    m_job->cacheContext = m_renderCache ? m_renderCache->context() : QByteArray();
+    m_preloadWatcher.setFuture(QtConcurrent::run(&ReadingQueue::preloadWorker, m_job));
+}
+
+void ReadingQueue::retargetPreload()
+{
+    // Pages of the finished job go to the cache; its document carries over
+    m_retargetPending = false;
+    adoptPreload();
+    if (!m_job->document || !m_job->document->isLoaded())
+    {
+        return; // Failed to load: openDocument() will try again from scratch
+    }
+
+    // Whatever any job of this preload (or the viewer) left in the cache is
+    // done; without a cache, renders would have nowhere to go
+    const QByteArray documentKey = m_job->document->renderKey();
+    const int ladderDpi = RenderCache::ladderDpi(m_job->dpi);
+    QVector<int> pageIndices;
+    for (int i : targetPages(m_preloadTarget))
+    {
+        if (!m_renderCache || m_renderCache->pageProbe(documentKey, i).isBlankAt(ladderDpi) ||
+            !m_renderCache->find(documentKey, i, ladderDpi).isNull())
+            continue;
+        pageIndices.append(i);
+    }
+    if (pageIndices.isEmpty())
+    {
+        emit preloadFinished(m_preloadIndex);
+        return;
+    }
+
+    auto job = std::make_shared<PreloadJob>();
+    job->filePath = m_job->filePath;
+    job->displayProfile = m_job->displayProfile;
+    job->dpi = m_job->dpi;
+    job->pageIndices = pageIndices;
+    job->cacheContext = m_renderCache ? m_renderCache->context() : QByteArray();
+    job->document = std::move(m_job->document);
+
+    m_job = job;
+    m_preloadAdopted = false;
+    m_preloadWatcher.setFuture(QtConcurrent::run(&ReadingQueue::preloadWorker, m_job));
+}
+
+QVector<int> ReadingQueue::targetPages(int targetPage)
+{
+    QVector<int> pageIndices;
+    if (targetPage >= 0)
+    {
+        const int window = ViewerConfig::instance().settings().prefetchWindow;
+        for (int i = targetPage; i <= targetPage + window; ++i)
+            pageIndices.append(i);
+    }
+    return pageIndices;
+}
+
+void ReadingQueue::onPreloadFinished()
+{
+    if (m_retargetPending && m_job)
+    {
+        retargetPreload(); // Asked for another page meanwhile: announce once that is rendered
+        return;
+    }
+
+    adoptPreload();
+    if (m_job && m_job->document && m_job->document->isLoaded())
+    {
+        emit preloadFinished(m_preloadIndex);
+    }
+}
+
+void ReadingQueue::adoptPreload()
+{
+    if (m_preloadAdopted || !m_job || !m_preloadWatcher.isFinished())
+    {
+        return;
+    }
+    m_preloadAdopted = true;
+
+    if (!m_renderCache || !m_job->document || !m_job->document->isLoaded())
+    {
+        return;
+    }
+
+    // Keyed exactly as PDFPage looks them up: by (renderKey, page), pixmaps also by DPI.
+    // Renders from before a quality or profile change would be filed under the new one.
+    const QByteArray documentKey = m_job->document->renderKey();
+    const bool pixelsCurrent = m_renderCache->context() == m_job->cacheContext;
+    for (const PreloadedPage &page : std::as_const(m_job->pages))
+    {
+        m_renderCache->setPageProbe(documentKey, page.pageIndex, page.probe);
+        if (!pixelsCurrent)
+            continue;
+        if (!page.ladderImage.isNull())
+        {
+            m_renderCache->insert(documentKey, page.pageIndex, page.ladderDpi, QPixmap::fromImage(page.ladderImage),
+                                  page.ladderImage); // Ladder renders only: neighbors downscale their own
+        }
+        if (!page.image.isNull())
+        {
+            m_renderCache->insert(documentKey, page.pageIndex, page.dpi, QPixmap::fromImage(page.image));
+        }
+    }
+}
+
+void ReadingQueue::discardPreload()
+{
+    // Abandon, never join: the worker drops the job when it notices
+    if (m_job)
+    {
+        m_job->canceled.storeRelaxed(1);
+        m_job.reset();
+    }
+    m_preloadWatcher.setFuture(QFuture<void>());
+    m_preloadIndex = -1;
+    m_preloadTarget = -1;
+    m_preloadAdopted = false;
+    m_retargetPending = false;
+}
+
+// Worker -----------------------------------------------------------
+void ReadingQueue::preloadWorker(std::shared_ptr<PreloadJob> job)
+{
+    // Retargeted: the document is loaded already, only pages are left
+    std::unique_ptr<PDFDocument> document = std::move(job->document);
+    if (!document)
+    {
+        // Hashing the whole file here is exactly the part worth hiding
+        document = std::make_unique<PDFDocument>();
+        document->setDisplayProfile(job->displayProfile);
+        if (!document->loadFromFile(job->filePath, PDFDocument::FileIdentity::Content))
+        {
+            return;
+        }
+        if (job->canceled.loadRelaxed())
+        {
+            return;
+        }
+        document->pageSizes();
+    }
+
+    const int dpi = job->dpi;
+    const int ladderDpi = RenderCache::ladderDpi(dpi);
+    for (int i : std::as_const(job->pageIndices))
+    {
+        if (job->canceled.loadRelaxed())
+        {
+            return; // The document goes with this thread's last reference
+        }
+
+        auto page = document->getPage(i); // nullptr past the last page
+        if (!page)
+            continue;
+
+        PreloadedPage preloaded;
+        preloaded.pageIndex = i;
+        preloaded.ladderDpi = ladderDpi;
+        preloaded.ladderImage = page->renderToImage(ladderDpi, ladderDpi);
+
+        // Blank pages are drawn as a fill: the probe is all they need
+        if (preloaded.probe.checkRender(preloaded.ladderImage, ladderDpi))
+        {
+            preloaded.ladderImage = QImage();
+        }
+        else if (dpi != ladderDpi && !preloaded.ladderImage.isNull())
+        {
+            const double ratio = double(dpi) / ladderDpi;
+            const QSize target(qMax(1, qRound(preloaded.ladderImage.width() * ratio)),
+                               qMax(1, qRound(preloaded.ladderImage.height() * ratio)));
+            preloaded.dpi = dpi;
+            preloaded.image = ImageScaler::areaDownscale(preloaded.ladderImage, target);
+        }
+        job->pages.append(preloaded);
+    }
+    job->document = std::move(document);
+}
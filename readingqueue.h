@@ -0,0 +1,108 @@
+#ifndef READINGQUEUE_H
+#define READINGQUEUE_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include "pageprobe.h"
+
+class PDFDocument;
+class RenderCache;
+
+/**
+ * PreloadedPage
+ * Worker output for ONE of the first pages of a preloaded document.
+ */
+struct PreloadedPage
+{
+    int pageIndex = -1;
+    PageProbe probe;
+    int ladderDpi = 0;
+    QImage ladderImage; // Render at the DPI ladder step (null for blank pages).
+    int dpi = 0;
+    QImage image;       // Downscaled to the exact DPI (null if dpi is a step).
+};
+
+/**
+ * ReadingQueue
+ * ---------------------------------------------------------------
+ * Ordered list of files read one after another, with the next one
+ * preloaded in the background.
+ *
+ * Responsibilities:
+ *  - Track the queue and the position of the current document.
+ *  - Preload the next file on a worker: open it (content hash included),
+ *    build its page-size table, render its first pages (blank ones
+ *    kept as a probe only).
+ *  - Preload any queued file on request, with a page about to be jumped
+ *    to (search results) rendered along with the first ones.
+ *  - Feed those probes and renders to the shared RenderCache, so the
+ *    viewer's first paint of the next document is all cache hits.
+ *
+ * Design notes:
+ *  - A preload is a job shared by the GUI thread and its worker. The
+ *    document is handed out only after the worker finished with it
+ *    (Poppler objects are never used concurrently).
+ *  - Only one preload at a time: a new request cancels the previous one.
+ *    Another target page in the same file keeps the load and only renders
+ *    the new pages, once the running job is done.
+ *    Nothing waits for it: the worker sees the cancel flag between steps,
+ *    and the abandoned job (document included) dies with its last owner.
+ *  - Never throws: openDocument() returns nullptr on failure.
+ */
+class ReadingQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReadingQueue(QObject *parent = nullptr);
+    ~ReadingQueue() override;
+
+    // Queue ---------------------------------------------------------
+    void setFiles(const QStringList &files); // Resets the position (nothing open yet).
+    QStringList files() const { return m_files; }
+    int count() const { return m_files.size(); }
+    int currentIndex() const { return m_currentIndex; }
+    bool hasNext() const { return m_currentIndex + 1 < m_files.size(); }
+    bool hasPrevious() const { return m_currentIndex > 0; }
+
+    // Documents -----------------------------------------------------
+    // Preloaded instance if available (waits for a running preload), else loaded now.
+    std::unique_ptr<PDFDocument> openDocument(int index);
+
+    // Preloading ----------------------------------------------------
+    void setRenderCache(RenderCache *cache) { m_renderCache = cache; } // Non-owning.
+    void preloadNext(int dpi, const QString &displayProfile);          // No-op at the end of the queue.
+    void preload(int index, int dpi, const QString &displayProfile, int targetPage = -1); // Also renders targetPage.
+
+signals:
+    void preloadFinished(int index);
+
+private slots:
+    void onPreloadFinished();
+
+private:
+    void discardPreload();
+    void adoptPreload();    // Move worker results into the render cache (once).
+    void retargetPreload(); // Finished job: render m_preloadTarget with its document.
+    static QVector<int> targetPages(int targetPage); // The target and the prefetch window after it.
+
+    struct PreloadJob;
+    static void preloadWorker(std::shared_ptr<PreloadJob> job);
+
+    QStringList m_files;
+    int m_currentIndex = -1;
+    RenderCache *m_renderCache = nullptr;
+
+    std::shared_ptr<PreloadJob> m_job; // Also held by the worker while it runs.
+    int m_preloadIndex = -1;
+    int m_preloadTarget = -1;
+    bool m_preloadAdopted = false;
+    bool m_retargetPending = false; // m_preloadTarget changed: render it once the job finishes
+    QFutureWatcher<void> m_preloadWatcher;
+};
+
+#endif // READINGQUEUE_H
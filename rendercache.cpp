@@ -0,0 +1,184 @@
+/**
+ * RenderCache implementation
+ * ---------------------------------------------------------------
+ * Thin wrapper over QCache (LRU with byte cost) plus a page probe table,
+ * in front of an optional SharedTileCache.
+ */
+
+#include "rendercache.h"
+#include "viewerconfig.h"
+
+RenderCache::RenderCache(qint64 budgetBytes)
+{
+    m_pixmaps.setMaxCost(budgetBytes);
+    m_probes.setMaxCost(MAX_PROBES);
+}
+
+// Page Identity ---------------------------------------------------
+
+PageProbe RenderCache::pageProbe(const QByteArray &documentKey, int pageIndex)
+{
+    if (documentKey.isEmpty())
+        return PageProbe();
+
+    const PageProbe *probe = m_probes.object(pageKey(documentKey, pageIndex));
+    return probe ? *probe : PageProbe();
+}
+
+void RenderCache::setPageProbe(const QByteArray &documentKey, int pageIndex, const PageProbe &probe)
+{
+    if (documentKey.isEmpty() || !probe.isValid())
+        return;
+
+    m_probes.insert(pageKey(documentKey, pageIndex), new PageProbe(probe));
+    updateAccounting();
+}
+
+// Rendered Pixmaps ------------------------------------------------
+
+QPixmap RenderCache::find(const QByteArray &documentKey, int pageIndex, int dpi)
+{
+    if (documentKey.isEmpty())
+        return QPixmap();
+
+    // QCache::object() moves the entry to the most recently used position
+    const QByteArray page = pageKey(documentKey, pageIndex);
+    if (const QPixmap *pixmap = m_pixmaps.object(pixmapKey(page, dpi)))
+        return *pixmap;
+
+    // Rendered by a neighbor process: a copy instead of a rasterization
+    if (!m_shared)
+        return QPixmap();
+
+    const QImage shared = m_shared->find(page, dpi);
+    if (shared.isNull())
+        return QPixmap();
+
+    const QPixmap pixmap = QPixmap::fromImage(shared);
+    insert(documentKey, pageIndex, dpi, pixmap);
+    return pixmap;
+}
+
+void RenderCache::insert(const QByteArray &documentKey, int pageIndex, int dpi, const QPixmap &pixmap,
+                         const QImage &image)
+{
+    if (documentKey.isEmpty() || pixmap.isNull())
+        return;
+
+    const qint64 cost = qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    const QByteArray page = pageKey(documentKey, pageIndex);
+
+    // QCache evicts LRU entries to make room (and drops pixmaps above the budget)
+    m_pixmaps.insert(pixmapKey(page, dpi), new QPixmap(pixmap), cost);
+    updateAccounting();
+
+    if (m_shared && !image.isNull())
+        m_shared->insert(page, dpi, image);
+}
+
+void RenderCache::renameDocument(const QByteArray &from, const QByteArray &to)
+{
+    if (from.isEmpty() || to.isEmpty() || from == to)
+        return;
+
+    // Keys start with the document key: a prefix scan finds its entries
+    const QByteArray prefix = from + '#';
+    const QList<QByteArray> probeKeys = m_probes.keys();
+    for (const QByteArray &key : probeKeys)
+    {
+        if (key.startsWith(prefix))
+            m_probes.insert(to + key.mid(from.size()), m_probes.take(key));
+    }
+
+    const QList<QByteArray> pixmapKeys = m_pixmaps.keys();
+    for (const QByteArray &key : pixmapKeys)
+    {
+        if (!key.startsWith(prefix))
+            continue;
+        const QPixmap *pixmap = m_pixmaps.object(key);
+        const qint64 cost = qint64(pixmap->width()) * pixmap->height() * pixmap->depth() / 8;
+        m_pixmaps.insert(to + key.mid(from.size()), m_pixmaps.take(key), cost);
+    }
+    updateAccounting();
+}
+
+// Render Context --------------------------------------------------
+
+void RenderCache::setContext(const QByteArray &context)
+{
+    m_context = context;
+    if (m_shared)
+        m_shared->setContext(context);
+}
+
+// Shared Tier -----------------------------------------------------
+
+bool RenderCache::setSharedTier(const QString &name, qint64 budgetBytes)
+{
+    if (budgetBytes <= 0)
+    {
+        m_shared.reset();
+        m_sharedName.clear();
+        m_sharedBudget = 0;
+        return true;
+    }
+
+    // Same segment: only the context may have changed (the creator fixed the size)
+    if (!m_shared || name != m_sharedName || budgetBytes != m_sharedBudget)
+    {
+        m_shared.reset(); // Unmap before mapping a replacement
+        m_shared = SharedTileCache::attach(name, budgetBytes);
+        m_sharedName = name;
+        m_sharedBudget = budgetBytes;
+    }
+
+    if (m_shared)
+        m_shared->setContext(m_context);
+    return m_shared != nullptr;
+}
+
+// DPI Ladder ------------------------------------------------------
+
+int RenderCache::ladderDpi(int dpi)
+{
+    // Configurable (render/dpi_ladder); the snapshot is safe on preload workers
+    const QVector<int> ladder = ViewerConfig::instance().settings().dpiLadder;
+    for (int step : ladder)
+    {
+        if (step >= dpi)
+            return step;
+    }
+    return dpi; // Past the top step a dedicated render beats a huge downscale
+}
+
+// Maintenance -----------------------------------------------------
+
+void RenderCache::clear()
+{
+    m_pixmaps.clear();
+    updateAccounting();
+}
+
+void RenderCache::setBudget(qint64 budgetBytes)
+{
+    m_pixmaps.setMaxCost(budgetBytes); // Trims immediately if now over budget
+    updateAccounting();
+}
+
+// Private Helpers -------------------------------------------------
+
+void RenderCache::updateAccounting()
+{
+    m_pixmapAccount.setBytes(usedBytes());
+    m_probeAccount.setBytes(m_probes.size() * PROBE_ENTRY_BYTES);
+}
+
+QByteArray RenderCache::pixmapKey(const QByteArray &pageKey, int dpi) const
+{
+    return pageKey + '@' + QByteArray::number(dpi) + '|' + m_context;
+}
+
+QByteArray RenderCache::pageKey(const QByteArray &documentKey, int pageIndex)
+{
+    return documentKey + '#' + QByteArray::number(pageIndex);
+}
@@ -0,0 +1,99 @@
+#ifndef RENDERCACHE_H
+#define RENDERCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QPixmap>
+#include <memory>
+#include "pageprobe.h"
+#include "memoryaccounting.h"
+#include "sharedtilecache.h"
+
+/**
+ * RenderCache
+ * ---------------------------------------------------------------
+ * Byte-budgeted cache of rendered pages, shared by content rather than path.
+ *
+ * Responsibilities:
+ *  - Map (document key, page index) to its PageProbe, so the same file
+ *    opened under another path reuses everything already known.
+ *  - Store one pixmap per (document key, page index, DPI, render context).
+ *    The document key is PDFDocument::renderKey(): content hash plus layer
+ *    state. The context is what else the pixels depend on (render hints,
+ *    display profile); both tiers key by it.
+ *  - Evict least recently used pixmaps once the byte budget is exceeded,
+ *    and the least recently used probes past MAX_PROBES.
+ *  - Quantize render DPIs to a ladder, so one render serves every zoom
+ *    level between two steps (downscaled by ImageScaler, then cached).
+ *  - Optionally back the pixmaps with a SharedTileCache: local misses look
+ *    there before rasterizing, and fresh renders are published to it.
+ *
+ * Design notes:
+ *  - GUI thread only (stores QPixmap).
+ *  - A context change needs no clear(): entries of the old context are
+ *    never found again and age out, and a render finishing late lands
+ *    under the context it was started with if its caller says so.
+ *  - Pixmaps are implicitly shared, so pages displaying the same entry
+ *    share one buffer.
+ *  - Reports to MemoryAccounting as "render-cache" and "page-probes".
+ */
+class RenderCache
+{
+public:
+    explicit RenderCache(qint64 budgetBytes = DEFAULT_BUDGET);
+
+    // Page identity -------------------------------------------------
+    PageProbe pageProbe(const QByteArray &documentKey, int pageIndex); // Invalid if unknown.
+    void setPageProbe(const QByteArray &documentKey, int pageIndex, const PageProbe &probe);
+
+    // Rendered pixmaps ----------------------------------------------
+    // Null pixmap on miss (local, then shared tier).
+    QPixmap find(const QByteArray &documentKey, int pageIndex, int dpi);
+    void insert(const QByteArray &documentKey, int pageIndex, int dpi, const QPixmap &pixmap,
+                const QImage &image = QImage()); // image: publish to the shared tier too.
+
+    // Move everything cached under one document key to another (the
+    // provisional identity of a file, once its content hash is known).
+    void renameDocument(const QByteArray &from, const QByteArray &to);
+
+    // Render context ------------------------------------------------
+    void setContext(const QByteArray &context); // Hints + display profile of every find()/insert() from now on.
+    QByteArray context() const { return m_context; } // Record before an async render; compare on completion.
+
+    // Shared tier ---------------------------------------------------
+    // Attach (or re-attach) to a cross-process segment; 0 bytes detaches.
+    bool setSharedTier(const QString &name, qint64 budgetBytes);
+    SharedTileCache *sharedTier() const { return m_shared.get(); }
+
+    // DPI ladder ----------------------------------------------------
+    static int ladderDpi(int dpi); // Smallest ViewerConfig ladder step >= dpi; dpi itself above the top step.
+
+    // Maintenance ---------------------------------------------------
+    void clear(); // Drops pixmaps only; probes stay valid.
+    void setBudget(qint64 budgetBytes);
+    qint64 budget() const { return m_pixmaps.maxCost(); }
+    qint64 usedBytes() const { return m_pixmaps.totalCost(); }
+
+    static constexpr qint64 DEFAULT_BUDGET = 256ll * 1024 * 1024;
+    static constexpr int MAX_PROBES = 100000; // ~16 MB of probes
+
+private:
+    QByteArray pixmapKey(const QByteArray &pageKey, int dpi) const;
+    static QByteArray pageKey(const QByteArray &documentKey, int pageIndex);
+    void updateAccounting();
+
+    QCache<QByteArray, QPixmap> m_pixmaps;   // find() refreshes LRU order.
+    QCache<QByteArray, PageProbe> m_probes;  // pageKey -> probe, cost 1 each
+    QByteArray m_context;                   // Part of every pixmap key
+    std::unique_ptr<SharedTileCache> m_shared; // Optional second tier
+    QString m_sharedName;                   // As configured (empty: per user)
+    qint64 m_sharedBudget = 0;
+
+    MemoryAccount m_pixmapAccount{"render-cache"};
+    MemoryAccount m_probeAccount{"page-probes"};
+
+    // Approximate per-probe footprint: key, flags, color, cache node
+    static constexpr qint64 PROBE_ENTRY_BYTES = 160;
+};
+
+#endif // RENDERCACHE_H
@@ -0,0 +1,143 @@
+/**
+ * RenderPolicy implementation
+ * ---------------------------------------------------------------
+ * The built-in policies:
+ *  - window:        the historical heuristic, a fixed page window around
+ *                   an average-height estimate, top to bottom.
+ *  - visible_first: pages actually on screen (from the layout), nearest
+ *                   to the centre first, then the window alternating
+ *                   below and above.
+ *  - directional:   visible first, then a doubled window ahead of the
+ *                   scroll; nothing behind while scrolling fast.
+ */
+
+#include "renderpolicy.h"
+#include "pagelayout.h"
+#include <QPair>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Exact visible range when the layout knows every page; else the estimate
+    QPair<int, int> visibleRange(const RenderView &view)
+    {
+        if (view.layout && view.layout->pageCount() == view.pageCount)
+        {
+            const QPair<int, int> range =
+                view.layout->pagesBetween(view.scrollValue, view.scrollValue + view.viewportHeight);
+            if (range.first >= 0)
+                return range;
+        }
+        return PageLayout::estimatedVisibleRange(view.scrollValue, view.viewportHeight, 0,
+                                                 RenderPolicy::AVG_PAGE_HEIGHT, view.pageCount);
+    }
+
+    // On-screen pages, the one under the viewport centre first
+    QVector<int> visiblePages(const RenderView &view, const QPair<int, int> &range)
+    {
+        QVector<int> pages;
+        for (int i = range.first; i <= range.second; ++i)
+            pages.append(i);
+
+        const int centre = view.layout && view.layout->pageCount() == view.pageCount
+                               ? view.layout->currentPage(view.scrollValue, view.viewportHeight)
+                               : (range.first + range.second) / 2;
+        std::stable_sort(pages.begin(), pages.end(), [centre](int a, int b)
+                         { return std::abs(a - centre) < std::abs(b - centre); });
+        return pages;
+    }
+
+    class WindowPolicy : public RenderPolicy
+    {
+    public:
+        QString name() const override { return "window"; }
+
+        QVector<int> pagesToRender(const RenderView &view) const override
+        {
+            const QPair<int, int> range = PageLayout::estimatedVisibleRange(
+                view.scrollValue, view.viewportHeight, view.window, AVG_PAGE_HEIGHT, view.pageCount);
+
+            QVector<int> pages;
+            for (int i = range.first; i <= range.second; ++i)
+                pages.append(i);
+            return pages;
+        }
+    };
+
+    class VisibleFirstPolicy : public RenderPolicy
+    {
+    public:
+        QString name() const override { return "visible_first"; }
+
+        QVector<int> pagesToRender(const RenderView &view) const override
+        {
+            if (view.pageCount <= 0)
+                return QVector<int>();
+
+            const QPair<int, int> range = visibleRange(view);
+            QVector<int> pages = visiblePages(view, range);
+
+            // Reading goes down: the next page below wins a tie
+            for (int distance = 1; distance <= view.window; ++distance)
+            {
+                if (range.second + distance < view.pageCount)
+                    pages.append(range.second + distance);
+                if (range.first - distance >= 0)
+                    pages.append(range.first - distance);
+            }
+            return pages;
+        }
+    };
+
+    class DirectionalPolicy : public RenderPolicy
+    {
+    public:
+        QString name() const override { return "directional"; }
+
+        QVector<int> pagesToRender(const RenderView &view) const override
+        {
+            if (view.pageCount <= 0)
+                return QVector<int>();
+
+            const QPair<int, int> range = visibleRange(view);
+            QVector<int> pages = visiblePages(view, range);
+
+            const bool up = view.velocity < 0.0;
+            const bool fast = std::abs(view.velocity) >= FAST_SCROLL;
+            const int ahead = 2 * view.window;
+            const int behind = fast ? 0 : qMin(1, view.window);
+
+            for (int distance = 1; distance <= ahead; ++distance)
+            {
+                const int page = up ? range.first - distance : range.second + distance;
+                if (page >= 0 && page < view.pageCount)
+                    pages.append(page);
+            }
+            for (int distance = 1; distance <= behind; ++distance)
+            {
+                const int page = up ? range.second + distance : range.first - distance;
+                if (page >= 0 && page < view.pageCount)
+                    pages.append(page);
+            }
+            return pages;
+        }
+    };
+}
+
+// Factory ----------------------------------------------------------
+std::unique_ptr<RenderPolicy> RenderPolicy::create(const QString &name)
+{
+    if (name == "window")
+        return std::make_unique<WindowPolicy>();
+    if (name == "visible_first")
+        return std::make_unique<VisibleFirstPolicy>();
+    if (name == "directional")
+        return std::make_unique<DirectionalPolicy>();
+    return nullptr;
+}
+
+QStringList RenderPolicy::names()
+{
+    return {"window", "visible_first", "directional"};
+}
@@ -0,0 +1,59 @@
+#ifndef RENDERPOLICY_H
+#define RENDERPOLICY_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+
+class PageLayout;
+
+/**
+ * RenderView
+ * What a policy may look at: the viewport, how fast it moves and the
+ * page column as currently laid out.
+ */
+struct RenderView
+{
+    int scrollValue = 0;
+    int viewportHeight = 0;
+    double velocity = 0.0; // Pixels per second, positive when scrolling down
+    int window = 2;        // prefetch/window_pages
+    int pageCount = 0;
+    const PageLayout *layout = nullptr; // May be null or stale (sizes of unrendered pages)
+};
+
+/**
+ * RenderPolicy
+ * ---------------------------------------------------------------
+ * Which pages to render for a viewport, and in which order.
+ *
+ * Responsibilities:
+ *  - Turn a RenderView into a list of page indices, most urgent first.
+ *  - Name the built-in policies, so ViewerConfig (prefetch/policy) and
+ *    benchmarks/schedsim pick them by the same name.
+ *
+ * Design notes:
+ *  - Pure functions of the view: no widgets, no clock, no document. The
+ *    live viewer (PageManager) renders each list in one synchronous pass
+ *    on the GUI thread, and benchmarks/schedsim replays traces through
+ *    the same objects in the same kind of pass, freezing frames while it
+ *    lasts.
+ *  - Pages already rendered may be listed; callers skip them cheaply.
+ */
+class RenderPolicy
+{
+public:
+    virtual ~RenderPolicy() = default;
+
+    virtual QString name() const = 0;
+    virtual QVector<int> pagesToRender(const RenderView &view) const = 0; // Most urgent first, no duplicates.
+
+    static std::unique_ptr<RenderPolicy> create(const QString &name); // nullptr if unknown.
+    static QStringList names();                                       // Built-in policies, default first.
+
+    static constexpr int AVG_PAGE_HEIGHT = 600; // "window": page height assumed instead of the layout
+    static constexpr double FAST_SCROLL = 800.0; // px/s: "directional" stops rendering behind the viewport
+};
+
+#endif // RENDERPOLICY_H
@@ -0,0 +1,102 @@
+/**
+ * ScrollTrace implementation
+ * ---------------------------------------------------------------
+ * Plain CSV with '#' comment lines; the header row is skipped on load.
+ */
+
+#include "scrolltrace.h"
+#include <QTextStream>
+
+static const char HEADER[] = "ms,scroll,viewport_height,dpi\n";
+
+// Recording --------------------------------------------------------
+bool ScrollTrace::open(const QString &filePath)
+{
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        return false;
+    }
+
+    m_file.write(HEADER);
+    m_clock.start();
+    m_documents = 0;
+    return true;
+}
+
+void ScrollTrace::beginDocument(const QString &name, int pageCount)
+{
+    if (!isOpen())
+    {
+        return;
+    }
+
+    m_file.write(QString("# document %1 %2 (%3 pages)\n")
+                     .arg(m_documents++)
+                     .arg(name)
+                     .arg(pageCount)
+                     .toUtf8());
+}
+
+void ScrollTrace::record(int scrollValue, int viewportHeight, int dpi)
+{
+    if (!isOpen())
+    {
+        return;
+    }
+
+    m_file.write(QByteArray::number(m_clock.elapsed()) + ',' + QByteArray::number(scrollValue) + ',' +
+                 QByteArray::number(viewportHeight) + ',' + QByteArray::number(dpi) + '\n');
+}
+
+// Loading ----------------------------------------------------------
+QVector<ScrollSample> ScrollTrace::load(const QString &filePath, QString *error)
+{
+    QVector<ScrollSample> samples;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        if (error)
+            *error = file.errorString();
+        return samples;
+    }
+
+    int document = -1; // Rows before the first marker count as document 0
+    int lineNumber = 0;
+    QTextStream in(&file);
+    while (!in.atEnd())
+    {
+        const QString line = in.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith("ms,")) // Blank or header row
+            continue;
+
+        if (line.startsWith("# document"))
+        {
+            ++document;
+            continue;
+        }
+        if (line.startsWith('#'))
+            continue;
+
+        const QStringList fields = line.split(',');
+        bool ok[4] = {false, false, false, false};
+        ScrollSample sample;
+        if (fields.size() == 4)
+        {
+            sample.ms = fields[0].toLongLong(&ok[0]);
+            sample.scrollValue = fields[1].toInt(&ok[1]);
+            sample.viewportHeight = fields[2].toInt(&ok[2]);
+            sample.dpi = fields[3].toInt(&ok[3]);
+        }
+        if (!ok[0] || !ok[1] || !ok[2] || !ok[3] || sample.dpi <= 0)
+        {
+            if (error)
+                *error = QString("%1:%2: expected ms,scroll,viewport_height,dpi").arg(filePath).arg(lineNumber);
+            return QVector<ScrollSample>();
+        }
+        sample.document = qMax(0, document);
+        samples.append(sample);
+    }
+    return samples;
+}
@@ -0,0 +1,56 @@
+#ifndef SCROLLTRACE_H
+#define SCROLLTRACE_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+/**
+ * ScrollSample
+ * One render pass request: where the viewport was, and at which DPI.
+ */
+struct ScrollSample
+{
+    qint64 ms = 0;       // Since the trace was opened
+    int document = 0;    // Index of the "# document" section it belongs to
+    int scrollValue = 0;
+    int viewportHeight = 0;
+    int dpi = 0;
+};
+
+/**
+ * ScrollTrace
+ * ---------------------------------------------------------------
+ * Recording of what the viewer asked its render policy, for replay by
+ * benchmarks/schedsim (PDV_SCROLL_TRACE=<file> turns recording on).
+ *
+ * Responsibilities:
+ *  - Append one CSV row per render pass: ms,scroll,viewport_height,dpi.
+ *  - Mark each opened document with a "# document" comment line, so one
+ *    session can be replayed per document.
+ *  - Read such a file back.
+ *
+ * Design notes:
+ *  - Qt Core only: the simulator links it without widgets.
+ *  - Rows are buffered; the file is complete once the viewer exits.
+ */
+class ScrollTrace
+{
+public:
+    bool open(const QString &filePath); // Truncates; false if it cannot be written.
+    bool isOpen() const { return m_file.isOpen(); }
+
+    void beginDocument(const QString &name, int pageCount);
+    void record(int scrollValue, int viewportHeight, int dpi);
+
+    // Samples of every document, in file order; empty + error on failure.
+    static QVector<ScrollSample> load(const QString &filePath, QString *error = nullptr);
+
+private:
+    QFile m_file;
+    QElapsedTimer m_clock;
+    int m_documents = 0;
+};
+
+#endif // SCROLLTRACE_H
@@ -0,0 +1,238 @@
+/**
+ * SearchPanel implementation
+ * ---------------------------------------------------------------
+ * Query box, ranked result list and a status line; the ranking lives in
+ * a small list model that inserts each streamed hit at its final place.
+ */
+
+#include "searchpanel.h"
+#include <QAbstractListModel>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QSet>
+#include <QSpinBox>
+#include <QVBoxLayout>
+#include <algorithm>
+
+/**
+ * SearchResultsModel
+ * Hits of one query, kept sorted: score first, then document order, then page.
+ */
+class SearchResultsModel : public QAbstractListModel
+{
+public:
+    using QAbstractListModel::QAbstractListModel;
+
+    void reset(const QVector<SearchSource> &sources)
+    {
+        beginResetModel();
+        m_sources = sources;
+        m_hits.clear();
+        m_totalHits = 0;
+        m_documentsWithHits.clear();
+        endResetModel();
+    }
+
+    void addHits(const QVector<SearchHit> &hits)
+    {
+        for (const SearchHit &hit : hits)
+        {
+            ++m_totalHits;
+            m_documentsWithHits.insert(hit.source);
+
+            const auto position = std::upper_bound(m_hits.begin(), m_hits.end(), hit, &SearchResultsModel::ranksBefore);
+            const int row = int(position - m_hits.begin());
+            if (row >= SearchPanel::MAX_RESULTS)
+                continue;
+
+            beginInsertRows(QModelIndex(), row, row);
+            m_hits.insert(row, hit);
+            endInsertRows();
+
+            if (m_hits.size() > SearchPanel::MAX_RESULTS)
+            {
+                beginRemoveRows(QModelIndex(), m_hits.size() - 1, m_hits.size() - 1);
+                m_hits.removeLast();
+                endRemoveRows();
+            }
+        }
+    }
+
+    const SearchHit *hit(const QModelIndex &index) const
+    {
+        return index.isValid() && index.row() < m_hits.size() ? &m_hits[index.row()] : nullptr;
+    }
+
+    SearchSource source(const SearchHit &hit) const { return m_sources.value(hit.source); }
+    int totalHits() const { return m_totalHits; }
+    int documentsWithHits() const { return m_documentsWithHits.size(); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : m_hits.size();
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        const SearchHit *result = hit(index);
+        if (!result)
+            return QVariant();
+
+        const SearchSource &source = m_sources[result->source];
+        switch (role)
+        {
+        case Qt::DisplayRole:
+            return QString("%1 - page %2 (%3)\n%4")
+                .arg(source.title)
+                .arg(result->page + 1)
+                .arg(result->matches)
+                .arg(result->snippet);
+        case Qt::ToolTipRole:
+            return source.filePath.isEmpty() ? source.title : source.filePath;
+        default:
+            return QVariant();
+        }
+    }
+
+private:
+    static bool ranksBefore(const SearchHit &a, const SearchHit &b)
+    {
+        if (a.score != b.score)
+            return a.score > b.score;
+        if (a.source != b.source)
+            return a.source < b.source;
+        return a.page < b.page;
+    }
+
+    QVector<SearchSource> m_sources; // Snapshot the hits refer to
+    QVector<SearchHit> m_hits;
+    int m_totalHits = 0; // Including those beyond MAX_RESULTS
+    QSet<int> m_documentsWithHits;
+};
+
+// Construction -----------------------------------------------------
+SearchPanel::SearchPanel(QWidget *parent)
+    : QDockWidget(tr("Search"), parent), m_query(new QLineEdit()), m_typos(new QSpinBox()), m_results(new QListView()),
+      m_status(new QLabel()), m_model(new SearchResultsModel(this)), m_search(new DocumentSearch(this))
+{
+    setObjectName("searchPanel");
+
+    QWidget *content = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(content);
+    m_query->setPlaceholderText(tr("Search all open documents"));
+    m_query->setClearButtonEnabled(true);
+    m_typos->setRange(0, MAX_TYPOS);
+    m_typos->setPrefix(tr("Typos: "));
+    m_typos->setToolTip(tr("Accept matches with up to this many wrong, missing or extra characters (OCR noise)"));
+    m_results->setModel(m_model);
+    m_results->setWordWrap(true);
+    m_results->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    QHBoxLayout *queryRow = new QHBoxLayout();
+    queryRow->addWidget(m_query, 1);
+    queryRow->addWidget(m_typos);
+    layout->addLayout(queryRow);
+    layout->addWidget(m_results);
+    layout->addWidget(m_status);
+    setWidget(content);
+
+    // Search as the user types, once typing pauses
+    m_delay.setSingleShot(true);
+    m_delay.setInterval(SEARCH_DELAY_MS);
+    connect(m_query, &QLineEdit::textChanged, &m_delay, qOverload<>(&QTimer::start));
+    connect(m_query, &QLineEdit::returnPressed, this, &SearchPanel::startSearch);
+    connect(&m_delay, &QTimer::timeout, this, &SearchPanel::startSearch);
+    connect(m_typos, qOverload<int>(&QSpinBox::valueChanged), this, &SearchPanel::startSearch);
+
+    connect(m_search, &DocumentSearch::hitsFound, this, &SearchPanel::onHitsFound);
+    connect(m_search, &DocumentSearch::finished, this, &SearchPanel::onFinished);
+
+    connect(m_results->selectionModel(), &QItemSelectionModel::currentChanged, this, &SearchPanel::onCurrentChanged);
+    connect(m_results, &QListView::clicked, this, &SearchPanel::onActivated);
+    connect(m_results, &QListView::activated, this, &SearchPanel::onActivated);
+}
+
+// Sources ----------------------------------------------------------
+void SearchPanel::setSources(const QVector<SearchSource> &sources)
+{
+    const bool changed = !sameDocuments(m_sources, sources);
+    m_sources = sources;
+
+    if (changed && m_query->text().trimmed().size() >= MIN_QUERY_LENGTH)
+    {
+        startSearch();
+    }
+}
+
+void SearchPanel::focusQuery()
+{
+    m_query->setFocus();
+    m_query->selectAll();
+}
+
+bool SearchPanel::sameDocuments(const QVector<SearchSource> &a, const QVector<SearchSource> &b)
+{
+    // Hashes fill in as queued documents get opened: not a different set
+    auto same = [](const SearchSource &x, const SearchSource &y)
+    {
+        if (x.queueIndex != y.queueIndex || x.filePath != y.filePath)
+            return false;
+        return !x.filePath.isEmpty() || x.contentHash == y.contentHash;
+    };
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), same);
+}
+
+// Searching --------------------------------------------------------
+void SearchPanel::startSearch()
+{
+    m_delay.stop();
+    m_model->reset(m_sources);
+
+    const QString query = m_query->text().trimmed();
+    if (query.size() < MIN_QUERY_LENGTH)
+    {
+        m_search->cancel();
+        m_status->clear();
+        return;
+    }
+
+    m_status->setText(tr("Searching %1 documents...").arg(m_sources.size()));
+    m_search->start(query, m_sources, m_typos->value());
+}
+
+void SearchPanel::onHitsFound(const QVector<SearchHit> &hits)
+{
+    m_model->addHits(hits);
+}
+
+void SearchPanel::onFinished(int documentCount, qint64 elapsedMs)
+{
+    if (m_query->text().trimmed().size() < MIN_QUERY_LENGTH)
+    {
+        return;
+    }
+
+    m_status->setText(tr("%1 pages in %2 of %3 documents (%4 ms)")
+                          .arg(m_model->totalHits())
+                          .arg(m_model->documentsWithHits())
+                          .arg(documentCount)
+                          .arg(elapsedMs));
+}
+
+// Results ----------------------------------------------------------
+void SearchPanel::onCurrentChanged(const QModelIndex &current)
+{
+    if (const SearchHit *hit = m_model->hit(current))
+    {
+        emit resultHighlighted(m_model->source(*hit), hit->page);
+    }
+}
+
+void SearchPanel::onActivated(const QModelIndex &index)
+{
+    if (const SearchHit *hit = m_model->hit(index))
+    {
+        emit resultActivated(m_model->source(*hit), hit->page);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef SEARCHPANEL_H
+#define SEARCHPANEL_H
+
+#include <QDockWidget>
+#include <QTimer>
+#include <QVector>
+#include "documentsearch.h"
+
+class QLabel;
+class QLineEdit;
+class QListView;
+class QSpinBox;
+class QModelIndex;
+class SearchResultsModel;
+
+/**
+ * SearchPanel
+ * ---------------------------------------------------------------
+ * Dock with one query box searching every open document at once.
+ *
+ * Responsibilities:
+ *  - Run DocumentSearch over the current sources as the user types
+ *    (debounced), tolerating up to "Typos" edits per match, and show
+ *    hits from all documents as one list ranked by score, updated while
+ *    results stream in.
+ *  - Report the highlighted result (so its page can be prefetched) and
+ *    the clicked one (so the window can switch document and page).
+ *
+ * Design notes:
+ *  - Sources are snapshotted per query: a hit always refers to the
+ *    document it was found in, even if the window moves on.
+ *  - The list keeps at most MAX_RESULTS hits, dropping the lowest ranked.
+ */
+class SearchPanel : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SearchPanel(QWidget *parent = nullptr);
+
+    void setSources(const QVector<SearchSource> &sources); // Re-runs the query if the document set changed.
+    void focusQuery();
+
+    static constexpr int SEARCH_DELAY_MS = 250;
+    static constexpr int MIN_QUERY_LENGTH = 2;
+    static constexpr int MAX_RESULTS = 2000;
+    static constexpr int MAX_TYPOS = 3;
+
+signals:
+    void resultHighlighted(const SearchSource &source, int pageIndex); // Keyboard or mouse selection.
+    void resultActivated(const SearchSource &source, int pageIndex);   // Click or Enter.
+
+private slots:
+    void startSearch();
+    void onHitsFound(const QVector<SearchHit> &hits);
+    void onFinished(int documentCount, qint64 elapsedMs);
+    void onCurrentChanged(const QModelIndex &current);
+    void onActivated(const QModelIndex &index);
+
+private:
+    static bool sameDocuments(const QVector<SearchSource> &a, const QVector<SearchSource> &b);
+
+    QLineEdit *m_query;
+    QSpinBox *m_typos; // Edit distance tolerated per match
+    QListView *m_results;
+    QLabel *m_status;
+    SearchResultsModel *m_model;
+    DocumentSearch *m_search;
+    QTimer m_delay;
+    QVector<SearchSource> m_sources;
+};
+
+#endif // SEARCHPANEL_H
@@ -0,0 +1,572 @@
+/**
+ * SharedTileCache implementation
+ * ---------------------------------------------------------------
+ * Segment layout: header | slot table | free-list links | tile blocks.
+ * Every cross-process field is a lock-free std::atomic; plain slot fields
+ * are written only while the slot is BUSY and published by its state word.
+ */
+
+#include "sharedtilecache.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::atomic<quint64>::is_always_lock_free, "shared segment needs address-free 64-bit atomics");
+static_assert(std::atomic<quint32>::is_always_lock_free, "shared segment needs address-free 32-bit atomics");
+
+namespace
+{
+    constexpr quint32 MAGIC = 0x50445654; // "PDVT"
+    constexpr quint32 VERSION = 1;
+    constexpr quint32 NO_BLOCK = 0xFFFFFFFFu;
+    constexpr int DIGEST_BYTES = 20; // SHA-1
+
+    // Slot state word: READY + n means n readers are copying the tile out
+    constexpr quint32 SLOT_EMPTY = 0; // Never used: ends every probe chain
+    constexpr quint32 SLOT_DEAD = 1;  // Evicted: reusable, chains run on
+    constexpr quint32 SLOT_BUSY = 2;  // Being written or evicted
+    constexpr quint32 SLOT_READY = 3;
+
+    quint64 alignUp(quint64 value, quint64 alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // splitmix64 finalizer: digest prefix, DPI and tile spread over the table
+    quint64 mix(quint64 value)
+    {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ull;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+}
+
+struct SharedTileCache::Header
+{
+    std::atomic<quint32> magic; // Stored last by the creator
+    quint32 version;
+    quint64 segmentBytes;
+    quint32 slotCount; // Power of two
+    quint32 blockCount;
+    quint64 slotsOffset;
+    quint64 linksOffset;
+    quint64 blocksOffset;
+    std::atomic<quint64> freeHead; // ABA tag << 32 | first free block
+    std::atomic<quint32> clockHand;
+    std::atomic<quint32> usedBlocks;
+};
+
+struct SharedTileCache::Slot
+{
+    std::atomic<quint32> state;
+    std::atomic<quint32> recent; // CLOCK reference bit
+    std::atomic<quint64> hash;   // Cheap filter before taking a reference
+    char digest[DIGEST_BYTES];
+    qint32 dpi;
+    qint32 tile; // Row-major index in the page's tile grid
+    qint32 imageWidth;
+    qint32 imageHeight;
+    qint32 format; // QImage::Format, 32 bits per pixel
+    quint32 block;
+};
+
+struct SharedTileCache::TileKey
+{
+    quint64 hash = 0;
+    char digest[DIGEST_BYTES] = {};
+    qint32 dpi = 0;
+    qint32 tile = 0;
+};
+
+// Attaching --------------------------------------------------------
+SharedTileCache::~SharedTileCache()
+{
+#ifdef Q_OS_UNIX
+    if (m_base)
+    {
+        ::munmap(m_base, size_t(m_mappedBytes));
+    }
+#endif
+}
+
+QString SharedTileCache::defaultName()
+{
+#ifdef Q_OS_UNIX
+    return QString("/pdv-tiles-%1").arg(::getuid());
+#else
+    return QString();
+#endif
+}
+
+std::unique_ptr<SharedTileCache> SharedTileCache::attach(const QString &name, qint64 budgetBytes)
+{
+#ifdef Q_OS_UNIX
+    const qint64 blocks = budgetBytes / TILE_BYTES;
+    if (blocks < MIN_BLOCKS || blocks >= NO_BLOCK)
+    {
+        qWarning() << "SharedTileCache: budget of" << budgetBytes << "bytes is out of range";
+        return nullptr;
+    }
+
+    // Planned layout; a neighbor's segment may have been planned differently
+    quint32 slotCount = 1;
+    while (slotCount < 2 * blocks)
+        slotCount <<= 1;
+    const quint64 slotsOffset = alignUp(sizeof(Header), 64);
+    const quint64 linksOffset = alignUp(slotsOffset + quint64(slotCount) * sizeof(Slot), 64);
+    const quint64 blocksOffset = alignUp(linksOffset + quint64(blocks) * sizeof(quint32), 4096);
+    const quint64 segmentBytes = blocksOffset + quint64(blocks) * TILE_BYTES;
+
+    const bool perUser = name.isEmpty();
+    auto cache = std::unique_ptr<SharedTileCache>(new SharedTileCache());
+    cache->m_name = perUser ? defaultName() : name;
+    const QByteArray path = cache->m_name.toLocal8Bit();
+    const mode_t mode = perUser ? 0600 : 0660;
+
+    int fd = ::shm_open(path.constData(), O_RDWR | O_CREAT | O_EXCL, mode);
+    const bool creator = fd >= 0;
+    if (creator)
+    {
+        ::fchmod(fd, mode); // Not narrowed by the umask
+        if (::ftruncate(fd, off_t(segmentBytes)) != 0)
+        {
+            qWarning() << "SharedTileCache: cannot size" << cache->m_name << "-" << strerror(errno);
+            ::close(fd);
+            ::shm_unlink(path.constData());
+            return nullptr;
+        }
+    }
+    else if (errno == EEXIST)
+    {
+        fd = ::shm_open(path.constData(), O_RDWR, 0);
+    }
+    if (fd < 0)
+    {
+        qWarning() << "SharedTileCache: cannot open" << cache->m_name << "-" << strerror(errno);
+        return nullptr;
+    }
+
+    // A neighbor may be between shm_open() and ftruncate()
+    QElapsedTimer waited;
+    waited.start();
+    struct stat status = {};
+    while (::fstat(fd, &status) == 0 && quint64(status.st_size) < sizeof(Header) &&
+           waited.elapsed() < ATTACH_TIMEOUT_MS)
+    {
+        QThread::msleep(10);
+    }
+    if (quint64(status.st_size) < sizeof(Header))
+    {
+        qWarning() << "SharedTileCache:" << cache->m_name << "was never sized; remove it from /dev/shm";
+        ::close(fd);
+        return nullptr;
+    }
+
+    cache->m_mappedBytes = status.st_size;
+    void *base = ::mmap(nullptr, size_t(status.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED)
+    {
+        qWarning() << "SharedTileCache: cannot map" << cache->m_name << "-" << strerror(errno);
+        return nullptr;
+    }
+    cache->m_base = base;
+    cache->m_header = static_cast<Header *>(base);
+    Header *header = cache->m_header;
+
+    if (creator)
+    {
+        // ftruncate() zero-filled the table: every slot starts EMPTY
+        header->version = VERSION;
+        header->segmentBytes = segmentBytes;
+        header->slotCount = slotCount;
+        header->blockCount = quint32(blocks);
+        header->slotsOffset = slotsOffset;
+        header->linksOffset = linksOffset;
+        header->blocksOffset = blocksOffset;
+
+        auto *links = reinterpret_cast<std::atomic<quint32> *>(static_cast<char *>(base) + linksOffset);
+        for (quint32 block = 0; block < blocks; ++block)
+        {
+            links[block].store(block + 1 < blocks ? block + 1 : NO_BLOCK, std::memory_order_relaxed);
+        }
+        header->freeHead.store(0, std::memory_order_relaxed);
+        header->magic.store(MAGIC, std::memory_order_release);
+
+        cache->m_slotCount = slotCount;
+        cache->m_blockCount = quint32(blocks);
+        cache->m_slotsOffset = slotsOffset;
+        cache->m_linksOffset = linksOffset;
+        cache->m_blocksOffset = blocksOffset;
+
+        qInfo() << "SharedTileCache: created" << cache->m_name << "with" << (cache->budget() >> 20) << "MiB";
+        return cache;
+    }
+
+    while (header->magic.load(std::memory_order_acquire) != MAGIC && waited.elapsed() < ATTACH_TIMEOUT_MS)
+    {
+        QThread::msleep(10);
+    }
+
+    // Written by another build or never finished: leave it to its owner.
+    // One snapshot of the layout, checked against the mapping we really have.
+    const quint32 slots = header->slotCount;
+    const quint32 blockCount = header->blockCount;
+    const quint64 slotsAt = header->slotsOffset;
+    const quint64 linksAt = header->linksOffset;
+    const quint64 blocksAt = header->blocksOffset;
+    const quint64 mapped = quint64(status.st_size);
+    const bool compatible = header->magic.load(std::memory_order_acquire) == MAGIC && header->version == VERSION &&
+                            header->segmentBytes == mapped && blockCount > 0 && blockCount < NO_BLOCK &&
+                            slots > 0 && (slots & (slots - 1)) == 0 && slots <= mapped / sizeof(Slot) &&
+                            blockCount <= mapped / TILE_BYTES && slotsAt >= sizeof(Header) &&
+                            slotsAt % alignof(Slot) == 0 && linksAt % alignof(std::atomic<quint32>) == 0 &&
+                            slotsAt + quint64(slots) * sizeof(Slot) <= linksAt &&
+                            linksAt + quint64(blockCount) * sizeof(quint32) <= blocksAt &&
+                            blocksAt <= mapped && quint64(blockCount) * TILE_BYTES <= mapped - blocksAt;
+    if (!compatible)
+    {
+        qWarning() << "SharedTileCache:" << cache->m_name << "has an unknown layout; not sharing renders";
+        return nullptr;
+    }
+    cache->m_slotCount = slots;
+    cache->m_blockCount = blockCount;
+    cache->m_slotsOffset = slotsAt;
+    cache->m_linksOffset = linksAt;
+    cache->m_blocksOffset = blocksAt;
+
+    qInfo() << "SharedTileCache: attached to" << cache->m_name << "with" << (cache->budget() >> 20) << "MiB";
+    return cache;
+#else
+    Q_UNUSED(name);
+    Q_UNUSED(budgetBytes);
+    return nullptr;
+#endif
+}
+
+qint64 SharedTileCache::budget() const
+{
+    return m_header ? qint64(m_blockCount) * TILE_BYTES : 0;
+}
+
+qint64 SharedTileCache::usedBytes() const
+{
+    return m_header ? qint64(m_header->usedBlocks.load(std::memory_order_relaxed)) * TILE_BYTES : 0;
+}
+
+// Lookup -----------------------------------------------------------
+QImage SharedTileCache::find(const QByteArray &pageKey, int dpi) const
+{
+    if (!m_header || pageKey.isEmpty())
+    {
+        return QImage();
+    }
+
+    // The first tile tells the page size; every other one must agree
+    QImage image;
+    int columns = 0;
+    int tiles = 1;
+    for (int tile = 0; tile < tiles; ++tile)
+    {
+        Slot *slot = acquire(tileKey(pageKey, dpi, tile));
+        if (!slot)
+        {
+            return QImage();
+        }
+
+        // Copied once: another process may rewrite the slot under a bad reference
+        const qint32 imageWidth = slot->imageWidth;
+        const qint32 imageHeight = slot->imageHeight;
+        const qint32 format = slot->format;
+        const quint32 block = slot->block;
+
+        if (tile == 0)
+        {
+            // Sizes insert() would have accepted only: no huge allocation on a bad slot
+            const qint64 tileColumns = (qint64(imageWidth) + TILE_SIZE - 1) / TILE_SIZE;
+            const qint64 tileRows = (qint64(imageHeight) + TILE_SIZE - 1) / TILE_SIZE;
+            if (imageWidth <= 0 || imageHeight <= 0 || !isStoredFormat(format) ||
+                tileColumns * tileRows > qint64(m_blockCount) / 2)
+            {
+                release(slot);
+                return QImage();
+            }
+            image = QImage(imageWidth, imageHeight, QImage::Format(format));
+            if (image.isNull())
+            {
+                release(slot);
+                return QImage();
+            }
+            columns = int(tileColumns);
+            tiles = int(tileColumns * tileRows);
+        }
+        else if (imageWidth != image.width() || imageHeight != image.height() || format != int(image.format()))
+        {
+            release(slot);
+            return QImage();
+        }
+
+        // Tiles are stored packed: width * 4 bytes per row, within one block
+        const int x = tile % columns * TILE_SIZE;
+        const int y = tile / columns * TILE_SIZE;
+        const int width = qMin(TILE_SIZE, image.width() - x);
+        const int height = qMin(TILE_SIZE, image.height() - y);
+        if (!isBlock(block) || qint64(width) * height * 4 > TILE_BYTES)
+        {
+            release(slot);
+            return QImage();
+        }
+        const uchar *source = blockAt(block);
+        for (int row = 0; row < height; ++row)
+        {
+            std::memcpy(image.scanLine(y + row) + x * 4, source + row * width * 4, size_t(width) * 4);
+        }
+        release(slot);
+    }
+    return image;
+}
+
+SharedTileCache::Slot *SharedTileCache::acquire(const TileKey &key) const
+{
+    const quint32 mask = m_slotCount - 1;
+    for (int probe = 0; probe < MAX_PROBES; ++probe)
+    {
+        Slot *slot = slotAt(quint32(key.hash + probe) & mask);
+        quint32 state = slot->state.load(std::memory_order_acquire);
+        if (state == SLOT_EMPTY)
+        {
+            return nullptr;
+        }
+        if (state < SLOT_READY || slot->hash.load(std::memory_order_relaxed) != key.hash)
+        {
+            continue;
+        }
+
+        // Taking a reference pins the tile: eviction needs exactly READY
+        while (state >= SLOT_READY &&
+               !slot->state.compare_exchange_weak(state, state + 1, std::memory_order_acquire))
+        {
+        }
+        if (state < SLOT_READY)
+        {
+            continue;
+        }
+
+        // Recycled between the filter and the reference?
+        if (slot->dpi == key.dpi && slot->tile == key.tile && std::memcmp(slot->digest, key.digest, DIGEST_BYTES) == 0)
+        {
+            slot->recent.store(1, std::memory_order_relaxed);
+            return slot;
+        }
+        release(slot);
+    }
+    return nullptr;
+}
+
+void SharedTileCache::release(Slot *slot) const
+{
+    slot->state.fetch_sub(1, std::memory_order_release);
+}
+
+// Publishing -------------------------------------------------------
+void SharedTileCache::insert(const QByteArray &pageKey, int dpi, const QImage &image)
+{
+    if (!m_header || pageKey.isEmpty() || image.isNull())
+    {
+        return;
+    }
+
+    const QImage source =
+        isStoredFormat(image.format()) ? image : image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const int columns = (source.width() + TILE_SIZE - 1) / TILE_SIZE;
+    const int tiles = columns * ((source.height() + TILE_SIZE - 1) / TILE_SIZE);
+
+    // One huge render would evict every neighbor's pages
+    if (tiles > qint64(m_blockCount) / 2)
+    {
+        return;
+    }
+
+    for (int tile = 0; tile < tiles; ++tile)
+    {
+        const TileKey key = tileKey(pageKey, dpi, tile);
+        if (Slot *existing = acquire(key))
+        {
+            release(existing); // A neighbor was faster
+            continue;
+        }
+        if (!publish(key, source, tile % columns, tile / columns))
+        {
+            return; // Table or blocks exhausted: the page would be incomplete anyway
+        }
+    }
+}
+
+bool SharedTileCache::publish(const TileKey &key, const QImage &image, int tileX, int tileY)
+{
+    const quint32 block = allocateBlock();
+    if (block == NO_BLOCK)
+    {
+        return false;
+    }
+
+    // The block is ours alone until a slot points to it
+    const int x = tileX * TILE_SIZE;
+    const int y = tileY * TILE_SIZE;
+    const int width = qMin(TILE_SIZE, image.width() - x);
+    const int height = qMin(TILE_SIZE, image.height() - y);
+    uchar *target = blockAt(block);
+    for (int row = 0; row < height; ++row)
+    {
+        std::memcpy(target + row * width * 4, image.constScanLine(y + row) + x * 4, size_t(width) * 4);
+    }
+
+    const quint32 mask = m_slotCount - 1;
+    for (int probe = 0; probe < MAX_PROBES; ++probe)
+    {
+        Slot *slot = slotAt(quint32(key.hash + probe) & mask);
+        quint32 state = slot->state.load(std::memory_order_relaxed);
+        if ((state != SLOT_EMPTY && state != SLOT_DEAD) ||
+            !slot->state.compare_exchange_strong(state, SLOT_BUSY, std::memory_order_acquire))
+        {
+            continue;
+        }
+
+        std::memcpy(slot->digest, key.digest, DIGEST_BYTES);
+        slot->dpi = key.dpi;
+        slot->tile = key.tile;
+        slot->imageWidth = image.width();
+        slot->imageHeight = image.height();
+        slot->format = int(image.format());
+        slot->block = block;
+        slot->hash.store(key.hash, std::memory_order_relaxed);
+        slot->recent.store(1, std::memory_order_relaxed);
+        slot->state.store(SLOT_READY, std::memory_order_release);
+        return true;
+    }
+
+    freeBlock(block);
+    return false;
+}
+
+// Blocks -----------------------------------------------------------
+// Treiber stack over block indices; the tag in the head's upper half
+// defeats ABA between processes popping and pushing the same block.
+
+quint32 SharedTileCache::allocateBlock()
+{
+    auto *links = reinterpret_cast<std::atomic<quint32> *>(static_cast<char *>(m_base) + m_linksOffset);
+    quint64 head = m_header->freeHead.load(std::memory_order_acquire);
+    while (quint32(head) != NO_BLOCK)
+    {
+        const quint32 block = quint32(head);
+        if (!isBlock(block))
+        {
+            return NO_BLOCK; // Corrupt free list: publish nothing rather than write outside the blocks
+        }
+        const quint64 next = ((head >> 32) + 1) << 32 | links[block].load(std::memory_order_relaxed);
+        if (m_header->freeHead.compare_exchange_weak(head, next, std::memory_order_acquire))
+        {
+            m_header->usedBlocks.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }
+    }
+
+    // Budget reached: take the block of a tile nobody used lately
+    return evictBlock();
+}
+
+void SharedTileCache::freeBlock(quint32 block)
+{
+    auto *links = reinterpret_cast<std::atomic<quint32> *>(static_cast<char *>(m_base) + m_linksOffset);
+    m_header->usedBlocks.fetch_sub(1, std::memory_order_relaxed);
+
+    quint64 head = m_header->freeHead.load(std::memory_order_relaxed);
+    quint64 next;
+    do
+    {
+        links[block].store(quint32(head), std::memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | block;
+    } while (!m_header->freeHead.compare_exchange_weak(head, next, std::memory_order_release));
+}
+
+quint32 SharedTileCache::evictBlock()
+{
+    // Two turns of the hand: the first may only clear reference bits
+    const quint32 mask = m_slotCount - 1;
+    for (quint64 step = 0; step < 2ull * m_slotCount; ++step)
+    {
+        Slot *slot = slotAt(m_header->clockHand.fetch_add(1, std::memory_order_relaxed) & mask);
+        if (slot->state.load(std::memory_order_relaxed) != SLOT_READY)
+        {
+            continue;
+        }
+        if (slot->recent.exchange(0, std::memory_order_relaxed))
+        {
+            continue;
+        }
+
+        // Exactly READY: nobody is copying it out
+        quint32 expected = SLOT_READY;
+        if (slot->state.compare_exchange_strong(expected, SLOT_BUSY, std::memory_order_acquire))
+        {
+            const quint32 block = slot->block;
+            slot->state.store(SLOT_DEAD, std::memory_order_release);
+            if (!isBlock(block))
+            {
+                continue; // A slot nobody could read anyway: gone, block or not
+            }
+            return block; // Still counted in usedBlocks: it changes tile, not owner
+        }
+    }
+    return NO_BLOCK;
+}
+
+// Private Helpers --------------------------------------------------
+SharedTileCache::TileKey SharedTileCache::tileKey(const QByteArray &pageKey, int dpi, int tile) const
+{
+    // Page key and context folded into one fixed-size digest
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(pageKey);
+    hash.addData(m_context);
+    const QByteArray digest = hash.result();
+
+    TileKey key;
+    std::memcpy(key.digest, digest.constData(), DIGEST_BYTES);
+    key.dpi = dpi;
+    key.tile = tile;
+
+    quint64 prefix = 0;
+    std::memcpy(&prefix, key.digest, sizeof(prefix));
+    key.hash = mix(prefix ^ (quint64(quint32(dpi)) << 32 | quint32(tile)));
+    return key;
+}
+
+SharedTileCache::Slot *SharedTileCache::slotAt(quint32 index) const
+{
+    return reinterpret_cast<Slot *>(static_cast<char *>(m_base) + m_slotsOffset) + index;
+}
+
+uchar *SharedTileCache::blockAt(quint32 block) const
+{
+    return static_cast<uchar *>(m_base) + m_blocksOffset + quint64(block) * TILE_BYTES;
+}
+
+bool SharedTileCache::isStoredFormat(qint32 format)
+{
+    return format == QImage::Format_ARGB32 || format == QImage::Format_ARGB32_Premultiplied ||
+           format == QImage::Format_RGB32;
+}
@@ -0,0 +1,100 @@
+#ifndef SHAREDTILECACHE_H
+#define SHAREDTILECACHE_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+#include <memory>
+
+/**
+ * SharedTileCache
+ * ---------------------------------------------------------------
+ * Optional second tier of RenderCache, shared by every viewer process on
+ * the machine: a POSIX shared-memory segment holding page renders cut into
+ * fixed-size tiles.
+ *
+ * Responsibilities:
+ *  - Create the segment, or attach to the one a neighbor created; its size
+ *    (the global byte budget) is fixed by whoever created it.
+ *  - Publish renders as TILE_SIZE x TILE_SIZE tiles, keyed by (page key,
+ *    DPI, tile), and reassemble a page when all its tiles are present.
+ *    The page key is RenderCache's: document render key + page index.
+ *  - Reclaim tiles with a CLOCK sweep once every block is in use.
+ *
+ * Design notes:
+ *  - Lock-free: an open-addressing table whose slot state word doubles as
+ *    the reference count, and a tagged free-block stack. A tile being
+ *    copied out is never evicted; no process ever waits on another.
+ *  - Pixels depend on render hints and the display profile, which the
+ *    page key does not cover: the caller passes them as the context,
+ *    and only processes with the same context exchange tiles.
+ *  - A process killed in the middle of a copy pins that one tile until the
+ *    segment is recreated (it lives in /dev/shm until unlinked or reboot).
+ *  - The default segment is private to the user (mode 0600). A named one
+ *    (cache/shared_name) is group-readable and writable: every member can
+ *    read, and forge, the pages the others view.
+ *  - Nothing read back from the segment is trusted: the layout is checked
+ *    once and kept privately, and every tile's block, size and format are
+ *    checked before use. A broken or hostile neighbor costs misses, never
+ *    a read or write outside the mapping.
+ *  - Thread-safe; unavailable (attach() returns nullptr) off Unix.
+ */
+class SharedTileCache
+{
+public:
+    ~SharedTileCache(); // Unmaps; the segment stays for the other processes.
+
+    // nullptr if shared memory is unavailable or the segment is incompatible.
+    static std::unique_ptr<SharedTileCache> attach(const QString &name, qint64 budgetBytes);
+    static QString defaultName(); // Per user: "/pdv-tiles-<uid>".
+
+    void setContext(const QByteArray &context) { m_context = context; } // Not thread-safe against find/insert.
+
+    QImage find(const QByteArray &pageKey, int dpi) const; // Null unless every tile is present.
+    void insert(const QByteArray &pageKey, int dpi, const QImage &image);
+
+    QString name() const { return m_name; }
+    qint64 budget() const;    // Segment tile capacity, in bytes
+    qint64 usedBytes() const; // Across all processes
+
+    static constexpr int TILE_SIZE = 256;                            // Pixels per side
+    static constexpr qint64 TILE_BYTES = qint64(TILE_SIZE) * TILE_SIZE * 4; // 32-bit pixels
+    static constexpr int MIN_BLOCKS = 64;   // Below this a page or two would fill it
+    static constexpr int MAX_PROBES = 32;   // Table slots visited per lookup
+    static constexpr int ATTACH_TIMEOUT_MS = 2000; // Wait for a neighbor still initializing
+
+private:
+    struct Header;
+    struct Slot;
+    struct TileKey;
+
+    SharedTileCache() = default;
+
+    TileKey tileKey(const QByteArray &pageKey, int dpi, int tile) const;
+    Slot *acquire(const TileKey &key) const; // Referenced slot, or nullptr.
+    void release(Slot *slot) const;
+    bool publish(const TileKey &key, const QImage &image, int tileX, int tileY);
+    quint32 allocateBlock();
+    void freeBlock(quint32 block);
+    quint32 evictBlock(); // CLOCK sweep; NO_BLOCK if everything is referenced.
+
+    Slot *slotAt(quint32 index) const;
+    uchar *blockAt(quint32 block) const;
+    bool isBlock(quint32 block) const { return block < m_blockCount; }
+    static bool isStoredFormat(qint32 format); // One insert() writes (32-bit)
+
+    QString m_name;
+    QByteArray m_context;
+    void *m_base = nullptr; // Mapping
+    qint64 m_mappedBytes = 0;
+    Header *m_header = nullptr;
+
+    // Layout as validated by attach(): never re-read from the shared header
+    quint32 m_slotCount = 0;
+    quint32 m_blockCount = 0;
+    quint64 m_slotsOffset = 0;
+    quint64 m_linksOffset = 0;
+    quint64 m_blocksOffset = 0;
+};
+
+#endif // SHAREDTILECACHE_H
@@ -0,0 +1,394 @@
+/**
+ * SoakRunner implementation
+ * ---------------------------------------------------------------
+ * A small state machine driven by a zero-interval timer: every step is a
+ * separate event-loop turn, exactly like user input would be.
+ */
+
+#include "soakrunner.h"
+#include "pdfviewer.h"
+#include "pdfdocument.h"
+#include "memoryaccounting.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QScrollBar>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace
+{
+    int countObjects(const QObject *object)
+    {
+        int count = 1;
+        for (const QObject *child : object->children())
+            count += countObjects(child);
+        return count;
+    }
+
+    double median(QVector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        return values.isEmpty() ? 0.0 : values[values.size() / 2];
+    }
+
+    // Least-squares slope of value over sample index
+    double slope(const QVector<double> &values)
+    {
+        const int n = values.size();
+        double meanX = (n - 1) / 2.0;
+        double meanY = 0.0;
+        for (double v : values)
+            meanY += v / n;
+
+        double numerator = 0.0;
+        double denominator = 0.0;
+        for (int i = 0; i < n; ++i)
+        {
+            numerator += (i - meanX) * (values[i] - meanY);
+            denominator += (i - meanX) * (i - meanX);
+        }
+        return denominator > 0.0 ? numerator / denominator : 0.0;
+    }
+}
+
+// Construction -----------------------------------------------------
+SoakRunner::SoakRunner(const QStringList &arguments, QObject *parent) : QObject(parent)
+{
+    if (!parseArguments(arguments))
+    {
+        m_exitCode = 2;
+    }
+
+    m_stepTimer.setInterval(0);
+    connect(&m_stepTimer, &QTimer::timeout, this, &SoakRunner::step);
+}
+
+SoakRunner::~SoakRunner()
+{
+    delete m_viewer;
+}
+
+bool SoakRunner::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--soak") == 0)
+            return true;
+    }
+    return false;
+}
+
+bool SoakRunner::parseArguments(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.addOption(QCommandLineOption("soak"));
+    parser.addOption(QCommandLineOption("hours", "Run time in hours (default 24).", "hours"));
+    parser.addOption(QCommandLineOption("report", "Write every sample to this CSV file.", "file"));
+    parser.addPositionalArgument("documents", "PDF files or directories to cycle through.");
+    if (!parser.parse(arguments))
+    {
+        qWarning() << "SoakRunner:" << parser.errorText();
+        return false;
+    }
+
+    if (parser.isSet("hours"))
+    {
+        bool ok = false;
+        const double hours = parser.value("hours").toDouble(&ok);
+        if (!ok || hours <= 0.0)
+        {
+            qWarning() << "SoakRunner: invalid --hours" << parser.value("hours");
+            return false;
+        }
+        m_durationMs = qint64(hours * 60 * 60 * 1000);
+    }
+    m_reportPath = parser.value("report");
+
+    // Short runs still get enough samples for a trend
+    m_sampleIntervalMs = qBound<qint64>(1000, m_durationMs / 200, MAX_SAMPLE_INTERVAL_MS);
+
+    for (const QString &path : parser.positionalArguments())
+    {
+        if (QFileInfo(path).isDir())
+        {
+            QDirIterator it(path, QStringList() << "*.pdf", QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext())
+                m_files.append(it.next());
+        }
+        else
+        {
+            m_files.append(path);
+        }
+    }
+
+    if (m_files.isEmpty())
+    {
+        qWarning() << "SoakRunner: no documents given";
+        return false;
+    }
+    return true;
+}
+
+// Run --------------------------------------------------------------
+int SoakRunner::exec()
+{
+    if (m_exitCode != 0)
+    {
+        return m_exitCode;
+    }
+
+    m_viewer = new PDFViewer();
+    m_viewer->resize(1024, 768);
+    m_viewer->show();
+
+    qInfo() << "SoakRunner: cycling" << m_files.size() << "documents for" << m_durationMs / 1000 << "s, sampling every"
+            << m_sampleIntervalMs / 1000 << "s";
+
+    m_clock.start();
+    m_stepTimer.start();
+    QApplication::exec();
+    return m_exitCode;
+}
+
+void SoakRunner::step()
+{
+    switch (m_phase)
+    {
+    case Phase::Open:
+    {
+        auto document = std::make_unique<PDFDocument>();
+        const QString path = m_files[m_cycles % m_files.size()];
+        if (!document->loadFromFile(path) || !m_viewer->setDocument(std::move(document)))
+        {
+            qWarning() << "SoakRunner: cannot open" << path << "- skipped";
+            ++m_cycles;
+            m_phase = Phase::Settle;
+            return;
+        }
+        m_phase = Phase::Scroll;
+        m_phaseStep = 0;
+        break;
+    }
+
+    case Phase::Scroll:
+    {
+        // Page-sized jumps through the document, then back to the top
+        QScrollBar *bar = m_viewer->verticalScrollBar();
+        if (m_phaseStep < SCROLL_STEPS && bar->value() < bar->maximum())
+            bar->setValue(bar->value() + m_viewer->viewport()->height());
+        else
+        {
+            bar->setValue(0);
+            m_phase = Phase::Zoom;
+            m_phaseStep = -1;
+        }
+        ++m_phaseStep;
+        break;
+    }
+
+    case Phase::Zoom:
+    {
+        switch (m_phaseStep++)
+        {
+        case 0:
+        case 1:
+            m_viewer->zoomIn();
+            break;
+        case 2:
+            m_viewer->zoomFitWidth();
+            break;
+        case 3:
+        case 4:
+            m_viewer->zoomOut();
+            break;
+        default:
+            m_viewer->zoomReset();
+            m_phase = Phase::Close;
+            break;
+        }
+        break;
+    }
+
+    case Phase::Close:
+        m_viewer->clearDocument();
+        ++m_cycles;
+        m_phase = Phase::Settle;
+        break;
+
+    case Phase::Settle:
+    {
+        m_phase = Phase::Open;
+        const qint64 now = m_clock.elapsed();
+        if (m_lastSampleMs >= 0 && now - m_lastSampleMs < m_sampleIntervalMs && now < m_durationMs)
+            break;
+
+        m_lastSampleMs = now;
+        m_samples.append(sample());
+        const SoakSample &latest = m_samples.last();
+        qInfo().noquote() << QString("SoakRunner: %1 s, %2 cycles, rss %3 KiB, cache %4 KiB, fds %5, qobjects %6, widgets %7")
+                                 .arg(latest.elapsedMs / 1000)
+                                 .arg(latest.cycles)
+                                 .arg(latest.rssBytes / 1024)
+                                 .arg(latest.renderCacheBytes / 1024)
+                                 .arg(latest.fileDescriptors)
+                                 .arg(latest.qobjects)
+                                 .arg(latest.widgets);
+
+        // Runaway memory does not need hours of evidence
+        const SoakSample &first = m_samples.first();
+        if (first.rssBytes >= 0 && latest.rssBytes - latest.renderCacheBytes >
+                                       first.rssBytes - first.renderCacheBytes + HARD_RSS_GROWTH)
+        {
+            finish(QString("RSS grew by more than %1 MiB").arg(HARD_RSS_GROWTH / (1024 * 1024)));
+        }
+        else if (now >= m_durationMs)
+        {
+            const QStringList failures = growthFailures();
+            finish(failures.join("; "));
+        }
+        break;
+    }
+    }
+}
+
+// Sampling ---------------------------------------------------------
+SoakSample SoakRunner::sample() const
+{
+    SoakSample s;
+    s.elapsedMs = m_clock.elapsed();
+    s.cycles = m_cycles;
+    s.renderCacheBytes = m_viewer->renderCache()->usedBytes();
+    s.accountedBytes = MemoryAccounting::instance().totalBytes();
+    s.widgets = QApplication::allWidgets().size();
+
+    s.qobjects = countObjects(QCoreApplication::instance());
+    for (const QWidget *widget : QApplication::topLevelWidgets())
+        s.qobjects += countObjects(widget);
+
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly))
+    {
+        // Second field: resident pages
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1)
+            s.rssBytes = fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+    }
+    s.fileDescriptors = QDir("/proc/self/fd").entryList(QDir::Files | QDir::System | QDir::NoDotAndDotDot).size();
+#endif
+
+    return s;
+}
+
+QStringList SoakRunner::growthFailures() const
+{
+    QStringList failures;
+
+    const int warmup = qMax(3, int(m_samples.size()) * WARMUP_PERCENT / 100);
+    const QVector<SoakSample> steady = m_samples.mid(warmup);
+    if (steady.size() < MIN_SAMPLES)
+    {
+        qWarning() << "SoakRunner: only" << steady.size() << "samples after warm-up; run longer for a verdict";
+        return failures;
+    }
+
+    auto check = [&](const char *name, double tolerance, const std::function<double(const SoakSample &)> &value)
+    {
+        QVector<double> values;
+        for (const SoakSample &s : steady)
+        {
+            if (value(s) < 0)
+                return; // Not measurable on this platform
+            values.append(value(s));
+        }
+
+        const int quarter = qMax(1, int(values.size()) / 4);
+        const double start = median(values.mid(0, quarter));
+        const double end = median(values.mid(values.size() - quarter));
+        if (end - start > tolerance && slope(values) > 0.0)
+            failures.append(QString("%1 grew from %2 to %3").arg(name).arg(start, 0, 'f', 0).arg(end, 0, 'f', 0));
+    };
+
+    check("RSS (excluding render cache)", RSS_TOLERANCE, [](const SoakSample &s)
+          { return s.rssBytes < 0 ? -1.0 : double(s.rssBytes - s.renderCacheBytes); });
+    check("accounted memory (excluding render cache)", ACCOUNTED_TOLERANCE, [](const SoakSample &s)
+          { return double(s.accountedBytes - s.renderCacheBytes); });
+    check("file descriptors", FD_TOLERANCE, [](const SoakSample &s)
+          { return double(s.fileDescriptors); });
+    check("QObjects", QOBJECT_TOLERANCE, [](const SoakSample &s)
+          { return double(s.qobjects); });
+    check("widgets", WIDGET_TOLERANCE, [](const SoakSample &s)
+          { return double(s.widgets); });
+
+    // The cache is bounded by construction; verify it
+    for (const SoakSample &s : steady)
+    {
+        if (s.renderCacheBytes > m_viewer->renderCache()->budget())
+        {
+            failures.append("render cache exceeded its budget");
+            break;
+        }
+    }
+    return failures;
+}
+
+// Result -----------------------------------------------------------
+void SoakRunner::finish(const QString &failure)
+{
+    m_stepTimer.stop();
+    writeReport();
+
+    if (failure.isEmpty())
+    {
+        qInfo() << "SoakRunner: PASS after" << m_cycles << "cycles";
+        m_exitCode = 0;
+    }
+    else
+    {
+        qWarning().noquote() << "SoakRunner: FAIL after" << m_cycles << "cycles -" << failure;
+        m_exitCode = 1;
+    }
+    QCoreApplication::exit(m_exitCode);
+}
+
+void SoakRunner::writeReport() const
+{
+    if (m_reportPath.isEmpty())
+    {
+        return;
+    }
+
+    QSaveFile file(m_reportPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qWarning() << "SoakRunner: cannot write" << m_reportPath;
+        return;
+    }
+
+    file.write("elapsed_ms,cycles,rss_bytes,render_cache_bytes,accounted_bytes,fds,qobjects,widgets\n");
+    for (const SoakSample &s : m_samples)
+    {
+        file.write(QString("%1,%2,%3,%4,%5,%6,%7,%8\n")
+                       .arg(s.elapsedMs)
+                       .arg(s.cycles)
+                       .arg(s.rssBytes)
+                       .arg(s.renderCacheBytes)
+                       .arg(s.accountedBytes)
+                       .arg(s.fileDescriptors)
+                       .arg(s.qobjects)
+                       .arg(s.widgets)
+                       .toUtf8());
+    }
+    file.commit();
+}
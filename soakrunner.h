@@ -0,0 +1,105 @@
+#ifndef SOAKRUNNER_H
+#define SOAKRUNNER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+class PDFViewer;
+
+/**
+ * SoakSample
+ * Process-wide resource snapshot taken between two documents.
+ */
+struct SoakSample
+{
+    qint64 elapsedMs = 0;
+    int cycles = 0;
+    qint64 rssBytes = -1;         // Resident set (-1: unsupported platform)
+    qint64 renderCacheBytes = 0;  // Bounded by its budget; excluded from RSS checks
+    qint64 accountedBytes = 0;    // MemoryAccounting total
+    int fileDescriptors = -1;     // Open descriptors (-1: unsupported platform)
+    int qobjects = 0;             // Reachable from the application / top-level widgets
+    int widgets = 0;              // QApplication::allWidgets()
+};
+
+/**
+ * SoakRunner
+ * ---------------------------------------------------------------
+ * Long-running leak hunt: `PrettyDopeFileviewer --soak [--hours H]
+ * [--report samples.csv] <pdf-or-directory>...` (runs offscreen).
+ *
+ * Responsibilities:
+ *  - Cycle open -> scroll -> zoom -> close over the given documents, one
+ *    step per event-loop turn so deleteLater() and queued work really run.
+ *  - Sample RSS, descriptors, QObject/widget counts and cache sizes after
+ *    each close (once deferred deletes have been processed).
+ *  - Fail (exit code 1) when a metric keeps growing after warm-up, or at
+ *    once if RSS runs away past HARD_RSS_GROWTH.
+ *
+ * Design notes:
+ *  - Growth = last-quarter median above first-quarter median by more than
+ *    the metric's tolerance, with a positive least-squares slope; a cache
+ *    filling up to its budget is not growth (it is subtracted from RSS).
+ *  - RSS and descriptors come from /proc (Linux); elsewhere they are skipped.
+ */
+class SoakRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SoakRunner(const QStringList &arguments, QObject *parent = nullptr);
+    ~SoakRunner() override;
+
+    static bool isRequested(int argc, char *argv[]); // Before QApplication: picks the platform.
+    int exec(); // Runs the event loop; returns the process exit code.
+
+    static constexpr int SCROLL_STEPS = 12;
+    static constexpr int WARMUP_PERCENT = 10;
+    static constexpr int MIN_SAMPLES = 8;
+    static constexpr qint64 MAX_SAMPLE_INTERVAL_MS = 60 * 1000;
+    static constexpr qint64 RSS_TOLERANCE = 32ll * 1024 * 1024;
+    static constexpr qint64 HARD_RSS_GROWTH = 1024ll * 1024 * 1024;
+    static constexpr qint64 ACCOUNTED_TOLERANCE = 8ll * 1024 * 1024;
+    static constexpr int FD_TOLERANCE = 2;
+    static constexpr int QOBJECT_TOLERANCE = 16;
+    static constexpr int WIDGET_TOLERANCE = 4;
+
+private slots:
+    void step();
+
+private:
+    enum class Phase
+    {
+        Open,
+        Scroll,
+        Zoom,
+        Close,
+        Settle // Deferred deletes of the closed document run before sampling
+    };
+
+    bool parseArguments(const QStringList &arguments);
+    SoakSample sample() const;
+    void finish(const QString &failure = QString());
+    QStringList growthFailures() const;
+    void writeReport() const;
+
+    PDFViewer *m_viewer = nullptr;
+    QStringList m_files;
+    QString m_reportPath;
+    qint64 m_durationMs = 24ll * 60 * 60 * 1000;
+    qint64 m_sampleIntervalMs = MAX_SAMPLE_INTERVAL_MS;
+
+    QTimer m_stepTimer;
+    QElapsedTimer m_clock;
+    Phase m_phase = Phase::Open;
+    int m_phaseStep = 0;
+    int m_cycles = 0;
+    qint64 m_lastSampleMs = -1;
+    QVector<SoakSample> m_samples;
+    int m_exitCode = 0;
+};
+
+#endif // SOAKRUNNER_H
@@ -0,0 +1,189 @@
+/**
+ * StreamReader implementation
+ * ---------------------------------------------------------------
+ * Reads in READ_CHUNK steps until the pipe would block, then goes back to
+ * the event loop; the notifier wakes us up for the next batch.
+ */
+
+#include "streamreader.h"
+#include <QDebug>
+#include <QFile>
+#include <QSocketNotifier>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const QByteArray EOF_MARKER("%%EOF");
+}
+
+// Construction -----------------------------------------------------
+StreamReader::StreamReader(QObject *parent) : QObject(parent)
+{
+}
+
+StreamReader::~StreamReader() = default;
+
+bool StreamReader::start(int fd)
+{
+    m_fd = fd;
+
+#ifdef Q_OS_UNIX
+    // Non-blocking, so one readAvailable() drains exactly what is there
+    const int flags = ::fcntl(fd, F_GETFL);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        return false;
+    }
+
+    m_notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &StreamReader::readAvailable);
+    return true;
+#else
+    // No readiness notification for pipes here: read everything up front
+    QFile input;
+    if (!input.open(fd, QIODevice::ReadOnly, QFileDevice::DontCloseHandle))
+    {
+        return false;
+    }
+    const QByteArray all = input.readAll();
+    append(all.constData(), all.size());
+    finish();
+    return true;
+#endif
+}
+
+// Reading ----------------------------------------------------------
+void StreamReader::readAvailable()
+{
+#ifdef Q_OS_UNIX
+    QByteArray chunk(READ_CHUNK, Qt::Uninitialized);
+    bool sawMarker = false;
+
+    while (!m_failed)
+    {
+        const ssize_t count = ::read(m_fd, chunk.data(), chunk.size());
+        if (count > 0)
+        {
+            // Look for the marker across the previous read's tail as well
+            const QByteArray window = m_tail + QByteArray::fromRawData(chunk.constData(), count);
+            sawMarker = sawMarker || window.contains(EOF_MARKER);
+            m_tail = window.right(EOF_MARKER.size() - 1);
+
+            append(chunk.constData(), count);
+            continue;
+        }
+
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break; // Drained for now
+
+        if (count < 0)
+        {
+            qWarning() << "StreamReader: read failed, errno" << errno;
+        }
+        finish(); // 0: writer closed the pipe
+        return;
+    }
+
+    // Poppler opens a spilled file by name: everything must be on disk first
+    if (sawMarker && !m_failed && (!m_spill || flushSpill()))
+    {
+        emit revisionAvailable();
+    }
+#endif
+}
+
+void StreamReader::append(const char *data, qint64 size)
+{
+    if (m_failed || (!m_spill && m_buffer.size() + size > m_spillThreshold && !spillToDisk()))
+    {
+        return; // failed() already emitted
+    }
+
+    if (m_spill)
+    {
+        // A short write (full disk) would hand Poppler a truncated PDF
+        if (m_spill->write(data, size) != size)
+        {
+            fail(tr("Cannot write %1 bytes of input to %2").arg(size).arg(m_spill->fileName()));
+            return;
+        }
+    }
+    else
+    {
+        m_buffer.append(data, size);
+        m_account.setBytes(m_buffer.capacity());
+    }
+    m_bytesRead += size;
+}
+
+QByteArray StreamReader::takeSnapshot()
+{
+    if (!m_finished)
+    {
+        return QByteArray(m_buffer.constData(), m_buffer.size());
+    }
+
+    // Nothing more will be appended: hand the buffer over
+    QByteArray data = std::move(m_buffer);
+    m_buffer = QByteArray();
+    m_account.setBytes(0);
+    return data;
+}
+
+bool StreamReader::spillToDisk()
+{
+    auto spill = std::make_unique<QTemporaryFile>();
+    if (!spill->open() || spill->write(m_buffer) != m_buffer.size())
+    {
+        fail(tr("Cannot spill %1 bytes of input to a temporary file").arg(m_buffer.size()));
+        return false;
+    }
+
+    qDebug() << "StreamReader: input exceeds" << m_spillThreshold << "bytes, spilled to" << spill->fileName();
+    m_spill = std::move(spill);
+    m_buffer = QByteArray();
+    m_account.setBytes(0);
+    return true;
+}
+
+void StreamReader::finish()
+{
+    if (m_notifier)
+    {
+        m_notifier->setEnabled(false);
+    }
+    if (m_spill && !flushSpill())
+    {
+        return; // failed() instead of finished()
+    }
+
+    m_finished = true;
+    emit finished();
+}
+
+bool StreamReader::flushSpill()
+{
+    if (m_spill->flush())
+    {
+        return true;
+    }
+    fail(tr("Cannot write input to %1").arg(m_spill->fileName()));
+    return false;
+}
+
+void StreamReader::fail(const QString &error)
+{
+    m_failed = true;
+    if (m_notifier)
+    {
+        m_notifier->setEnabled(false);
+    }
+    emit failed(error);
+}
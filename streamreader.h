@@ -0,0 +1,86 @@
+#ifndef STREAMREADER_H
+#define STREAMREADER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QTemporaryFile>
+#include <memory>
+#include "memoryaccounting.h"
+
+class QSocketNotifier;
+
+/**
+ * StreamReader
+ * ---------------------------------------------------------------
+ * Collects a PDF arriving on a pipe (typically stdin) without blocking
+ * the event loop.
+ *
+ * Responsibilities:
+ *  - Read whatever is available whenever the descriptor becomes readable.
+ *  - Keep the bytes in a growing in-memory buffer; past the spill threshold
+ *    move them to a temporary file and append there instead.
+ *  - Announce when the data may be parseable: a PDF revision is complete
+ *    once its "%%EOF" marker arrives, and at end of input.
+ *
+ * Design notes:
+ *  - Non-blocking reads driven by QSocketNotifier (Unix). Elsewhere the
+ *    input is read in one blocking call on start().
+ *  - Parsing is left to the caller (PDFDocument::loadFromData()/File()):
+ *    a pipe only ever grows, earlier bytes never change.
+ *  - The spill file lives as long as the reader: keep it alive while a
+ *    document loaded from spillPath() is open.
+ *  - Reports its buffer to MemoryAccounting as "stream-buffer". A snapshot
+ *    never shares it: while reading it is an exact-size copy (the next
+ *    append must not detach a shared buffer), and once finished the buffer
+ *    itself is handed over and no longer counted here.
+ */
+class StreamReader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StreamReader(QObject *parent = nullptr);
+    ~StreamReader() override;
+
+    bool start(int fd = 0); // Connect first. Descriptor stays open when the reader goes away.
+
+    // State ---------------------------------------------------------
+    qint64 bytesRead() const { return m_bytesRead; }
+    bool isFinished() const { return m_finished; }
+    bool isSpilled() const { return m_spill != nullptr; }
+    QByteArray takeSnapshot(); // Bytes so far, unshared with the buffer; empty once spilled.
+    QString spillPath() const { return m_spill ? m_spill->fileName() : QString(); }
+
+    void setSpillThreshold(qint64 bytes) { m_spillThreshold = bytes; }
+
+    static constexpr qint64 DEFAULT_SPILL_THRESHOLD = 64ll * 1024 * 1024;
+    static constexpr qint64 READ_CHUNK = 256 * 1024;
+
+signals:
+    void revisionAvailable(); // A "%%EOF" arrived: the data may parse now.
+    void finished();          // End of input (all data read).
+    void failed(const QString &error);
+
+private slots:
+    void readAvailable();
+
+private:
+    void append(const char *data, qint64 size);
+    bool spillToDisk();
+    bool flushSpill(); // False (and failed() emitted) if the disk refused the data.
+    void finish();
+    void fail(const QString &error);
+
+    int m_fd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+    QByteArray m_buffer;
+    std::unique_ptr<QTemporaryFile> m_spill;
+    QByteArray m_tail; // Last bytes seen, so a marker split across reads is found
+    qint64 m_bytesRead = 0;
+    qint64 m_spillThreshold = DEFAULT_SPILL_THRESHOLD;
+    bool m_finished = false;
+    bool m_failed = false;
+    MemoryAccount m_account{"stream-buffer"};
+};
+
+#endif // STREAMREADER_H
@@ -0,0 +1,258 @@
+/**
+ * HttpRangeDevice tests
+ * ---------------------------------------------------------------
+ * Against a minimal HTTP/1.1 range server on localhost, running on its own
+ * thread (the device blocks the test thread while it waits for blocks).
+ */
+
+#include "httprangedevice.h"
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTimer>
+
+/**
+ * RangeServer
+ * Answers "Range: bytes=a-b" GETs on one in-memory body with 206. Requests
+ * starting at or past failFrom get a 500 at once; the others are delayed,
+ * so a failure always lands while a read is still waiting. Every range
+ * asked for is logged, so tests can tell what was fetched again.
+ */
+class RangeServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit RangeServer(const QByteArray &body) : m_body(body) {}
+
+    void setFailFrom(int offset) { m_failFrom.storeRelaxed(offset); } // -1: never fail
+    int failures() const { return m_failures.loadRelaxed(); }
+
+    bool requested(qint64 first, qint64 last) const // Any request overlapping [first, last]?
+    {
+        QMutexLocker lock(&m_rangesMutex);
+        for (const auto &range : m_ranges)
+        {
+            if (range.first <= last && range.second >= first)
+                return true;
+        }
+        return false;
+    }
+    void clearRequests()
+    {
+        QMutexLocker lock(&m_rangesMutex);
+        m_ranges.clear();
+    }
+
+    static constexpr int DELAY_MS = 100;
+
+protected:
+    void incomingConnection(qintptr descriptor) override
+    {
+        QTcpSocket *socket = new QTcpSocket(this);
+        socket->setSocketDescriptor(descriptor);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]()
+                { serve(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]()
+                {
+                    m_pending.remove(socket);
+                    socket->deleteLater(); });
+    }
+
+private:
+    void serve(QTcpSocket *socket)
+    {
+        QByteArray &pending = m_pending[socket];
+        pending += socket->readAll();
+
+        // Keep-alive: any number of header blocks (GETs carry no body)
+        int end;
+        while ((end = pending.indexOf("\r\n\r\n")) >= 0)
+        {
+            const QByteArray request = pending.left(end);
+            pending.remove(0, end + 4);
+            reply(socket, request);
+        }
+    }
+
+    void reply(QTcpSocket *socket, const QByteArray &request)
+    {
+        qint64 first = 0;
+        qint64 last = m_body.size() - 1;
+        for (const QByteArray &line : request.split('\n'))
+        {
+            const QByteArray header = line.trimmed();
+            if (header.toLower().startsWith("range: bytes="))
+            {
+                const QByteArray range = header.mid(header.indexOf('=') + 1);
+                first = range.left(range.indexOf('-')).toLongLong();
+                last = qMin<qint64>(range.mid(range.indexOf('-') + 1).toLongLong(), m_body.size() - 1);
+            }
+        }
+
+        {
+            QMutexLocker lock(&m_rangesMutex);
+            m_ranges.append({first, last});
+        }
+
+        const int failFrom = m_failFrom.loadRelaxed();
+        if (failFrom >= 0 && first >= failFrom)
+        {
+            m_failures.ref();
+            socket->write("HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\n\r\n");
+            return;
+        }
+
+        const QByteArray response = "HTTP/1.1 206 Partial Content\r\n"
+                                    "Content-Range: bytes " +
+                                    QByteArray::number(first) + '-' + QByteArray::number(last) + '/' +
+                                    QByteArray::number(m_body.size()) + "\r\n"
+                                    "Content-Length: " +
+                                    QByteArray::number(last - first + 1) + "\r\n"
+                                    "ETag: \"test\"\r\n\r\n" +
+                                    m_body.mid(first, last - first + 1);
+        QTimer::singleShot(DELAY_MS, socket, [socket, response]()
+                           { socket->write(response); });
+    }
+
+    QByteArray m_body;
+    QAtomicInt m_failFrom{-1};
+    QAtomicInt m_failures;
+    QHash<QTcpSocket *, QByteArray> m_pending; // Partial request headers
+    mutable QMutex m_rangesMutex;
+    QVector<QPair<qint64, qint64>> m_ranges; // Requested, both ends inclusive
+};
+
+class HttpRangeDeviceTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void readsAnyRange();
+    void failedReadaheadKeepsOtherReads();
+    void failedBlocksAreRetried();
+    void reopenReusesCachedBlocks();
+
+private:
+    QUrl url() const { return QUrl(QString("http://127.0.0.1:%1/test.pdf").arg(m_port)); }
+    QByteArray read(HttpRangeDevice &device, qint64 offset, qint64 length);
+
+    static constexpr qint64 BLOCK = HttpRangeDevice::BLOCK_SIZE;
+
+    QByteArray m_body;
+    QThread m_serverThread;
+    RangeServer *m_server = nullptr;
+    quint16 m_port = 0;
+    QTemporaryDir m_cacheDirectory;
+};
+
+void HttpRangeDeviceTest::init()
+{
+    // Eight and a bit blocks of a pattern no two blocks share
+    m_body.resize(8 * BLOCK + 123);
+    for (int i = 0; i < m_body.size(); ++i)
+        m_body[i] = char((i * 31 + i / BLOCK) % 251);
+
+    m_server = new RangeServer(m_body);
+    m_server->moveToThread(&m_serverThread);
+    connect(&m_serverThread, &QThread::finished, m_server, &QObject::deleteLater);
+    m_serverThread.start();
+
+    QMetaObject::invokeMethod(m_server, [this]()
+                              { m_server->listen(QHostAddress::LocalHost); }, Qt::BlockingQueuedConnection);
+    m_port = m_server->serverPort();
+    QVERIFY(m_port != 0);
+    QVERIFY(m_cacheDirectory.isValid());
+}
+
+void HttpRangeDeviceTest::cleanup()
+{
+    m_serverThread.quit();
+    m_serverThread.wait(); // finished() -> deleteLater() disposes of the server
+    m_server = nullptr;
+}
+
+QByteArray HttpRangeDeviceTest::read(HttpRangeDevice &device, qint64 offset, qint64 length)
+{
+    if (!device.seek(offset))
+        return QByteArray();
+    QByteArray data(length, Qt::Uninitialized);
+    const qint64 count = device.read(data.data(), length);
+    return count == length ? data : QByteArray();
+}
+
+// Tests ------------------------------------------------------------
+
+void HttpRangeDeviceTest::readsAnyRange()
+{
+    HttpRangeDevice device(url(), m_cacheDirectory.filePath("any"));
+    QVERIFY2(device.open(QIODevice::ReadOnly), qPrintable(device.errorString()));
+    QCOMPARE(device.size(), qint64(m_body.size()));
+
+    // Within a block, across blocks, and the short last block
+    QCOMPARE(read(device, 10, 100), m_body.mid(10, 100));
+    QCOMPARE(read(device, 3 * BLOCK - 50, 200), m_body.mid(3 * BLOCK - 50, 200));
+    QCOMPARE(read(device, m_body.size() - 123, 123), m_body.right(123));
+}
+
+void HttpRangeDeviceTest::failedReadaheadKeepsOtherReads()
+{
+    HttpRangeDevice device(url(), m_cacheDirectory.filePath("readahead"));
+    QVERIFY2(device.open(QIODevice::ReadOnly), qPrintable(device.errorString()));
+
+    // Reading block 1 reads ahead from block 2: that request fails first
+    m_server->setFailFrom(2 * BLOCK);
+    QCOMPARE(read(device, BLOCK + 10, 100), m_body.mid(BLOCK + 10, 100));
+    QVERIFY(m_server->failures() > 0);
+
+    // So does an explicit prefetch; block 0 (already present) stays readable
+    device.prefetch(5 * BLOCK, 2 * BLOCK);
+    const int failures = m_server->failures();
+    QTRY_VERIFY(m_server->failures() > failures);
+    QCOMPARE(read(device, 0, 100), m_body.left(100));
+}
+
+void HttpRangeDeviceTest::failedBlocksAreRetried()
+{
+    HttpRangeDevice device(url(), m_cacheDirectory.filePath("retry"));
+    QVERIFY2(device.open(QIODevice::ReadOnly), qPrintable(device.errorString()));
+
+    // The read that needs a failing block fails...
+    m_server->setFailFrom(4 * BLOCK);
+    QCOMPARE(device.seek(4 * BLOCK), true);
+    char byte;
+    QCOMPARE(device.read(&byte, 1), qint64(-1));
+
+    // ...and the next one asks again
+    m_server->setFailFrom(-1);
+    QCOMPARE(read(device, 4 * BLOCK, 100), m_body.mid(4 * BLOCK, 100));
+}
+
+void HttpRangeDeviceTest::reopenReusesCachedBlocks()
+{
+    // The server sends an ETag but no Last-Modified: the validator must still match
+    const QString cachePath = m_cacheDirectory.filePath("reopen");
+    {
+        HttpRangeDevice device(url(), cachePath);
+        QVERIFY2(device.open(QIODevice::ReadOnly), qPrintable(device.errorString()));
+        QCOMPARE(read(device, 2 * BLOCK + 10, 100), m_body.mid(2 * BLOCK + 10, 100));
+        device.close();
+    }
+
+    // Only block 0 is fetched on open (size and validator); block 2 comes from disk
+    m_server->clearRequests();
+    HttpRangeDevice device(url(), cachePath);
+    QVERIFY2(device.open(QIODevice::ReadOnly), qPrintable(device.errorString()));
+    QCOMPARE(read(device, 2 * BLOCK + 10, 100), m_body.mid(2 * BLOCK + 10, 100));
+    QVERIFY(!m_server->requested(2 * BLOCK, 3 * BLOCK - 1));
+}
+
+QTEST_GUILESS_MAIN(HttpRangeDeviceTest)
+#include "httprangedevicetest.moc"
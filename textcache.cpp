@@ -0,0 +1,78 @@
+/**
+ * TextCache implementation
+ * ---------------------------------------------------------------
+ * QCache (LRU with byte cost) behind a mutex.
+ */
+
+#include "textcache.h"
+#include <QFileInfo>
+#include <QMutexLocker>
+
+TextCache::TextCache(qint64 budgetBytes)
+{
+    m_documents.setMaxCost(budgetBytes);
+}
+
+QStringList TextCache::pages(const QByteArray &documentHash) const
+{
+    if (documentHash.isEmpty())
+        return QStringList();
+
+    QMutexLocker locker(&m_mutex);
+    const QStringList *pages = m_documents.object(documentHash);
+    return pages ? *pages : QStringList(); // Implicitly shared copy
+}
+
+void TextCache::insert(const QByteArray &documentHash, const QStringList &pages)
+{
+    if (documentHash.isEmpty())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    // QCache deletes the list immediately if it alone exceeds the budget
+    m_documents.insert(documentHash, new QStringList(pages), cost(pages));
+    updateAccounting();
+}
+
+void TextCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_documents.clear();
+    m_files.clear();
+    updateAccounting();
+}
+
+// File Identity ---------------------------------------------------
+
+QByteArray TextCache::fileHash(const QString &filePath) const
+{
+    const QFileInfo info(filePath);
+    QMutexLocker locker(&m_mutex);
+    const auto it = m_files.constFind(info.absoluteFilePath());
+    if (it == m_files.constEnd() || it->size != info.size() || it->modified != info.lastModified())
+        return QByteArray();
+    return it->documentHash;
+}
+
+void TextCache::setFileHash(const QString &filePath, const QByteArray &documentHash)
+{
+    if (filePath.isEmpty() || documentHash.isEmpty())
+        return;
+
+    const QFileInfo info(filePath);
+    QMutexLocker locker(&m_mutex);
+    m_files.insert(info.absoluteFilePath(), FileIdentity{info.size(), info.lastModified(), documentHash});
+}
+
+qint64 TextCache::cost(const QStringList &pages)
+{
+    qint64 bytes = 0;
+    for (const QString &text : pages)
+        bytes += text.size() * qint64(sizeof(QChar)) + qint64(sizeof(QString));
+    return qMax<qint64>(1, bytes);
+}
+
+void TextCache::updateAccounting()
+{
+    m_account.setBytes(m_documents.totalCost());
+}
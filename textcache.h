@@ -0,0 +1,63 @@
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include "memoryaccounting.h"
+
+/**
+ * TextCache
+ * ---------------------------------------------------------------
+ * Byte-budgeted cache of extracted page text, keyed by document content.
+ *
+ * Responsibilities:
+ *  - Map a document content hash to the plain text of all its pages,
+ *    so every search after the first skips Poppler entirely.
+ *  - Remember which content hash each file had (while its size and
+ *    modification time stay the same), so a cached file is not even
+ *    reopened to find its key.
+ *  - Evict least recently used documents once the budget is exceeded.
+ *
+ * Design notes:
+ *  - Thread-safe: search workers fill and read it concurrently.
+ *  - Only complete documents are stored (a canceled extraction is dropped),
+ *    so a hit always covers every page.
+ *  - Reports to MemoryAccounting as "text-cache".
+ */
+class TextCache
+{
+public:
+    explicit TextCache(qint64 budgetBytes = DEFAULT_BUDGET);
+
+    QStringList pages(const QByteArray &documentHash) const; // Empty on miss.
+    void insert(const QByteArray &documentHash, const QStringList &pages);
+    void clear();
+
+    // File identity -------------------------------------------------
+    QByteArray fileHash(const QString &filePath) const; // Empty if unknown or the file changed.
+    void setFileHash(const QString &filePath, const QByteArray &documentHash);
+
+    static constexpr qint64 DEFAULT_BUDGET = 64ll * 1024 * 1024;
+
+private:
+    static qint64 cost(const QStringList &pages);
+    void updateAccounting();
+
+    struct FileIdentity
+    {
+        qint64 size = -1;
+        QDateTime modified;
+        QByteArray documentHash;
+    };
+
+    mutable QMutex m_mutex;
+    mutable QCache<QByteArray, QStringList> m_documents; // object() refreshes LRU order.
+    QHash<QString, FileIdentity> m_files; // Absolute path -> identity
+    MemoryAccount m_account{"text-cache"};
+};
+
+#endif // TEXTCACHE_H
@@ -0,0 +1,381 @@
+/**
+ * TextDiff implementation
+ * ---------------------------------------------------------------
+ * Extraction fans out over a private thread pool; the diff is
+ * Myers, "An O(ND) Difference Algorithm and Its Variations"
+ * (Algorithmica 1, 1986), section 4b: find the middle snake of the
+ * optimal path, recurse on both halves.
+ */
+
+#include "textdiff.h"
+#include "pdfdocument.h"
+#include "viewerconfig.h"
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+namespace
+{
+    constexpr qreal CARET_WIDTH = 2.0; // Points
+    constexpr int HUNK_TEXT_LIMIT = 160; // Characters per side in listings
+
+    double elapsedMs(const QElapsedTimer &timer)
+    {
+        return timer.nsecsElapsed() / 1.0e6;
+    }
+
+    // Word boxes of one line: vertical overlap of at least half the smaller box
+    bool sameLine(const QRectF &a, const QRectF &b)
+    {
+        const qreal overlap = qMin(a.bottom(), b.bottom()) - qMax(a.top(), b.top());
+        return overlap > 0.5 * qMin(a.height(), b.height()) && b.left() >= a.left();
+    }
+
+    /**
+     * MyersDiff
+     * Recursion state: both sequences, the hunk list being built and the two
+     * furthest-reaching vectors (reused, sized to the current bisection).
+     */
+    struct MyersDiff
+    {
+        const QVector<int> &a;
+        const QVector<int> &b;
+        QVector<DiffHunk> hunks;
+        QVector<int> forward;
+        QVector<int> backward;
+        bool approximate = false;
+
+        void emitHunk(int oldBegin, int oldEnd, int newBegin, int newEnd)
+        {
+            if (oldBegin == oldEnd && newBegin == newEnd)
+                return;
+
+            // A deletion right before an insertion is one replacement
+            if (!hunks.isEmpty() && hunks.last().oldEnd == oldBegin && hunks.last().newEnd == newBegin)
+            {
+                hunks.last().oldEnd = oldEnd;
+                hunks.last().newEnd = newEnd;
+                return;
+            }
+            hunks.append(DiffHunk{oldBegin, oldEnd, newBegin, newEnd});
+        }
+
+        // Middle snake of a[oldBegin, oldEnd) vs b[newBegin, newEnd), offsets relative
+        // to the range; false once half the edit cost exceeds the limit
+        bool bisect(int oldBegin, int oldEnd, int newBegin, int newEnd, int &startX, int &startY, int &endX, int &endY)
+        {
+            const int n = oldEnd - oldBegin;
+            const int m = newEnd - newBegin;
+            const int delta = n - m;
+            const bool odd = delta & 1;
+            const int maxCost = qMin((n + m + 1) / 2, TextDiff::MAX_EDIT_COST / 2);
+
+            // Diagonal k = x - y; forward centered on 0, backward on delta
+            const int offset = maxCost + 1;
+            forward.fill(0, 2 * maxCost + 3);
+            backward.fill(0, 2 * maxCost + 3);
+            auto f = [&](int k) -> int & { return forward[k + offset]; };
+            auto r = [&](int k) -> int & { return backward[k - delta + offset]; };
+            f(1) = 0;
+            r(delta - 1) = n;
+
+            for (int d = 0; d <= maxCost; ++d)
+            {
+                for (int k = -d; k <= d; k += 2)
+                {
+                    int x = (k == -d || (k != d && f(k - 1) < f(k + 1))) ? f(k + 1) : f(k - 1) + 1;
+                    int y = x - k;
+                    const int x0 = x;
+                    const int y0 = y;
+                    while (x < n && y < m && a[oldBegin + x] == b[newBegin + y])
+                    {
+                        ++x;
+                        ++y;
+                    }
+                    f(k) = x;
+
+                    if (odd && k - delta >= -(d - 1) && k - delta <= d - 1 && f(k) >= r(k))
+                    {
+                        startX = x0;
+                        startY = y0;
+                        endX = x;
+                        endY = y;
+                        return true;
+                    }
+                }
+
+                for (int j = -d; j <= d; j += 2)
+                {
+                    const int k = delta + j;
+                    int x = (j == d || (j != -d && r(k - 1) < r(k + 1))) ? r(k - 1) : r(k + 1) - 1;
+                    int y = x - k;
+                    const int x1 = x;
+                    const int y1 = y;
+                    while (x > 0 && y > 0 && a[oldBegin + x - 1] == b[newBegin + y - 1])
+                    {
+                        --x;
+                        --y;
+                    }
+                    r(k) = x;
+
+                    if (!odd && k >= -d && k <= d && r(k) <= f(k))
+                    {
+                        startX = x;
+                        startY = y;
+                        endX = x1;
+                        endY = y1;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        void diff(int oldBegin, int oldEnd, int newBegin, int newEnd)
+        {
+            // Common prefix and suffix cost nothing to skip
+            while (oldBegin < oldEnd && newBegin < newEnd && a[oldBegin] == b[newBegin])
+            {
+                ++oldBegin;
+                ++newBegin;
+            }
+            while (oldEnd > oldBegin && newEnd > newBegin && a[oldEnd - 1] == b[newEnd - 1])
+            {
+                --oldEnd;
+                --newEnd;
+            }
+
+            if (oldBegin == oldEnd || newBegin == newEnd)
+            {
+                emitHunk(oldBegin, oldEnd, newBegin, newEnd);
+                return;
+            }
+
+            int startX = 0, startY = 0, endX = 0, endY = 0;
+            if (!bisect(oldBegin, oldEnd, newBegin, newEnd, startX, startY, endX, endY))
+            {
+                approximate = true;
+                emitHunk(oldBegin, oldEnd, newBegin, newEnd);
+                return;
+            }
+
+            diff(oldBegin, oldBegin + startX, newBegin, newBegin + startY);
+            diff(oldBegin + endX, oldEnd, newBegin + endY, newEnd);
+        }
+    };
+}
+
+// Extraction -------------------------------------------------------
+
+QVector<DiffWord> TextDiff::extractWords(const QString &filePath, int firstPage, int lastPage, QAtomicInt *pagesDone,
+                                         int pagesTotal, const ProgressCallback &progress, QAtomicInt *canceled)
+{
+    QVector<DiffWord> words;
+
+    PDFDocument document;
+    if (!document.loadFromFile(filePath, PDFDocument::FileIdentity::None))
+    {
+        canceled->storeRelaxed(1);
+        return words;
+    }
+
+    for (int i = firstPage; i < lastPage && !canceled->loadRelaxed(); ++i)
+    {
+        if (auto page = document.getPage(i))
+        {
+            for (const auto &box : page->textList())
+                words.append(DiffWord{box->text(), i, box->boundingBox()});
+        }
+
+        const int done = pagesDone->fetchAndAddRelaxed(1) + 1;
+        if (progress && !progress(done, pagesTotal))
+            canceled->storeRelaxed(1);
+    }
+    return words;
+}
+
+// Comparison -------------------------------------------------------
+
+TextDiff TextDiff::run(const QString &oldPath, const QString &newPath, const ProgressCallback &progress)
+{
+    TextDiff result;
+    result.m_oldPath = oldPath;
+    result.m_newPath = newPath;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Page counts decide the chunks
+    const QString paths[2] = {oldPath, newPath};
+    int pageCounts[2] = {0, 0};
+    for (int side = 0; side < 2; ++side)
+    {
+        PDFDocument document;
+        if (!document.loadFromFile(paths[side], PDFDocument::FileIdentity::None))
+        {
+            result.m_error = QString("Cannot open %1").arg(paths[side]);
+            return result;
+        }
+        pageCounts[side] = document.pageCount();
+    }
+
+    // Own pool: chunk workers never queue behind the task that waits for them
+    const int configured = ViewerConfig::instance().settings().workerThreads;
+    const int threads = configured > 0 ? configured : QThread::idealThreadCount();
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+
+    const int pagesTotal = pageCounts[0] + pageCounts[1];
+    QAtomicInt pagesDone(0);
+    QAtomicInt canceled(0);
+    QVector<QFuture<QVector<DiffWord>>> chunks[2];
+    for (int side = 0; side < 2; ++side)
+    {
+        // Both documents share the threads in proportion to their length
+        const int share = qMax(1, int(qint64(threads) * pageCounts[side] / qMax(1, pagesTotal)));
+        const int chunkPages = qMax(MIN_CHUNK_PAGES, (pageCounts[side] + share - 1) / share);
+        for (int first = 0; first < pageCounts[side]; first += chunkPages)
+        {
+            const int last = qMin(pageCounts[side], first + chunkPages);
+            chunks[side].append(QtConcurrent::run(&pool, &TextDiff::extractWords, paths[side], first, last, &pagesDone,
+                                                  pagesTotal, progress, &canceled));
+        }
+    }
+
+    QVector<DiffWord> *words[2] = {&result.m_oldWords, &result.m_newWords};
+    for (int side = 0; side < 2; ++side)
+    {
+        for (QFuture<QVector<DiffWord>> &chunk : chunks[side])
+            *words[side] += chunk.result(); // Chunks are in page order
+    }
+    result.m_extractMs = elapsedMs(timer);
+
+    if (canceled.loadRelaxed())
+    {
+        result.m_error = "Canceled";
+        return result;
+    }
+
+    // Compare integers, not strings
+    timer.restart();
+    QHash<QString, int> ids;
+    QVector<int> sequences[2];
+    for (int side = 0; side < 2; ++side)
+    {
+        sequences[side].reserve(words[side]->size());
+        for (const DiffWord &word : std::as_const(*words[side]))
+        {
+            auto id = ids.constFind(word.text);
+            if (id == ids.constEnd())
+                id = ids.insert(word.text, int(ids.size()));
+            sequences[side].append(id.value());
+        }
+    }
+    result.m_hunks = diff(sequences[0], sequences[1], &result.m_approximate);
+    result.m_diffMs = elapsedMs(timer);
+    return result;
+}
+
+QVector<DiffHunk> TextDiff::diff(const QVector<int> &oldIds, const QVector<int> &newIds, bool *approximate)
+{
+    MyersDiff myers{oldIds, newIds};
+    myers.diff(0, int(oldIds.size()), 0, int(newIds.size()));
+    if (approximate)
+        *approximate = myers.approximate;
+    return myers.hunks;
+}
+
+// Output -----------------------------------------------------------
+
+QVector<DiffRegion> TextDiff::regions(Side side) const
+{
+    const QVector<DiffWord> &sideWords = words(side);
+    QVector<DiffRegion> regions;
+    if (sideWords.isEmpty())
+        return regions;
+
+    for (const DiffHunk &hunk : m_hunks)
+    {
+        const int begin = side == Side::Old ? hunk.oldBegin : hunk.newBegin;
+        const int end = side == Side::Old ? hunk.oldEnd : hunk.newEnd;
+
+        // Nothing on this side: caret before the next word (after the last one at the end)
+        if (begin == end)
+        {
+            const bool atEnd = begin >= sideWords.size();
+            const DiffWord &anchor = sideWords[atEnd ? sideWords.size() - 1 : begin];
+            const qreal x = atEnd ? anchor.box.right() : anchor.box.left();
+            regions.append(DiffRegion{anchor.page, QRectF(x - CARET_WIDTH / 2, anchor.box.top(), CARET_WIDTH, anchor.box.height()), true});
+            continue;
+        }
+
+        // One box per line fragment, not per word
+        const int firstRegion = regions.size();
+        for (int i = begin; i < end; ++i)
+        {
+            const DiffWord &word = sideWords[i];
+            if (regions.size() > firstRegion && regions.last().page == word.page && sameLine(regions.last().box, word.box))
+                regions.last().box = regions.last().box.united(word.box);
+            else
+                regions.append(DiffRegion{word.page, word.box, false});
+        }
+    }
+    return regions;
+}
+
+int TextDiff::hunkPage(const DiffHunk &hunk, Side side) const
+{
+    const QVector<DiffWord> &sideWords = words(side);
+    if (sideWords.isEmpty())
+        return -1;
+
+    const int begin = side == Side::Old ? hunk.oldBegin : hunk.newBegin;
+    return sideWords[qMin(begin, int(sideWords.size()) - 1)].page;
+}
+
+QString TextDiff::hunkText(const DiffHunk &hunk, Side side) const
+{
+    const QVector<DiffWord> &sideWords = words(side);
+    const int begin = side == Side::Old ? hunk.oldBegin : hunk.newBegin;
+    const int end = side == Side::Old ? hunk.oldEnd : hunk.newEnd;
+
+    QString text;
+    for (int i = begin; i < end && text.size() < HUNK_TEXT_LIMIT; ++i)
+    {
+        if (!text.isEmpty())
+            text += ' ';
+        text += sideWords[i].text;
+    }
+    if (text.size() > HUNK_TEXT_LIMIT)
+        text = text.left(HUNK_TEXT_LIMIT) + QChar(0x2026);
+    return text;
+}
+
+QString TextDiff::summary() const
+{
+    if (!m_error.isEmpty())
+        return m_error;
+
+    int removed = 0;
+    int added = 0;
+    for (const DiffHunk &hunk : m_hunks)
+    {
+        removed += hunk.oldEnd - hunk.oldBegin;
+        added += hunk.newEnd - hunk.newBegin;
+    }
+
+    QString text;
+    text += QString("%1 -> %2\n").arg(QFileInfo(m_oldPath).fileName(), QFileInfo(m_newPath).fileName());
+    text += QString("%1 changes: %2 of %3 words removed, %4 of %5 added%6\n")
+                .arg(m_hunks.size())
+                .arg(removed)
+                .arg(m_oldWords.size())
+                .arg(added)
+                .arg(m_newWords.size())
+                .arg(m_approximate ? QString(" (large rewrites reported as whole blocks)") : QString());
+    text += QString("Extraction: %1 ms   Diff: %2 ms").arg(m_extractMs, 0, 'f', 1).arg(m_diffMs, 0, 'f', 1);
+    return text;
+}
@@ -0,0 +1,112 @@
+#ifndef TEXTDIFF_H
+#define TEXTDIFF_H
+
+#include <QAtomicInt>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+/**
+ * DiffWord
+ * One word of a document, where Poppler put it (points, top-left origin).
+ */
+struct DiffWord
+{
+    QString text;
+    int page = -1;
+    QRectF box;
+};
+
+/**
+ * DiffHunk
+ * Consecutive words that changed: [oldBegin, oldEnd) became [newBegin, newEnd).
+ * One side empty = pure insertion or deletion.
+ */
+struct DiffHunk
+{
+    int oldBegin = 0;
+    int oldEnd = 0;
+    int newBegin = 0;
+    int newEnd = 0;
+};
+
+/**
+ * DiffRegion
+ * Highlight for one side: a changed line fragment, or a caret marking where
+ * the other side has words this one lacks.
+ */
+struct DiffRegion
+{
+    int page = -1;
+    QRectF box;          // Points
+    bool caret = false;  // Text missing here (present on the other side)
+};
+
+/**
+ * TextDiff
+ * ---------------------------------------------------------------
+ * Word-level comparison of two revisions of a document ("what changed in
+ * this contract?"), as opposed to comparing renders.
+ *
+ * Responsibilities:
+ *  - Extract words with their boxes from both files in parallel: each file
+ *    is split into page chunks, each chunk on its own thread with its own
+ *    PDFDocument.
+ *  - Diff the word sequences with Myers' O(ND) algorithm in its linear-space
+ *    (middle snake) form, so memory stays proportional to the documents.
+ *  - Map every hunk back to page boxes, merged per line, for highlighting.
+ *
+ * Design notes:
+ *  - Words compare exactly (case, punctuation): every change counts.
+ *  - A bisection whose edit distance exceeds MAX_EDIT_COST gives up and
+ *    reports that stretch as one replacement: two unrelated documents take
+ *    a bounded time instead of O(N^2), and approximate() says so.
+ *  - Never throws: failures land in error().
+ */
+class TextDiff
+{
+public:
+    enum class Side
+    {
+        Old,
+        New
+    };
+
+    using ProgressCallback = std::function<bool(int pagesDone, int pagesTotal)>; // Return false to cancel. Any thread.
+
+    static TextDiff run(const QString &oldPath, const QString &newPath, const ProgressCallback &progress = ProgressCallback());
+
+    // Diff of two word-id sequences (exposed for reuse); hunks in document order.
+    static QVector<DiffHunk> diff(const QVector<int> &oldIds, const QVector<int> &newIds, bool *approximate = nullptr);
+
+    bool isValid() const { return m_error.isEmpty(); }
+    QString error() const { return m_error; }
+    bool approximate() const { return m_approximate; }
+
+    const QVector<DiffHunk> &hunks() const { return m_hunks; }
+    const QVector<DiffWord> &words(Side side) const { return side == Side::Old ? m_oldWords : m_newWords; }
+    QVector<DiffRegion> regions(Side side) const; // Highlights for that document, in page order.
+    int hunkPage(const DiffHunk &hunk, Side side) const; // Where the hunk starts (or its caret sits); -1 if no words.
+    QString hunkText(const DiffHunk &hunk, Side side) const;
+    QString summary() const;
+
+    static constexpr int MAX_EDIT_COST = 16384;  // Per bisection (words inserted + deleted)
+    static constexpr int MIN_CHUNK_PAGES = 16;   // Smaller chunks cost more in document opens than they save
+
+private:
+    static QVector<DiffWord> extractWords(const QString &filePath, int firstPage, int lastPage, QAtomicInt *pagesDone,
+                                          int pagesTotal, const ProgressCallback &progress, QAtomicInt *canceled);
+
+    QString m_oldPath;
+    QString m_newPath;
+    QVector<DiffWord> m_oldWords;
+    QVector<DiffWord> m_newWords;
+    QVector<DiffHunk> m_hunks;
+    bool m_approximate = false;
+    double m_extractMs = 0.0;
+    double m_diffMs = 0.0;
+    QString m_error;
+};
+
+#endif // TEXTDIFF_H
@@ -0,0 +1,230 @@
+#include "viewerconfig.h"
+#include "renderpolicy.h"
+#include <QDebug>
+#include <QDir>
+#include <QRegularExpression>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+
+namespace
+{
+    // File value, unless PDV_<GROUP>_<KEY> is set
+    QString rawValue(const QSettings &file, const QString &key)
+    {
+        const QString variable = "PDV_" + QString(key).replace('/', '_').toUpper();
+        if (qEnvironmentVariableIsSet(variable.toLocal8Bit().constData()))
+            return qEnvironmentVariable(variable.toLocal8Bit().constData()).trimmed();
+
+        // QSettings splits comma-separated INI values into a list
+        return file.value(key).toStringList().join(',').trimmed();
+    }
+
+    template <typename T>
+    void readNumber(const QSettings &file, const QString &key, T minimum, T maximum, T &target)
+    {
+        const QString text = rawValue(file, key);
+        if (text.isEmpty())
+            return;
+
+        bool ok = false;
+        const double value = text.toDouble(&ok);
+        if (!ok || value < double(minimum) || value > double(maximum))
+        {
+            qWarning() << "ViewerConfig:" << key << "=" << text << "out of range [" << minimum << "," << maximum
+                       << "], keeping" << target;
+            return;
+        }
+        target = T(value);
+    }
+
+    void readLadder(const QSettings &file, QVector<int> &target)
+    {
+        const QString text = rawValue(file, "render/dpi_ladder");
+        if (text.isEmpty())
+            return;
+
+        QVector<int> ladder;
+        for (const QString &step : text.split(',', Qt::SkipEmptyParts))
+        {
+            bool ok = false;
+            const int dpi = step.trimmed().toInt(&ok);
+            if (!ok || dpi < 24 || dpi > 2400)
+            {
+                qWarning() << "ViewerConfig: bad DPI ladder step" << step << "- keeping the default ladder";
+                return;
+            }
+            ladder.append(dpi);
+        }
+        std::sort(ladder.begin(), ladder.end());
+        ladder.erase(std::unique(ladder.begin(), ladder.end()), ladder.end());
+        if (!ladder.isEmpty())
+            target = ladder;
+    }
+
+    void readQuality(const QSettings &file, RenderQuality &target)
+    {
+        const QString text = rawValue(file, "render/quality").toLower();
+        if (text.isEmpty())
+            return;
+
+        if (text == "draft")
+            target = RenderQuality::Draft;
+        else if (text == "standard")
+            target = RenderQuality::Standard;
+        else if (text == "high")
+            target = RenderQuality::High;
+        else
+            qWarning() << "ViewerConfig: unknown render/quality" << text << "(draft, standard, high)";
+    }
+
+    void readPolicy(const QSettings &file, QString &target)
+    {
+        const QString text = rawValue(file, "prefetch/policy").toLower();
+        if (text.isEmpty())
+            return;
+
+        if (RenderPolicy::names().contains(text))
+            target = text;
+        else
+            qWarning() << "ViewerConfig: unknown prefetch/policy" << text << "-" << RenderPolicy::names();
+    }
+
+    // POSIX shared memory names: one leading slash, nothing else fancy
+    void readSegmentName(const QSettings &file, QString &target)
+    {
+        const QString text = rawValue(file, "cache/shared_name");
+        if (text.isEmpty())
+            return;
+
+        static const QRegularExpression valid("^/?[A-Za-z0-9._-]{1,200}$");
+        if (!valid.match(text).hasMatch())
+        {
+            qWarning() << "ViewerConfig: bad cache/shared_name" << text << "(letters, digits, '.', '_', '-')";
+            return;
+        }
+        target = text.startsWith('/') ? text : '/' + text;
+    }
+}
+
+bool ViewerSettings::operator==(const ViewerSettings &other) const
+{
+    return renderDpi == other.renderDpi && dpiLadder == other.dpiLadder && quality == other.quality &&
+           prefetchWindow == other.prefetchWindow && initialPages == other.initialPages &&
+           prefetchDelayMs == other.prefetchDelayMs && renderPolicy == other.renderPolicy &&
+           minZoom == other.minZoom && maxZoom == other.maxZoom &&
+           workerThreads == other.workerThreads && renderCacheBytes == other.renderCacheBytes &&
+           streamSpillBytes == other.streamSpillBytes && sharedCacheBytes == other.sharedCacheBytes &&
+           sharedCacheName == other.sharedCacheName;
+}
+
+// Construction -----------------------------------------------------
+ViewerConfig &ViewerConfig::instance()
+{
+    static ViewerConfig config;
+    return config;
+}
+
+ViewerConfig::ViewerConfig()
+{
+    m_filePath = qEnvironmentVariable("PDV_CONFIG");
+    if (m_filePath.isEmpty())
+    {
+        m_filePath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/viewer.ini";
+    }
+
+    m_reloadTimer.setSingleShot(true);
+    m_reloadTimer.setInterval(RELOAD_DELAY_MS);
+    connect(&m_reloadTimer, &QTimer::timeout, this, &ViewerConfig::reload);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, &m_reloadTimer, qOverload<>(&QTimer::start));
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, &m_reloadTimer, qOverload<>(&QTimer::start));
+
+    m_settings = read();
+    apply(m_settings);
+    watch();
+    qInfo() << "ViewerConfig: using" << m_filePath << (QFileInfo::exists(m_filePath) ? "" : "(absent, defaults)");
+}
+
+ViewerSettings ViewerConfig::settings() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_settings;
+}
+
+// Loading ----------------------------------------------------------
+ViewerSettings ViewerConfig::read() const
+{
+    ViewerSettings s;
+    const QSettings file(m_filePath, QSettings::IniFormat);
+    if (file.status() != QSettings::NoError)
+    {
+        qWarning() << "ViewerConfig: cannot parse" << m_filePath << "- using defaults and environment";
+    }
+
+    readNumber(file, "render/dpi", 24, 1200, s.renderDpi);
+    readLadder(file, s.dpiLadder);
+    readQuality(file, s.quality);
+
+    readNumber(file, "prefetch/window_pages", 0, 50, s.prefetchWindow);
+    readNumber(file, "prefetch/initial_pages", 0, 100, s.initialPages);
+    readNumber(file, "prefetch/delay_ms", 0, 5000, s.prefetchDelayMs);
+    readPolicy(file, s.renderPolicy);
+
+    readNumber(file, "zoom/min", 0.05, 1.0, s.minZoom);
+    readNumber(file, "zoom/max", 1.0, 50.0, s.maxZoom);
+
+    readNumber(file, "workers/threads", 0, 256, s.workerThreads);
+
+    qint64 renderCacheMb = s.renderCacheBytes >> 20;
+    readNumber<qint64>(file, "cache/render_mb", 16, 64 * 1024, renderCacheMb);
+    s.renderCacheBytes = renderCacheMb << 20;
+
+    qint64 streamSpillMb = s.streamSpillBytes >> 20;
+    readNumber<qint64>(file, "cache/stream_spill_mb", 1, 16 * 1024, streamSpillMb);
+    s.streamSpillBytes = streamSpillMb << 20;
+
+    qint64 sharedCacheMb = s.sharedCacheBytes >> 20;
+    readNumber<qint64>(file, "cache/shared_mb", 0, 64 * 1024, sharedCacheMb);
+    s.sharedCacheBytes = sharedCacheMb << 20;
+    readSegmentName(file, s.sharedCacheName);
+
+    return s;
+}
+
+void ViewerConfig::reload()
+{
+    const ViewerSettings fresh = read();
+    watch(); // Atomic saves replace the file: watch the new one
+
+    {
+        QMutexLocker lock(&m_mutex);
+        if (fresh == m_settings)
+        {
+            return;
+        }
+        m_settings = fresh;
+    }
+
+    qInfo() << "ViewerConfig: reloaded" << m_filePath;
+    apply(fresh);
+    emit changed(fresh);
+}
+
+void ViewerConfig::apply(const ViewerSettings &settings)
+{
+    const int threads = settings.workerThreads > 0 ? settings.workerThreads : QThread::idealThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(threads);
+}
+
+void ViewerConfig::watch()
+{
+    // The directory reports creation and replacement; the file reports edits
+    const QString directory = QFileInfo(m_filePath).absolutePath();
+    if (QFileInfo::exists(directory) && !m_watcher.directories().contains(directory))
+        m_watcher.addPath(directory);
+    if (QFileInfo::exists(m_filePath) && !m_watcher.files().contains(m_filePath))
+        m_watcher.addPath(m_filePath);
+}
@@ -0,0 +1,112 @@
+#ifndef VIEWERCONFIG_H
+#define VIEWERCONFIG_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QMutex>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * Rasterization quality, mapped to Poppler render hints by PDFDocument.
+ * Draft is Poppler's default (no antialiasing): fastest, and what the
+ * viewer always used.
+ */
+enum class RenderQuality
+{
+    Draft,    // No hints
+    Standard, // Antialiased shapes and text
+    High      // Standard + slight text hinting
+};
+
+/**
+ * ViewerSettings
+ * Every deployment-tunable value, with the built-in defaults. Plain data:
+ * copy it, compare it, hand it to worker threads.
+ */
+struct ViewerSettings
+{
+    // [render]
+    int renderDpi = 200;                                      // dpi: DPI at 100 % zoom
+    QVector<int> dpiLadder{72, 100, 150, 200, 300, 400, 600}; // dpi_ladder: see RenderCache::ladderDpi()
+    RenderQuality quality = RenderQuality::Draft;             // quality: draft | standard | high
+
+    // [prefetch]
+    int prefetchWindow = 2;    // window_pages: rendered past each edge of the viewport
+    int initialPages = 5;      // initial_pages: pre-rendered on open / preloaded for the next queued file
+    int prefetchDelayMs = 150; // delay_ms: input idle time before a speculative render
+    QString renderPolicy = "window"; // policy: see RenderPolicy::names() (benchmarks/schedsim compares them)
+
+    // [zoom]
+    double minZoom = 0.5;  // min
+    double maxZoom = 10.0; // max
+
+    // [workers]
+    int workerThreads = 0; // threads: global QThreadPool size; 0 = one per core
+
+    // [cache]
+    qint64 renderCacheBytes = 256ll * 1024 * 1024; // render_mb
+    qint64 streamSpillBytes = 64ll * 1024 * 1024;  // stream_spill_mb: stdin input above this goes to a temp file
+    qint64 sharedCacheBytes = 0;                   // shared_mb: cross-process tile segment; 0 = off
+    QString sharedCacheName;                       // shared_name: segment shared by a group; empty = per user
+
+    bool operator==(const ViewerSettings &other) const;
+    bool operator!=(const ViewerSettings &other) const { return !(*this == other); }
+};
+
+/**
+ * ViewerConfig
+ * ---------------------------------------------------------------
+ * Process-wide runtime configuration: an INI file plus PDV_* environment
+ * overrides, reloaded while the viewer runs.
+ *
+ * Responsibilities:
+ *  - Read <config dir>/viewer.ini (or $PDV_CONFIG), then let environment
+ *    variables override single keys: "group/key" -> PDV_GROUP_KEY, e.g.
+ *    render/dpi -> PDV_RENDER_DPI, cache/render_mb -> PDV_CACHE_RENDER_MB.
+ *  - Validate every value; a bad one is reported and keeps its default.
+ *  - Watch the file and emit changed() after an edit, so open documents
+ *    pick up new values without being reopened.
+ *  - Size the global thread pool (QtConcurrent workers).
+ *
+ * Design notes:
+ *  - settings() returns a snapshot under a mutex: safe from workers.
+ *  - First use must be on the GUI thread (main() does it), which owns the
+ *    watcher and the debounce timer.
+ *  - Environment values are fixed for the process lifetime; only the file
+ *    is live.
+ */
+class ViewerConfig : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ViewerConfig &instance();
+
+    ViewerSettings settings() const; // Thread-safe snapshot.
+    QString filePath() const { return m_filePath; }
+
+    void reload(); // Re-read file + environment; emits changed() if anything differs.
+
+    static constexpr int RELOAD_DELAY_MS = 250; // Editors write in several steps
+
+signals:
+    void changed(const ViewerSettings &settings);
+
+private:
+    ViewerConfig();
+
+    ViewerSettings read() const;
+    void apply(const ViewerSettings &settings);
+    void watch();
+
+    QString m_filePath;
+    QFileSystemWatcher m_watcher;
+    QTimer m_reloadTimer;
+
+    mutable QMutex m_mutex;
+    ViewerSettings m_settings;
+};
+
+#endif // VIEWERCONFIG_H